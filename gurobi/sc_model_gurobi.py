@@ -7,6 +7,8 @@
   --relax        ：把整數流量放寬為連續（W/S 也放寬為 [0,1]），做 LP 對比
   --timelimit T  ：秒
   --focus k      ：MIPFocus（0 預設、1 可行解、2 下界、3 最佳性）
+  --model FILE   ：改解 C++ 寫出的模型檔（./main.out write model.mps），和 C++ 解器用完全相同的輸入
+  --sol FILE     ：搭配 --model，把解寫成 .sol（和 ./main.out model.mps sol=... 的格式相同）
 """
 import argparse
 import gurobipy as gp
@@ -190,11 +192,31 @@ def build_and_solve(relax: bool=False, timelimit: float=None, mipfocus: int=None
 
     return m
 
+def solve_model_file(path: str, sol: str=None, timelimit: float=None, mipfocus: int=None):
+    m = gp.read(path)
+    if timelimit is not None:
+        m.Params.TimeLimit = float(timelimit)
+    if mipfocus is not None:
+        m.Params.MIPFocus = int(mipfocus)
+    m.optimize()
+    print("\n=== Solve Summary ===")
+    print("Status :", m.Status)
+    if m.SolCount > 0:
+        print("ObjVal :", m.ObjVal)
+        if sol is not None:
+            m.write(sol)
+    return m
+
 if __name__ == "__main__":
     ap = argparse.ArgumentParser()
     ap.add_argument("--relax", action="store_true",
                     help="將整數模型放寬為 LP 鬆弛（W/S 變為 0..1 連續），做對比測試")
     ap.add_argument("--timelimit", type=float, default=None, help="時間上限（秒）")
     ap.add_argument("--focus", type=int, default=None, help="MIPFocus ∈ {0,1,2,3}")
+    ap.add_argument("--model", type=str, default=None, help="C++ 寫出的 .mps/.lp 模型檔")
+    ap.add_argument("--sol", type=str, default=None, help="搭配 --model，解寫到這個 .sol 檔")
     args = ap.parse_args()
-    build_and_solve(relax=args.relax, timelimit=args.timelimit, mipfocus=args.focus)
+    if args.model is not None:
+        solve_model_file(args.model, sol=args.sol, timelimit=args.timelimit, mipfocus=args.focus)
+    else:
+        build_and_solve(relax=args.relax, timelimit=args.timelimit, mipfocus=args.focus)
@@ -6,10 +6,23 @@
 #include <algorithm> // for std::sort
 #include <limits> // fp64 inf, nan
 #include <vector>
+#include <array> // [fixed-size kernel] 依行數排列的 kernel 表
 #include <unordered_map> // map
 #include <queue> // min-heap
+#include <deque> // LP 檔的 token lookahead
 #include <chrono> // 測速
 #include <optional> // for node queue parallel
+#include <memory> // shared_ptr
+#include <atomic> // work stealing scheduler
+#include <thread> // this_thread::yield, sleep_for
+#include <functional> // batch solver callback
+#include <numeric> // iota
+#include <type_traits> // is_trivially_copyable_v (Bytes)
+#include <cstring> // memcpy
+#include <unistd.h> // getpid (spill 檔名)
+#include <sys/mman.h> // mmap (二進位模型檔)
+#include <sys/stat.h>
+#include <fcntl.h>
 
 using namespace std;
 
@@ -31,45 +44,456 @@ public:
 };
 
 // 平行化區域 start
-bool enableMatrixEliminationParallel = false; // 啟用矩陣列運算 avx256 向量化加速
+bool enableMatrixEliminationParallel = false; // 啟用矩陣列運算 SIMD 向量化加速 (kernel 在啟動時依照 CPU 選擇)
+bool enableFixedSizeKernels = true; // [fixed-size kernel] SIMD 列運算時, 行數不超過 FIXED_ELIMINATION_MAX_COLS 的 tableau 改用行數特化的消元
 
-// 平行化版本的 array elimination, 用 A_{ij} 消去行 j 的其他元素, 並將列 i 同除 A_{ij}, 使 A_{ij} = 1
 #include <omp.h>
+#ifdef USE_MPI
+#include <mpi.h> // [MPI] make mpi 才會啟用 (mpicxx -DUSE_MPI)
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86
 #include <immintrin.h>
+#elif defined(__aarch64__)
+#define SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+// [fixed-size kernel] 小模型 (例如 (3, 3, 3, 3) 約 110~130 行) 的 pivot 大部分時間花在每列一次的間接呼叫和可變長度迴圈的頭尾處理.
+// 行數當作 template 參數時, 列運算的迴圈長度是編譯期常數, 編譯器可以直接展開並向量化; 每個指令集用自己的 target 實例化一份, 依行數查表
+constexpr uint32_t FIXED_ELIMINATION_MAX_COLS = 160;
+using FixedEliminationTable = array<void (*)(double* arr, uint32_t rows, uint32_t i, uint32_t j), FIXED_ELIMINATION_MAX_COLS + 1>; // 第 cols 個是 cols 行的消元, 第 0 個不使用
+
+namespace FixedSizeKernels {
+	template<uint32_t COLS> __attribute__((always_inline)) inline void eliminate(double* arr, uint32_t rows, uint32_t i, uint32_t j) { // 和 parallelArrayElimination 相同的運算順序, 內聯到呼叫者的 target 才決定用哪個指令集
+		double* ptrRowI = arr + (size_t)COLS * i;
+		for (uint32_t k = 0; k < rows; k++) {
+			double* ptrRowK = arr + (size_t)COLS * k;
+			if (k == i || ptrRowK[j] == 0) continue;
+			const double ratio = ptrRowK[j] / ptrRowI[j];
+			for (uint32_t c = 0; c < COLS; c++) ptrRowK[c] -= ptrRowI[c] * ratio;
+			ptrRowK[j] = 0;
+		}
+		const double pivot = ptrRowI[j];
+		for (uint32_t c = 0; c < COLS; c++) ptrRowI[c] /= pivot;
+	}
+	
+	template<typename Kernel, size_t... COLS> constexpr FixedEliminationTable makeTable(index_sequence<COLS...>) { // Kernel::eliminate<1> ~ Kernel::eliminate<MAX_COLS>
+		return { nullptr, &Kernel::template eliminate<COLS + 1>... };
+	}
+	
+	template<typename Kernel> constexpr FixedEliminationTable makeTable() {
+		return makeTable<Kernel>(make_index_sequence<FIXED_ELIMINATION_MAX_COLS>());
+	}
+}
+
+// [SIMD dispatch] tableau 列運算/掃描的 kernel. 每個指令集各一份, 用 target attribute 編譯, 所以 Makefile 不需要 -mavx2, 執行檔在沒有 AVX 的機器上也能跑
+struct SimdKernels {
+	const char* name;
+	uint32_t width; // 一次處理幾個 double
+	void (*subScaledRow)(double* dst, const double* src, double ratio, uint32_t n); // dst -= ratio * src
+	void (*divRow)(double* dst, double divisor, uint32_t n); // dst /= divisor
+	int32_t (*findFirstAtLeast)(const double* src, uint32_t n, double threshold); // 第一個 >= threshold 的位置, 找不到回傳 -1
+	int32_t (*findMinNegRatio)(const double* head, const double* row, uint32_t n, double eps); // row[j] <= -eps 中 max(0, head[j] / row[j]) 最小的 j (相同取最小的 j), 找不到回傳 -1
+	const FixedEliminationTable* fixedEliminations; // [fixed-size kernel] 依行數特化的整個消元
+};
+
+namespace ScalarKernels {
+	void subScaledRow(double* dst, const double* src, double ratio, uint32_t n) {
+		for (uint32_t c = 0; c < n; c++) dst[c] -= src[c] * ratio;
+	}
+	
+	void divRow(double* dst, double divisor, uint32_t n) {
+		for (uint32_t c = 0; c < n; c++) dst[c] /= divisor;
+	}
+	
+	int32_t findFirstAtLeast(const double* src, uint32_t n, double threshold) {
+		for (uint32_t c = 0; c < n; c++) if (src[c] >= threshold) return c;
+		return -1;
+	}
+	
+	int32_t findMinNegRatio(const double* head, const double* row, uint32_t n, double eps, uint32_t begin, double minRatio, int32_t minIndex) { // 從 begin 接著掃 (給 SIMD 版處理尾端)
+		for (uint32_t c = begin; c < n; c++) if (row[c] <= -eps) {
+			const double ratio = max(0.0, head[c] / row[c]);
+			if (ratio < minRatio) {
+				minRatio = ratio;
+				minIndex = c;
+			}
+		}
+		return minIndex;
+	}
+	
+	int32_t findMinNegRatio(const double* head, const double* row, uint32_t n, double eps) {
+		return findMinNegRatio(head, row, n, eps, 0, 1e300, -1);
+	}
+	
+	struct FixedElimination {
+		template<uint32_t COLS> static void eliminate(double* arr, uint32_t rows, uint32_t i, uint32_t j) { FixedSizeKernels::eliminate<COLS>(arr, rows, i, j); }
+	};
+	constexpr FixedEliminationTable fixedEliminations = FixedSizeKernels::makeTable<FixedElimination>();
+	
+	const SimdKernels kernels = { "scalar", 1, subScaledRow, divRow, findFirstAtLeast, findMinNegRatio, &fixedEliminations };
+}
+
+#ifdef SIMD_X86
+namespace Avx2Kernels { // AVX2 + FMA, 4 個 double
+	__attribute__((target("avx2,fma"))) void subScaledRow(double* dst, const double* src, double ratio, uint32_t n) {
+		const __m256d vecRatio = _mm256_set1_pd(ratio);
+		uint32_t c = 0;
+		for (; c + 4 <= n; c += 4) _mm256_storeu_pd(dst + c, _mm256_fnmadd_pd(_mm256_loadu_pd(src + c), vecRatio, _mm256_loadu_pd(dst + c))); // 向量運算不能超出列尾
+		for (; c < n; c++) dst[c] -= src[c] * ratio;
+	}
+	
+	__attribute__((target("avx2,fma"))) void divRow(double* dst, double divisor, uint32_t n) {
+		const __m256d vecDivisor = _mm256_set1_pd(divisor);
+		uint32_t c = 0;
+		for (; c + 4 <= n; c += 4) _mm256_storeu_pd(dst + c, _mm256_div_pd(_mm256_loadu_pd(dst + c), vecDivisor));
+		for (; c < n; c++) dst[c] /= divisor;
+	}
+	
+	__attribute__((target("avx2,fma"))) int32_t findFirstAtLeast(const double* src, uint32_t n, double threshold) {
+		const __m256d vecThreshold = _mm256_set1_pd(threshold);
+		uint32_t c = 0;
+		for (; c + 4 <= n; c += 4) {
+			const int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(src + c), vecThreshold, _CMP_GE_OQ));
+			if (mask != 0) return c + __builtin_ctz(mask);
+		}
+		for (; c < n; c++) if (src[c] >= threshold) return c;
+		return -1;
+	}
+	
+	__attribute__((target("avx2,fma"))) int32_t findMinNegRatio(const double* head, const double* row, uint32_t n, double eps) {
+		const __m256d vecNegEps = _mm256_set1_pd(-eps), vecZero = _mm256_setzero_pd(), vecNone = _mm256_set1_pd(1e300);
+		__m256d vecMin = vecNone, vecMinIndex = _mm256_setzero_pd(); // 每個 lane 各自的最小比值和位置 (位置用 double 存, 2^53 以內是精確的)
+		__m256d vecIndex = _mm256_set_pd(3, 2, 1, 0);
+		const __m256d vecStep = _mm256_set1_pd(4);
+		uint32_t c = 0;
+		for (; c + 4 <= n; c += 4, vecIndex = _mm256_add_pd(vecIndex, vecStep)) {
+			const __m256d vecRow = _mm256_loadu_pd(row + c);
+			const __m256d isEligible = _mm256_cmp_pd(vecRow, vecNegEps, _CMP_LE_OQ);
+			const __m256d vecRatio = _mm256_blendv_pd(vecNone, _mm256_max_pd(_mm256_div_pd(_mm256_loadu_pd(head + c), vecRow), vecZero), isEligible);
+			const __m256d isLess = _mm256_cmp_pd(vecRatio, vecMin, _CMP_LT_OQ); // 嚴格小於, 每個 lane 保留第一次出現的位置
+			vecMin = _mm256_blendv_pd(vecMin, vecRatio, isLess);
+			vecMinIndex = _mm256_blendv_pd(vecMinIndex, vecIndex, isLess);
+		}
+		double mins[4], minIndexs[4];
+		_mm256_storeu_pd(mins, vecMin);
+		_mm256_storeu_pd(minIndexs, vecMinIndex);
+		double minRatio = 1e300;
+		int32_t minIndex = -1;
+		for (uint32_t lane = 0; lane < 4; lane++) if (mins[lane] < minRatio || (mins[lane] == minRatio && mins[lane] < 1e300 && minIndexs[lane] < minIndex)) {
+			minRatio = mins[lane];
+			minIndex = (int32_t)minIndexs[lane];
+		}
+		return ScalarKernels::findMinNegRatio(head, row, n, eps, c, minRatio, minIndex);
+	}
+	
+	struct FixedElimination {
+		template<uint32_t COLS> __attribute__((target("avx2,fma"))) static void eliminate(double* arr, uint32_t rows, uint32_t i, uint32_t j) { FixedSizeKernels::eliminate<COLS>(arr, rows, i, j); }
+	};
+	constexpr FixedEliminationTable fixedEliminations = FixedSizeKernels::makeTable<FixedElimination>();
+	
+	const SimdKernels kernels = { "avx2+fma", 4, subScaledRow, divRow, findFirstAtLeast, findMinNegRatio, &fixedEliminations };
+}
+
+namespace Avx512Kernels { // AVX-512F, 8 個 double, 尾端用 mask 處理
+	__attribute__((target("avx512f"))) void subScaledRow(double* dst, const double* src, double ratio, uint32_t n) {
+		const __m512d vecRatio = _mm512_set1_pd(ratio);
+		uint32_t c = 0;
+		for (; c + 8 <= n; c += 8) _mm512_storeu_pd(dst + c, _mm512_fnmadd_pd(_mm512_loadu_pd(src + c), vecRatio, _mm512_loadu_pd(dst + c)));
+		if (c < n) {
+			const __mmask8 tail = (__mmask8)((1u << (n - c)) - 1);
+			_mm512_mask_storeu_pd(dst + c, tail, _mm512_fnmadd_pd(_mm512_maskz_loadu_pd(tail, src + c), vecRatio, _mm512_maskz_loadu_pd(tail, dst + c)));
+		}
+	}
+	
+	__attribute__((target("avx512f"))) void divRow(double* dst, double divisor, uint32_t n) {
+		const __m512d vecDivisor = _mm512_set1_pd(divisor);
+		uint32_t c = 0;
+		for (; c + 8 <= n; c += 8) _mm512_storeu_pd(dst + c, _mm512_div_pd(_mm512_loadu_pd(dst + c), vecDivisor));
+		for (; c < n; c++) dst[c] /= divisor;
+	}
+	
+	__attribute__((target("avx512f"))) int32_t findFirstAtLeast(const double* src, uint32_t n, double threshold) {
+		const __m512d vecThreshold = _mm512_set1_pd(threshold);
+		uint32_t c = 0;
+		for (; c + 8 <= n; c += 8) {
+			const __mmask8 mask = _mm512_cmp_pd_mask(_mm512_loadu_pd(src + c), vecThreshold, _CMP_GE_OQ);
+			if (mask != 0) return c + __builtin_ctz(mask);
+		}
+		for (; c < n; c++) if (src[c] >= threshold) return c;
+		return -1;
+	}
+	
+	__attribute__((target("avx512f"))) int32_t findMinNegRatio(const double* head, const double* row, uint32_t n, double eps) {
+		const __m512d vecNegEps = _mm512_set1_pd(-eps), vecZero = _mm512_setzero_pd(), vecNone = _mm512_set1_pd(1e300);
+		__m512d vecMin = vecNone, vecMinIndex = _mm512_setzero_pd();
+		__m512d vecIndex = _mm512_set_pd(7, 6, 5, 4, 3, 2, 1, 0);
+		const __m512d vecStep = _mm512_set1_pd(8);
+		uint32_t c = 0;
+		for (; c + 8 <= n; c += 8, vecIndex = _mm512_add_pd(vecIndex, vecStep)) {
+			const __m512d vecRow = _mm512_loadu_pd(row + c);
+			const __mmask8 isEligible = _mm512_cmp_pd_mask(vecRow, vecNegEps, _CMP_LE_OQ);
+			const __m512d vecRatio = _mm512_mask_blend_pd(isEligible, vecNone, _mm512_max_pd(_mm512_div_pd(_mm512_loadu_pd(head + c), vecRow), vecZero));
+			const __mmask8 isLess = _mm512_cmp_pd_mask(vecRatio, vecMin, _CMP_LT_OQ);
+			vecMin = _mm512_mask_blend_pd(isLess, vecMin, vecRatio);
+			vecMinIndex = _mm512_mask_blend_pd(isLess, vecMinIndex, vecIndex);
+		}
+		double mins[8], minIndexs[8];
+		_mm512_storeu_pd(mins, vecMin);
+		_mm512_storeu_pd(minIndexs, vecMinIndex);
+		double minRatio = 1e300;
+		int32_t minIndex = -1;
+		for (uint32_t lane = 0; lane < 8; lane++) if (mins[lane] < minRatio || (mins[lane] == minRatio && mins[lane] < 1e300 && minIndexs[lane] < minIndex)) {
+			minRatio = mins[lane];
+			minIndex = (int32_t)minIndexs[lane];
+		}
+		return ScalarKernels::findMinNegRatio(head, row, n, eps, c, minRatio, minIndex);
+	}
+	
+	struct FixedElimination { // fma: 512 位元以外的部分也要用 FMA, 結果才會和 subScaledRow 一樣
+		template<uint32_t COLS> __attribute__((target("avx512f,fma,prefer-vector-width=512"))) static void eliminate(double* arr, uint32_t rows, uint32_t i, uint32_t j) { FixedSizeKernels::eliminate<COLS>(arr, rows, i, j); }
+	};
+	constexpr FixedEliminationTable fixedEliminations = FixedSizeKernels::makeTable<FixedElimination>();
+	
+	const SimdKernels kernels = { "avx512f", 8, subScaledRow, divRow, findFirstAtLeast, findMinNegRatio, &fixedEliminations };
+}
+#endif
+
+#ifdef SIMD_NEON
+namespace NeonKernels { // aarch64 一定有 NEON, 2 個 double
+	void subScaledRow(double* dst, const double* src, double ratio, uint32_t n) {
+		const float64x2_t vecRatio = vdupq_n_f64(ratio);
+		uint32_t c = 0;
+		for (; c + 2 <= n; c += 2) vst1q_f64(dst + c, vfmsq_f64(vld1q_f64(dst + c), vld1q_f64(src + c), vecRatio));
+		for (; c < n; c++) dst[c] -= src[c] * ratio;
+	}
+	
+	void divRow(double* dst, double divisor, uint32_t n) {
+		const float64x2_t vecDivisor = vdupq_n_f64(divisor);
+		uint32_t c = 0;
+		for (; c + 2 <= n; c += 2) vst1q_f64(dst + c, vdivq_f64(vld1q_f64(dst + c), vecDivisor));
+		for (; c < n; c++) dst[c] /= divisor;
+	}
+	
+	int32_t findFirstAtLeast(const double* src, uint32_t n, double threshold) {
+		const float64x2_t vecThreshold = vdupq_n_f64(threshold);
+		uint32_t c = 0;
+		for (; c + 2 <= n; c += 2) {
+			const uint64x2_t mask = vcgeq_f64(vld1q_f64(src + c), vecThreshold);
+			if (vgetq_lane_u64(mask, 0)) return c;
+			if (vgetq_lane_u64(mask, 1)) return c + 1;
+		}
+		for (; c < n; c++) if (src[c] >= threshold) return c;
+		return -1;
+	}
+	
+	int32_t findMinNegRatio(const double* head, const double* row, uint32_t n, double eps) {
+		const float64x2_t vecNegEps = vdupq_n_f64(-eps), vecZero = vdupq_n_f64(0), vecNone = vdupq_n_f64(1e300);
+		float64x2_t vecMin = vecNone, vecMinIndex = vecZero;
+		float64x2_t vecIndex = { 0, 1 };
+		const float64x2_t vecStep = vdupq_n_f64(2);
+		uint32_t c = 0;
+		for (; c + 2 <= n; c += 2, vecIndex = vaddq_f64(vecIndex, vecStep)) {
+			const float64x2_t vecRow = vld1q_f64(row + c);
+			const uint64x2_t isEligible = vcleq_f64(vecRow, vecNegEps);
+			const float64x2_t vecRatio = vbslq_f64(isEligible, vmaxnmq_f64(vdivq_f64(vld1q_f64(head + c), vecRow), vecZero), vecNone);
+			const uint64x2_t isLess = vcltq_f64(vecRatio, vecMin);
+			vecMin = vbslq_f64(isLess, vecRatio, vecMin);
+			vecMinIndex = vbslq_f64(isLess, vecIndex, vecMinIndex);
+		}
+		double minRatio = 1e300;
+		int32_t minIndex = -1;
+		for (uint32_t lane = 0; lane < 2; lane++) {
+			const double laneMin = lane == 0 ? vgetq_lane_f64(vecMin, 0) : vgetq_lane_f64(vecMin, 1);
+			const double laneIndex = lane == 0 ? vgetq_lane_f64(vecMinIndex, 0) : vgetq_lane_f64(vecMinIndex, 1);
+			if (laneMin < minRatio || (laneMin == minRatio && laneMin < 1e300 && laneIndex < minIndex)) {
+				minRatio = laneMin;
+				minIndex = (int32_t)laneIndex;
+			}
+		}
+		return ScalarKernels::findMinNegRatio(head, row, n, eps, c, minRatio, minIndex);
+	}
+	
+	struct FixedElimination {
+		template<uint32_t COLS> static void eliminate(double* arr, uint32_t rows, uint32_t i, uint32_t j) { FixedSizeKernels::eliminate<COLS>(arr, rows, i, j); }
+	};
+	constexpr FixedEliminationTable fixedEliminations = FixedSizeKernels::makeTable<FixedElimination>();
+	
+	const SimdKernels kernels = { "neon", 2, subScaledRow, divRow, findFirstAtLeast, findMinNegRatio, &fixedEliminations };
+}
+#endif
+
+const SimdKernels& selectSimdKernels() { // 啟動時用 CPUID (x86) 選最寬的 kernel
+#ifdef SIMD_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) return Avx512Kernels::kernels;
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Avx2Kernels::kernels;
+#endif
+#ifdef SIMD_NEON
+	return NeonKernels::kernels;
+#endif
+	return ScalarKernels::kernels;
+}
+const SimdKernels& simdKernels = selectSimdKernels();
+
+bool enableIntraLPParallel = false; // 啟用單一 LP 內的平行化: tableau 夠大時, 列運算和 ratio test 分給多個 thread
+size_t intraLPParallelMinCells = 1 << 15; // tableau 元素數 (rows * cols) 至少要這麼多才值得開 thread
+
+bool useIntraLPParallel(size_t cells) { // 是否要在這次列運算/ratio test 開 thread. 已經在 node-level 平行區域內就不開 (巢狀平行只會搶核心)
+	return enableIntraLPParallel && cells >= intraLPParallelMinCells && !omp_in_parallel();
+}
+
+// 平行化版本的 array elimination, 用 A_{ij} 消去行 j 的其他元素, 並將列 i 同除 A_{ij}, 使 A_{ij} = 1
 void parallelArrayElimination(uint32_t cols, vector<double>& arr, uint32_t i, uint32_t j) { // arr 是扁平化的二維陣列
 	uint32_t rows = arr.size() / cols;
+	if (enableFixedSizeKernels && cols <= FIXED_ELIMINATION_MAX_COLS && !useIntraLPParallel(arr.size())) { // [fixed-size kernel] 小 tableau 整個消元一次呼叫
+		(*simdKernels.fixedEliminations)[cols](arr.data(), rows, i, j);
+		return;
+	}
 	
-	const uint32_t simdWidth = 4; // 一次處理 4 個 double
 	double* ptrRowI = arr.data() + cols * (size_t)(i); // A_{i0} 的指標
 	
-	for (uint32_t k = 0; k < rows; k++) { // k 為每個 pthread 負責的列運算 row 編號, 將列 i 乘常數消去列 k
-		if (k == i) continue; // 列 i 不能消去列 i
+	auto eliminateRow = [&](uint32_t k) { // 將列 i 乘常數消去列 k
+		if (k == i) return; // 列 i 不能消去列 i
 		
 		double* ptrRowK = arr.data() + cols * (size_t)(k); // A_{k0} 的指標
+		if (ptrRowK[j] == 0) return; // 行 j 已經是 0, 列運算不會改變列 k (只能跳過剛好為 0 的: 跳過 |A_kj| <= EPS 的列會讓行 j 留下非零值, 基底被破壞而卡在循環)
 		const double ratio = ptrRowK[j] / ptrRowI[j]; // 列 i 乘常數加到列 k, 消去行 j 的其他元素
-		// if (FOP::isZero(ratio)) continue; // [我不知道為什麼加這一行會卡死] 常數是 0 就不做列運算
-		
-		__m256d vecRatio = _mm256_set1_pd(ratio); // 全部都是常數的向量
-		uint32_t c = 0;
-		for (; c + (simdWidth-1) < cols; c += simdWidth) { // 向量運算不能超出列 k, 不然會寫到列 k+1 的記憶體
-			__m256d vecScaled = _mm256_mul_pd(_mm256_loadu_pd(ptrRowI + c), vecRatio); // 列 i 乘常數 (vec)
-			_mm256_storeu_pd(ptrRowK + c, _mm256_sub_pd(_mm256_loadu_pd(ptrRowK + c), vecScaled)); // 列 i 乘常數消去列 k (vec)
-		}
-		for (; c < cols; c++) ptrRowK[c] -= ptrRowI[c] * ratio; // 列 i 乘常數消去列 k
 		
+		simdKernels.subScaledRow(ptrRowK, ptrRowI, ratio, cols); // 列 i 乘常數消去列 k
 		ptrRowK[j] = 0; // 保證行 j 的其他元素被消去
+	};
+	if (useIntraLPParallel(arr.size())) { // [intra-LP parallel] 每一列的列運算互相獨立, 分給多個 thread
+		#pragma omp parallel for schedule(static)
+		for (uint32_t k = 0; k < rows; k++) eliminateRow(k); // k 為每個 pthread 負責的列運算 row 編號
+	} else {
+		for (uint32_t k = 0; k < rows; k++) eliminateRow(k);
 	}
 	
-	const double aij = arr[cols * i + j];
-	for (uint32_t k = 0; k < cols; k++) arr[cols * i + k] /= aij; // 列 i 同除 A_{ij}, 使 A_{ij} = 1
+	simdKernels.divRow(ptrRowI, ptrRowI[j], cols); // 列 i 同除 A_{ij}, 使 A_{ij} = 1
 }
 // 平行化區域 end
 
 // 以下為單執行序的原始演算法
 
+bool enableWarmStartDualSimplex = false; // 啟用 branch & bound 子節點 warm start: 從父節點的最佳 tableau 出發, 用 dual simplex 重新最佳化
+bool enableBoundedSimplex = false; // 啟用 bounded simplex: 變數範圍直接在 ratio test 處理, 不轉為約束列 (tableau 大小固定為約束數)
+
+enum class LPEngine { TABLEAU, REVISED }; // LP 引擎: 稠密 tableau, revised simplex (稀疏矩陣 + LU 分解基底)
+LPEngine lpEngine = LPEngine::TABLEAU;
+enum class PricingRule { FIRST_POSITIVE, DANTZIG, STEEPEST_EDGE, DEVEX }; // [pricing] tableau 引擎選擇進入基底的規則: 編號最小的正 reduced cost, reduced cost 最大, 最陡邊 (除以行的長度), devex (近似最陡邊的參考權重)
+PricingRule pricingRule = PricingRule::FIRST_POSITIVE;
+bool enableHarrisRatioTest = false; // [Harris] tableau 引擎的 ratio test 先用放寬的誤差找最大步長, 再在步長內挑 pivot 絕對值最大的列, 避免太小的 pivot
+thread_local uint64_t lpPivotCount = 0; // [benchmark] 這個 thread 累計的 simplex 迭代數 (pivot 和翻界), IP 在 solve 前後取差值, 不用同步
+thread_local uint32_t lpTieBreakSeed = 0; // [portfolio] 選進入基底的變數時從第 seed % 行數 行開始掃描 (同分時選到不同的行), 0 代表照編號順序. IP 在 solve 的每個 thread 設定
+bool enableAntiStalling = false; // [anti-stalling] 連續退化 pivot (目標值沒有改變) 太多次時改用 Bland's rule (保證不會循環), 目標值改善後換回原本的規則
+
+bool useAntiStalling() { // [anti-stalling] FIRST_POSITIVE 本身就是 Bland's rule 的進入規則, 其他 pricing 規則在退化頂點可能循環, 一律開啟
+	return enableAntiStalling || pricingRule != PricingRule::FIRST_POSITIVE;
+}
+bool enablePresolve = false; // 啟用 presolve: 建立 SparseModel 前先化簡約束和變數範圍, 解完再 postsolve 回原本的變數
+bool enableBoundPropagation = false; // 啟用 node 變數範圍收緊: reduced cost fixing (需要 incumbent) 和約束的活動範圍傳遞 (enableRowPropagation), 在子節點解 LP 之前套用
+bool enableRowPropagation = false; // [propagation] 子節點解 LP 前用約束的活動範圍收緊變數範圍, 記錄在分支路徑上. 收緊的界會改變 LP 停在的退化頂點, node 數時多時少 ((4, 4, 4, 4) high-fixed-cost revised: 89 -> 363), 預設關閉
+
+bool useReducedCostFixing() { // [reduced cost fixing] 冷啟動的 tableau (沒有 bounded simplex) 每個有限的界都是一個 bound 列, 固定出來的界會讓整個子樹的 LP 多出 bound 列和退化頂點, (3, 3, 3, 3) 的 node 數從 1395 變成 5 萬以上, 所以只在界不佔列的解法使用
+	return enableBoundPropagation && (enableBoundedSimplex || enableWarmStartDualSimplex || lpEngine == LPEngine::REVISED);
+}
+bool enableCuttingPlanes = false; // 啟用 root node 的 cutting plane: Gomory mixed-integer cut (需要 tableau 引擎) 和 cover cut, 加入模型後所有 node 共用
+bool enablePrimalHeuristics = false; // 啟用 primal heuristic: root 做 rounding, fractional diving, feasibility pump, 之後每隔幾個 node 做一次 diving, 提早找到 incumbent
+
+#ifdef USE_GPU
+#include "tableau_gpu.hpp"
+bool enableGpuTableau = false; // [GPU] tableau 引擎的 primal simplex 在 GPU 上做 pricing, ratio test 和列運算 (make gpu / make hip 才會編譯)
+size_t gpuTableauMinCells = 1 << 20; // tableau 元素數至少要這麼多才值得搬到 GPU (root LP 這種大的 LP)
+
+bool useGpuTableau(size_t cells) { // 只有單純的規則 (FIRST_POSITIVE, 一般 ratio test, 沒有變數上界) 在 GPU 上有對應的 kernel. DANTZIG 一定要搭配 anti-stalling, GPU 沒有 Bland's rule 的退路. 已經在 node-level 平行區域內就不用 (每個 node 的 LP 太小)
+	return enableGpuTableau && cells >= gpuTableauMinCells && !omp_in_parallel() && !useAntiStalling()
+		&& !enableHarrisRatioTest && !enableBoundedSimplex && gpuTableauIsAvailable();
+}
+#endif
+
+enum class NodeSelection { BEST_BOUND, DEPTH_FIRST, HYBRID_DIVE }; // node 選擇策略: 下界最小, 深度優先 (先走下界較小的子節點), 從目前 node 往下 dive 到被剪枝再跳回下界最小的 node
+enum class BranchingRule { FIRST_INDEX, MOST_FRACTIONAL, PSEUDOCOST, RELIABILITY, STRONG }; // 分支變數的選擇規則: 編號最小, 最接近 .5, pseudocost, reliability (pseudocost 不可靠時用 strong), strong branching
+
 const double FP64_INF = numeric_limits<double>::infinity();
 const double FP64_NAN = numeric_limits<double>::quiet_NaN();
 
+inline uint64_t readCycleCounter() { // [stats] 計時用的 cycle counter (x86 為 TSC, 其他平台為 steady_clock 的 tick), IP::getStats 再用整次 solve 的時間換算成 ms
+#ifdef SIMD_X86
+	return __rdtsc();
+#else
+	return chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+struct alignas(64) SolverCounters { // [stats] 一個 thread 的計數器和計時器, 只有所屬的 thread 會寫 (不用 read-modify-write), IP::getStats 可以在 solve 中從其他 thread 讀. 對齊 cache line 避免 false sharing
+	enum Counter {
+		PHASE1_PIVOT, PHASE2_PIVOT, DUAL_PIVOT, // simplex 迭代數, phase-2 包含 warm start 之後的 primal simplex
+		ELIMINATION_CYCLES, INSERT_CON_CYCLES, QUEUE_WAIT_CYCLES, QUEUE_LOCK_CYCLES, // Tableau::elimination, insertConToTableau, solveParallel 等待 node (包含上鎖), 等待 shard 的鎖
+		CHECKED_NODE, BRANCHED_NODE, BOUND_PRUNED_NODE, INFEASIBLE_NODE, INTEGRAL_NODE, // 解過 LP 的 node, 被分支, 被下界剪枝 (包含 cutoff 和取出時才剪掉的), 無解, 整數解
+		SPILLED_NODE, // [spill] 寫到磁碟的 node (讀回來後再寫出去會重複計算)
+		COUNTER_COUNT
+	};
+	
+	atomic<uint64_t> values[COUNTER_COUNT];
+	atomic<double> nodeBound; // 這個 thread 目前 node 下界和 heap 頂端下界的較小值 (min 問題), 閒置時為 inf, 給 dual bound 用
+	double lastSampleObjValue = FP64_NAN, lastSampleTimeMs = 0; // IP::recordGapSample 用, 只有所屬的 thread 會讀寫
+	
+	SolverCounters() {
+		reset();
+	}
+	
+	SolverCounters(const SolverCounters& other) { // IP 需要可以複製
+		for (uint32_t c = 0; c < COUNTER_COUNT; c++) values[c] = other.get((Counter)c);
+		nodeBound = other.nodeBound.load();
+		lastSampleObjValue = other.lastSampleObjValue;
+		lastSampleTimeMs = other.lastSampleTimeMs;
+	}
+	
+	void reset() {
+		for (auto& value: values) value = 0;
+		nodeBound = FP64_INF;
+	}
+	
+	void add(Counter counter, uint64_t value = 1) {
+		values[counter].store(values[counter].load(memory_order_relaxed) + value, memory_order_relaxed);
+	}
+	
+	uint64_t get(Counter counter) const {
+		return values[counter].load(memory_order_relaxed);
+	}
+};
+thread_local SolverCounters localSolverCounters; // [stats] 沒有 IP 在這個 thread 上 solve 時 (例如直接建 LP) 寫到這裡
+thread_local SolverCounters* solverCounters = &localSolverCounters; // [stats] 這個 thread 目前要寫的計數器, IP 在 solve 時換成自己的
+
+class SolverCountersScope { // [stats] 作用域內這個 thread 的計數寫到指定的計數器, 結束時換回原本的
+private:
+	SolverCounters* previous;
+
+public:
+	SolverCountersScope(SolverCounters& counters): previous(solverCounters) {
+		solverCounters = &counters;
+	}
+	
+	~SolverCountersScope() {
+		solverCounters = previous;
+	}
+};
+
+class CycleTimer { // [stats] 作用域結束時把經過的 cycle 加到這個 thread 的計數器
+private:
+	SolverCounters::Counter counter;
+	uint64_t startCycle;
+
+public:
+	CycleTimer(SolverCounters::Counter counter): counter(counter), startCycle(readCycleCounter()) {}
+	
+	~CycleTimer() {
+		solverCounters->add(counter, readCycleCounter() - startCycle);
+	}
+};
+
 enum class Relation { LEQ, EQ, GEQ }; // <= (LEQ), = (EQ), >= (GEQ)
 
 template <typename K, typename V>
@@ -79,8 +503,24 @@ bool mapHasKey(const unordered_map<K, V>& m, const K& key) {
 
 class VarBimap { // 變數名稱與編號的雙向映射
 private:
+	struct LazyBlock { // [index model] 一段連續編號的變數, 名稱只在需要時 (印出, 用名稱查詢) 才由 nameOf 產生
+		uint32_t start;
+		uint32_t count;
+		function<string(uint32_t)> nameOf; // 參數為區段內的 offset
+	};
+	
 	unordered_map<string, uint32_t> strToIndex;
-	vector<string> indexToStr;
+	vector<string> indexToStr; // lazy 區段的變數為空字串
+	vector<LazyBlock> lazyBlocks; // 依照 start 排序
+	bool isLazyNameIndexed = true; // lazy 區段的名稱是否已經放進 strToIndex
+	
+	void indexLazyNames() { // 第一次用名稱查詢時, 才把所有 lazy 區段的名稱放進 strToIndex
+		if (isLazyNameIndexed) return;
+		for (const LazyBlock& block: lazyBlocks) {
+			for (uint32_t offset = 0; offset < block.count; offset++) strToIndex[block.nameOf(offset)] = block.start + offset;
+		}
+		isLazyNameIndexed = true;
+	}
 
 public:
 	uint32_t getVarCount() const { // 獲取已註冊變數的數量
@@ -88,6 +528,7 @@ public:
 	}
 	
 	uint32_t getVarIndex(const string& varName) { // 註冊一個字串變數, 自動分配編號, 回傳這個字串變數對應的編號 j (x_j)
+		indexLazyNames();
 		if (mapHasKey<string, uint32_t>(strToIndex, varName)) return strToIndex[varName]; // 如果字串變數已註冊過, 回傳對應的編號 j
 		
 		const uint32_t newVarIndex = getVarCount(); // 如果字串變數沒有註冊過, 分配編號 0, 1, 2, ...
@@ -96,9 +537,20 @@ public:
 		return newVarIndex; // 回傳分配的新編號
 	}
 	
+	uint32_t addLazyVars(uint32_t count, function<string(uint32_t)> nameOf) { // [index model] 註冊 count 個連續編號的變數, 不建立字串, 回傳第一個編號
+		const uint32_t start = getVarCount();
+		indexToStr.resize(start + count);
+		lazyBlocks.push_back({ start, count, move(nameOf) });
+		isLazyNameIndexed = false; // 之後用名稱查詢時再建立
+		return start;
+	}
+	
 	string getVarName(uint32_t varIndex) const { // 編號 j (x_j) 轉字串變數
-		if (varIndex <= indexToStr.size() - 1) return indexToStr[varIndex];
-		return "[unknown-var]";
+		if (varIndex >= indexToStr.size()) return "[unknown-var]";
+		if (!indexToStr[varIndex].empty()) return indexToStr[varIndex];
+		auto it = upper_bound(lazyBlocks.begin(), lazyBlocks.end(), varIndex, [](uint32_t j, const LazyBlock& block) { return j < block.start; });
+		const LazyBlock& block = *prev(it); // 包含 varIndex 的區段
+		return block.nameOf(varIndex - block.start);
 	}
 };
 
@@ -132,11 +584,21 @@ private:
 	Linearform linearform; // 線性函數
 	Relation relation = Relation::EQ; // >= or = or <=
 	double rightConst = 0; // 右側常數
+	bool isNegated = false; // [what-if] 是否被 stdOfNegativeRightConst 變號過, 修改時要換回使用者給的方向
 	
 	void set(Relation relation, double rightConst) { // leq, eq, geq 共用的 set 邏輯
 		this->relation = relation;
 		this->rightConst = rightConst;
 	}
+	
+	void negate() { // 兩側同乘 -1
+		rightConst = -rightConst; // 對右側常數變號
+		linearform.negate(); // 對所有係數變號
+		
+		if (relation == Relation::LEQ) relation = Relation::GEQ; // 兩側變號需要將 <= 和 >= 轉向
+		else if (relation == Relation::GEQ) relation = Relation::LEQ;
+		isNegated = !isNegated;
+	}
 
 public:
 	Constraint& add(double coef, uint32_t varIndex) { // 添加一個未知數項 (chaining)
@@ -144,6 +606,11 @@ public:
 		return *this;
 	}
 	
+	Constraint& reserve(uint32_t termCount) { // [index model] 預先配置 termCount 項的空間 (chaining)
+		linearform.terms.reserve(termCount);
+		return *this;
+	}
+	
 	Constraint& leq(double rightConst) { // 添加最右側的 "<= r" 部分 (chaining)
 		set(Relation::LEQ, rightConst);
 		return *this;
@@ -159,22 +626,33 @@ public:
 		return *this;
 	}
 	
-	unordered_map<uint32_t, double> getTerms() {
+	const unordered_map<uint32_t, double>& getTerms() const {
 		return linearform.terms;
 	}
 	
-	double getRightConst() {
+	double getRightConst() const {
 		return rightConst;
 	}
 	
+	Relation getRelation() const {
+		return relation;
+	}
+	
 	void stdOfNegativeRightConst() { // 對負的右側常數進行標準化
 		if (rightConst >= 0) return; // 若右側常數 >= 0, 跳過這一步
-		
-		rightConst = -rightConst; // 對右側常數變號
-		linearform.negate(); // 對所有係數變號
-		
-		if (relation == Relation::LEQ) relation = Relation::GEQ; // 兩側變號需要將 <= 和 >= 轉向
-		else if (relation == Relation::GEQ) relation = Relation::LEQ;
+		negate();
+	}
+	
+	void setRightConst(double rightConst) { // [what-if] 以使用者給的方向修改右側常數, 再重新標準化
+		if (isNegated) negate();
+		this->rightConst = rightConst;
+		stdOfNegativeRightConst();
+	}
+	
+	void setCoef(double coef, uint32_t varIndex) { // [what-if] 以使用者給的方向修改 x_j 的係數, 0 代表移除這一項
+		if (isNegated) coef = -coef;
+		if (coef == 0) linearform.terms.erase(varIndex);
+		else linearform.terms[varIndex] = coef;
 	}
 	
 	bool haveSlackVar() { // 是否需要添加 slack var
@@ -204,499 +682,4511 @@ public:
 	}
 };
 
-class LP { // Linear Programming
-private:
-	class Tableau { // tableau, 注意: 第零列為 head, 第一列開始才是約束的部分
-	private:
-		vector<double> arr; // 扁平化的二維陣列
-		
-		double& arr_(uint32_t i, uint32_t j) { // 訪問扁平化的二維陣列
-			return arr[cols * i + j];
-		}
+class SparseModel { // [sparse model] 目標函數和約束矩陣的壓縮儲存 (CSR + CSC), IP 建模完成後建立一次, 所有 node 和 thread 唯讀共用
+public:
+	uint32_t rowCount = 0; // 約束數
+	uint32_t colCount = 0; // 變數數
 	
-	public:
-		uint32_t rows; // row 數
-		uint32_t cols; // col 數
-		vector<int32_t> baseVarIndexs; // 基底變數的編號, -1 代表 artifical var
-		
-		double& operator()(uint32_t i, uint32_t j) { // 訪問扁平化的二維陣列
-			return arr[cols * i + j];
-		};
-		
-		void init(uint32_t rows, uint32_t cols) { // 初始化 tableau
-			this->rows = rows; // 設定列數
-			this->cols = cols; // 設定行數
-			arr = vector<double>(rows * cols, 0); // 預設全為零
-			baseVarIndexs = vector<int32_t>(rows, 0); // 因為第零列沒有基底編號, 使 index 對齊
-		}
-		
-		void scaleRow(uint32_t i, double s) { // 將列 i 除以常數 s
-			for (uint32_t k = 0; k < cols; k++) arr_(i, k) /= s;
-		}
-		
-		void addRowToRow(uint32_t i, uint32_t j, double s) { // 列 i 乘常數 s 加到列 j
-			for (uint32_t k = 0; k < cols; k++) arr_(j, k) += arr_(i, k) * s;
-		}
-		
-		void elimination(uint32_t i, uint32_t j) { // 用 A_{ij} 消去行 j 的其他元素, 並將列 i 同除 A_{ij}, 使 A_{ij} = 1
-			if (enableMatrixEliminationParallel) { // 啟用矩陣列運算 avx256 向量化加速
-				parallelArrayElimination(cols, arr, i, j);
-				return; // 跳過原始演算法
-			}
-			
-			const double aij = arr_(i, j);
-			for (uint32_t k = 0; k < rows; k++) {
-				if (k != i) addRowToRow(i, k, -arr_(k, j) / aij); // 用 A_{ij} 消去行 j 的其他元素
-			}
-			// 消去完成後,再統一設為 0
-			for (uint32_t k = 0; k < rows; k++) {
-				if (k != i) arr_(k, j) = 0;
+	vector<uint32_t> rowStart; // CSR: 第 i 列的非零元素為 [rowStart[i], rowStart[i+1]), 列內依照行編號排序
+	vector<uint32_t> rowColIndexs;
+	vector<double> rowCoefs;
+	
+	vector<uint32_t> colStart; // CSC: 第 j 行的非零元素為 [colStart[j], colStart[j+1]), 行內依照列編號排序
+	vector<uint32_t> colRowIndexs;
+	vector<double> colCoefs;
+	
+	vector<Relation> relations; // 每一列的關係
+	vector<double> rightConsts; // 每一列的右側常數
+	vector<double> objCoefs; // 目標函數的稠密係數, 長度 colCount
+	
+	SparseModel() = default;
+	
+	SparseModel(const Linearform& objFunc, const vector<Constraint>& multiCon, uint32_t varCount)
+	: rowCount(multiCon.size()), colCount(varCount) {
+		rowStart.reserve(rowCount + 1);
+		rowStart.push_back(0);
+		vector<pair<uint32_t, double>> rowTerms; // 暫存一列並排序 (unordered_map 沒有順序)
+		for (const Constraint& con: multiCon) {
+			rowTerms.assign(con.getTerms().begin(), con.getTerms().end());
+			sort(rowTerms.begin(), rowTerms.end());
+			for (auto& [varIndex, coef]: rowTerms) {
+				rowColIndexs.push_back(varIndex);
+				rowCoefs.push_back(coef);
 			}
-			scaleRow(i, aij); // 將列 i 同除 A_{ij}, 使 A_{ij} = 1
+			rowStart.push_back(rowColIndexs.size());
+			relations.push_back(con.getRelation());
+			rightConsts.push_back(con.getRightConst());
 		}
 		
-		void print() { // debug
-			for (uint32_t i = 0; i < rows; i++) {
-				for (uint32_t j = 0; j < cols; j++) printf("%.02f ", (*this)(i, j));
-				if (i > 0) printf("= x_%d", baseVarIndexs[i]); // print 基底
-				printf("\n");
+		buildColumns();
+		
+		objCoefs.assign(colCount, 0);
+		for (auto& [varIndex, coef]: objFunc.terms) objCoefs[varIndex] = coef;
+	}
+	
+	void appendRows(const vector<Constraint>& multiCon) { // [cutting plane] 在最後加入新的列 (cut), 重建 CSC
+		for (const Constraint& con: multiCon) {
+			vector<pair<uint32_t, double>> rowTerms(con.getTerms().begin(), con.getTerms().end());
+			sort(rowTerms.begin(), rowTerms.end());
+			for (auto& [varIndex, coef]: rowTerms) {
+				rowColIndexs.push_back(varIndex);
+				rowCoefs.push_back(coef);
 			}
+			rowStart.push_back(rowColIndexs.size());
+			relations.push_back(con.getRelation());
+			rightConsts.push_back(con.getRightConst());
+			rowCount++;
 		}
-	} tableau;
+		buildColumns();
+	}
 	
-	bool isMin; // min/max
-	Linearform& objFunc; // 目標函數
-	vector<Constraint>& multiCon; // 多個約束
+	void buildColumns() { // CSR 轉置成 CSC: 先數每一行的個數, 再依照列的順序填入
+		colStart.assign(colCount + 1, 0);
+		for (uint32_t varIndex: rowColIndexs) colStart[varIndex + 1]++;
+		for (uint32_t j = 0; j < colCount; j++) colStart[j + 1] += colStart[j];
+		colRowIndexs.resize(rowColIndexs.size());
+		colCoefs.resize(rowCoefs.size());
+		vector<uint32_t> colFill(colStart.begin(), colStart.end() - 1);
+		for (uint32_t i = 0; i < rowCount; i++) for (uint32_t p = rowStart[i]; p < rowStart[i + 1]; p++) {
+			const uint32_t q = colFill[rowColIndexs[p]]++;
+			colRowIndexs[q] = i;
+			colCoefs[q] = rowCoefs[p];
+		}
+	}
 	
-	uint32_t varCount; // 一般變數的個數, index 為 0 ~ varCount-1
-	vector<Constraint> varRangeMultiCon; // 將變數範圍轉為多個約束
+	bool haveSlackVar(uint32_t i) const { // 第 i 列是否需要添加 slack var
+		return relations[i] != Relation::EQ;
+	}
 	
-	int32_t findNewBaseVarIndex() { // 尋找一個新的基底變數, 若沒找到則回傳 -1
-		for (uint32_t j = 0; j <= tableau.cols - 2; j++) if (FOP::isPos(tableau(0, j))) return j; // 最後一列是基底常數, 不能進入
-		return -1;
+	double getSlackVarCoef(uint32_t i) const { // 第 i 列 slack var 的係數, 沒有 slack var 回傳 0
+		if (relations[i] == Relation::LEQ) return 1;
+		if (relations[i] == Relation::GEQ) return -1;
+		return 0;
 	}
 	
-	int32_t findMinPosRatioRowIndex(uint32_t baseVarIndex) { // 選定要進入的基底後, 尋找一個 Aij / r 最小的正比值, 回傳這個值在第幾列, 找不到回傳 -1
-		double minPosRatio = 1e300; // 最小正比值: 右側常數/係數
-		int32_t minPosRatioRowIndex = -1; // 要更換基底的 row index, 若為 -1 代表沒有找到
-		for (uint32_t i = 1; i < tableau.rows; i++) if (FOP::isPos(tableau(i, baseVarIndex))) { // 要正比值
-			double ratio = tableau(i, tableau.cols - 1) / tableau(i, baseVarIndex);
-			if (ratio < minPosRatio) {
-				minPosRatio = ratio;
-				minPosRatioRowIndex = i;
+	void print(VarBimap& bimap) const { // debug
+		for (uint32_t j = 0, c = 0; j < colCount; j++) if (objCoefs[j] != 0) {
+			if (c++) printf(" + ");
+			printf("%.2f[%s]", objCoefs[j], bimap.getVarName(j).c_str());
+		}
+		printf("\n");
+		for (uint32_t i = 0; i < rowCount; i++) {
+			for (uint32_t p = rowStart[i]; p < rowStart[i + 1]; p++) {
+				if (p > rowStart[i]) printf(" + ");
+				printf("%.2f[%s]", rowCoefs[p], bimap.getVarName(rowColIndexs[p]).c_str());
 			}
+			if (relations[i] == Relation::LEQ) printf(" <= ");
+			else if (relations[i] == Relation::EQ) printf(" = ");
+			else if (relations[i] == Relation::GEQ) printf(" >= ");
+			printf("%.2f\n", rightConsts[i]);
 		}
-		return minPosRatioRowIndex;
 	}
+};
+
+class Presolver { // [presolve] 建立 SparseModel 之前化簡 min IP (純整數, 變數 >= 0): singleton 列轉為變數範圍, 用列的活動範圍收緊變數範圍並刪除多餘的列, 代換掉固定變數和隱含自由的變數. 解完之後 postsolve 回原本的變數編號
+private:
+	struct Row { // 化簡中的約束
+		unordered_map<uint32_t, double> terms;
+		Relation relation;
+		double rightConst;
+		bool isRemoved = false;
+	};
 	
-	bool isTableauHaveArtificialVar() { // tableau 的基底是否含有 artificial var
-		for (uint32_t i = 1; i < tableau.rows; i++) if (tableau.baseVarIndexs[i] == -1) return true;
-		return false;
+	struct Removal { // postsolve 紀錄, 倒序還原: 固定變數 x_j = value ; 代換 x_j = (value - sum a_q x_q) / coef
+		uint32_t varIndex;
+		double value;
+		vector<pair<uint32_t, double>> terms; // 固定變數為空
+		double coef = 1;
+	};
+	
+	static constexpr uint32_t SUBSTITUTION_MAX_ROW_SIZE = 16; // 代換用的等式列最多幾項, 避免 fill-in 太多
+	
+	uint32_t originalVarCount = 0;
+	vector<Row> rows;
+	vector<double> objCoefs; // 原本編號的目標函數係數
+	vector<pair<double, double>> bounds; // 原本編號的變數範圍
+	vector<bool> isActive; // 變數是否還在化簡後的模型裡
+	vector<Removal> removals;
+	vector<uint32_t> originalIndexs; // 化簡後的編號 -> 原本的編號
+	
+	void tightenBound(uint32_t j, double lower, double upper, bool& isChanged) { // 整數變數的範圍取整後收緊
+		lower = ceil(lower - FOP::EPS);
+		upper = floor(upper + FOP::EPS);
+		if (lower > bounds[j].first) bounds[j].first = lower, isChanged = true;
+		if (upper < bounds[j].second) bounds[j].second = upper, isChanged = true;
+		if (bounds[j].first > bounds[j].second) isInfeasible = true;
 	}
 	
-	void handleUnbound(uint32_t newBaseVarIndex) { // 若無界, 輸出當前向量和一個無限增長的方向向量 (這個向量集合仍然符合所有約束)
-		solutionType = Type::UNBOUNDED; // 無界
+	void removeVar(Removal removal) { // 變數已經不在任何列裡, 留下 postsolve 紀錄
+		objCoefs[removal.varIndex] = 0;
+		isActive[removal.varIndex] = false;
+		removals.push_back(move(removal));
+		removedVarCount++;
+	}
+	
+	void fixVar(uint32_t j, double value) { // 固定變數的值移到右側常數和目標函數常數
+		for (Row& row: rows) if (!row.isRemoved) {
+			auto it = row.terms.find(j);
+			if (it == row.terms.end()) continue;
+			row.rightConst -= it->second * value;
+			row.terms.erase(it);
+		}
+		objOffset += objCoefs[j] * value;
+		removeVar({ j, value, {} });
+	}
+	
+	void removeRow(Row& row) {
+		row.isRemoved = true;
+		removedRowCount++;
+	}
+	
+	bool processRow(Row& row) { // 空列/singleton 列/多餘的列/活動範圍收緊, 回傳是否有改變
+		bool isChanged = false;
+		const double tolerance = FOP::EPS * max(1.0, abs(row.rightConst));
+		if (row.terms.empty()) { // 0 ~ r
+			if ((row.relation != Relation::GEQ && 0 > row.rightConst + tolerance) || (row.relation != Relation::LEQ && 0 < row.rightConst - tolerance)) isInfeasible = true;
+			removeRow(row);
+			return true;
+		}
+		if (row.terms.size() == 1) { // a x_j ~ r 直接轉成 x_j 的範圍
+			auto [j, coef] = *row.terms.begin();
+			const double value = row.rightConst / coef;
+			const bool isUpper = (row.relation == Relation::LEQ) == (coef > 0); // 除以負數會轉向
+			if (row.relation == Relation::EQ) tightenBound(j, value, value, isChanged);
+			else if (isUpper) tightenBound(j, 0, value, isChanged);
+			else tightenBound(j, value, FP64_INF, isChanged);
+			removeRow(row);
+			return true;
+		}
 		
-		solution = vector<double>(varCount, 0); // 空的解向量, 長度為一般變數的數目
-		unboundedDirection = vector<double>(varCount, 0); // 方向向量
-		for (uint32_t i = 1; i < tableau.rows; i++) {
-			uint32_t baseVarIndex = tableau.baseVarIndexs[i];
-			if (baseVarIndex <= varCount - 1) { // 如果基底變數編號為 0 ~ varCount-1 代表為一般變數
-				solution[baseVarIndex] = tableau(i, tableau.cols - 1);
-				unboundedDirection[baseVarIndex] = tableau(i, newBaseVarIndex) * (isMin ? 1 : -1);
-			}
-		} // slack var 編號 >= varCount, 所以不會出現在解向量裡
+		double minActivity = 0, maxActivity = 0; // 有限的部分, 無限的項另外計數
+		uint32_t minInfCount = 0, maxInfCount = 0;
+		for (auto& [j, coef]: row.terms) {
+			const double low = coef > 0 ? bounds[j].first : bounds[j].second, high = coef > 0 ? bounds[j].second : bounds[j].first; // a x_j 的最小/最大值由哪個界決定
+			if (isinf(low)) minInfCount++; else minActivity += coef * low;
+			if (isinf(high)) maxInfCount++; else maxActivity += coef * high;
+		}
+		if ((row.relation == Relation::LEQ && maxInfCount == 0 && maxActivity <= row.rightConst + tolerance)
+			|| (row.relation == Relation::GEQ && minInfCount == 0 && minActivity >= row.rightConst - tolerance)) { // 在變數範圍內一定滿足
+			removeRow(row);
+			return true;
+		}
 		
-		extremum = isMin ? -FP64_INF : FP64_INF; // min -> -inf ; max -> inf
+		for (auto& [j, coef]: row.terms) { // sum a_q x_q <= r 時 a_j x_j <= r - (其他項的最小值), >= 同理
+			const double low = coef > 0 ? bounds[j].first : bounds[j].second, high = coef > 0 ? bounds[j].second : bounds[j].first;
+			if (row.relation != Relation::GEQ && (minInfCount == 0 || (minInfCount == 1 && isinf(low)))) {
+				const double value = (row.rightConst - (minActivity - (isinf(low) ? 0 : coef * low))) / coef;
+				if (coef > 0) tightenBound(j, 0, value, isChanged);
+				else tightenBound(j, value, FP64_INF, isChanged);
+			}
+			if (row.relation != Relation::LEQ && (maxInfCount == 0 || (maxInfCount == 1 && isinf(high)))) {
+				const double value = (row.rightConst - (maxActivity - (isinf(high) ? 0 : coef * high))) / coef;
+				if (coef > 0) tightenBound(j, value, FP64_INF, isChanged);
+				else tightenBound(j, 0, value, isChanged);
+			}
+		}
+		return isChanged;
 	}
 	
-	bool runMinSimplexMethod() { // 對 tableau 執行 min simplex method, 若有界回傳 true, 無解或無界回傳 false
-		while (true) {
-			const int32_t newBaseVarIndex = findNewBaseVarIndex(); // 嘗試尋找新基底 [複雜度: n]
-			if (newBaseVarIndex == -1) break; // 若沒有找到可進入的基底, 跳出迴圈
+	bool substituteFreeVar(Row& row) { // 等式列 a_p x_p + sum a_q x_q = r, a_p = +-1 且其他係數和 r 都是整數: x_p 一定是整數, 若由這一列推得的範圍在 x_p 的範圍內 (隱含自由), 就代換到其他列和目標函數
+		if (row.relation != Relation::EQ || row.terms.size() < 2 || row.terms.size() > SUBSTITUTION_MAX_ROW_SIZE || !FOP::isInt(row.rightConst)) return false;
+		for (auto& [j, coef]: row.terms) if (!FOP::isInt(coef)) return false;
+		
+		for (auto& [p, coefP]: row.terms) {
+			if (abs(coefP) != 1) continue;
+			double restMin = 0, restMax = 0; // sum a_q x_q (q != p) 的範圍
+			for (auto& [q, coefQ]: row.terms) if (q != p) {
+				restMin += coefQ * (coefQ > 0 ? bounds[q].first : bounds[q].second);
+				restMax += coefQ * (coefQ > 0 ? bounds[q].second : bounds[q].first);
+			}
+			const double impliedMin = coefP > 0 ? row.rightConst - restMax : restMin - row.rightConst; // x_p = (r - rest) / a_p
+			const double impliedMax = coefP > 0 ? row.rightConst - restMin : restMax - row.rightConst;
+			if (isnan(impliedMin) || isnan(impliedMax) || impliedMin < bounds[p].first - FOP::EPS || impliedMax > bounds[p].second + FOP::EPS) continue;
 			
-			const int32_t rowIndex = findMinPosRatioRowIndex(newBaseVarIndex); // 嘗試尋找最小正數比值的列編號 [複雜度: m]
-			if (rowIndex == -1) { // 若新基底存在, 但最小正數比值不存在, 則 LP 問題無界
-				handleUnbound(newBaseVarIndex);
-				return false; // 提前結束迴圈
+			const uint32_t varIndex = p;
+			Removal removal{ varIndex, row.rightConst, {}, coefP };
+			for (auto& [q, coefQ]: row.terms) if (q != varIndex) removal.terms.push_back({ q, coefQ });
+			for (Row& other: rows) if (!other.isRemoved && &other != &row) { // 其他列加上 -(a_ip / a_p) * 這一列
+				auto it = other.terms.find(varIndex);
+				if (it == other.terms.end()) continue;
+				const double ratio = it->second / coefP;
+				other.terms.erase(it);
+				for (auto& [q, coefQ]: removal.terms) {
+					double& newCoef = other.terms[q];
+					newCoef -= ratio * coefQ;
+					if (abs(newCoef) < 1e-12) other.terms.erase(q);
+				}
+				other.rightConst -= ratio * row.rightConst;
 			}
+			const double objRatio = objCoefs[varIndex] / coefP; // 目標函數同理, 常數部分移到 objOffset
+			for (auto& [q, coefQ]: removal.terms) objCoefs[q] -= objRatio * coefQ;
+			objOffset += objRatio * row.rightConst;
 			
-			tableau.elimination(rowIndex, newBaseVarIndex); // 對新基底的行做消元, 只留下最小正數比值的列 [複雜度: m*n]
-			tableau.baseVarIndexs[rowIndex] = newBaseVarIndex; // 更改新基底編號
+			removeRow(row);
+			removeVar(move(removal));
+			return true;
+		}
+		return false;
+	}
+	
+	void fixEmptyAndFixedVars(bool& isChanged) { // 範圍只剩一個值的變數, 以及不在任何列裡的變數 (依照目標係數取最好的界)
+		vector<bool> isInRow(originalVarCount, false);
+		for (Row& row: rows) if (!row.isRemoved) for (auto& [j, coef]: row.terms) isInRow[j] = true;
+		for (uint32_t j = 0; j < originalVarCount; j++) if (isActive[j]) {
+			double value;
+			if (bounds[j].first == bounds[j].second) value = bounds[j].first;
+			else if (!isInRow[j] && objCoefs[j] >= 0) value = bounds[j].first;
+			else if (!isInRow[j] && !isinf(bounds[j].second)) value = bounds[j].second;
+			else continue; // 不在任何列且目標係數 < 0 的無上界變數: 留給 LP 判斷無界
+			fixVar(j, value);
+			isChanged = true;
+		}
+	}
+
+public:
+	bool isInfeasible = false; // 化簡時就發現無解
+	double objOffset = 0; // 刪除的變數對目標函數的貢獻 (化簡後的目標值 + objOffset = 原本的目標值)
+	vector<pair<double, double>> varRange; // 化簡後變數的範圍 (root node 的變數範圍)
+	uint32_t removedRowCount = 0, removedVarCount = 0;
+	
+	SparseModel run(const Linearform& objFunc, const vector<Constraint>& multiCon, uint32_t varCount, bool isEnabled) { // 回傳化簡後的模型, isEnabled = false 時只做編號對應 (不化簡)
+		originalVarCount = varCount;
+		rows.clear();
+		for (const Constraint& con: multiCon) rows.push_back({ con.getTerms(), con.getRelation(), con.getRightConst() });
+		objCoefs.assign(varCount, 0);
+		for (auto& [j, coef]: objFunc.terms) objCoefs[j] = coef;
+		bounds.assign(varCount, { 0, FP64_INF });
+		isActive.assign(varCount, true);
+		removals.clear();
+		isInfeasible = false;
+		objOffset = 0;
+		removedRowCount = removedVarCount = 0;
+		
+		for (bool isChanged = isEnabled; isChanged && !isInfeasible;) { // 重複到沒有改變為止
+			isChanged = false;
+			for (Row& row: rows) if (!row.isRemoved && !isInfeasible && processRow(row)) isChanged = true;
+			if (isInfeasible) break;
+			fixEmptyAndFixedVars(isChanged);
+			for (Row& row: rows) if (!row.isRemoved && substituteFreeVar(row)) isChanged = true;
 		}
 		
-		if (isTableauHaveArtificialVar()) return false; // 執行完 simplex method, 若最小的 L1-norm 起始向量包含 artificial var, 則 LP 問題無解
-		return true;
+		originalIndexs.clear();
+		vector<int32_t> reducedIndexs(varCount, -1);
+		for (uint32_t j = 0; j < varCount; j++) if (isActive[j]) {
+			reducedIndexs[j] = originalIndexs.size();
+			originalIndexs.push_back(j);
+		}
+		Linearform reducedObjFunc;
+		for (uint32_t j: originalIndexs) if (objCoefs[j] != 0) reducedObjFunc.add(objCoefs[j], reducedIndexs[j]);
+		vector<Constraint> reducedMultiCon;
+		for (Row& row: rows) if (!row.isRemoved) {
+			Constraint con;
+			for (auto& [j, coef]: row.terms) con.add(coef, reducedIndexs[j]);
+			if (row.relation == Relation::LEQ) con.leq(row.rightConst);
+			else if (row.relation == Relation::EQ) con.eq(row.rightConst);
+			else con.geq(row.rightConst);
+			con.stdOfNegativeRightConst(); // 代換之後右側常數可能變成負的
+			reducedMultiCon.push_back(con);
+		}
+		varRange.clear();
+		for (uint32_t j: originalIndexs) varRange.push_back(bounds[j]);
+		return SparseModel(reducedObjFunc, reducedMultiCon, originalIndexs.size());
 	}
 	
-	void initTableau() { // init tableau
-		uint32_t slackVarCount = 0; // 計算 slack var 個數, 決定 tableau 的 col 數 (因為要分配連續記憶體)
-		for (Constraint& con: multiCon) if (con.haveSlackVar()) slackVarCount++;
-		for (Constraint& con: varRangeMultiCon) if (con.haveSlackVar()) slackVarCount++;
-		tableau.init(1 + multiCon.size() + varRangeMultiCon.size(), varCount + slackVarCount + 1); // init tableau
+	uint32_t getOriginalIndex(uint32_t reducedIndex) const {
+		return originalIndexs[reducedIndex];
 	}
 	
-	void insertConToTableau() { // 將約束插入 tableau
-		uint32_t rowIndex = 1;
-		uint32_t slackVarColIndex = varCount - 1; // 因為一般變數的 col index 為 0 ~ varCount-1, 所以 slack var 插入的 col index 從這裡開始數
-		auto setTableauRow = [&](Constraint& con) { // 將一個約束加入到 tableau
-			for (auto& [varIndex, coef]: con.getTerms()) tableau(rowIndex, varIndex) = coef; // 填入一般變數
-			
-			if (con.haveSlackVar()) tableau(rowIndex, ++slackVarColIndex) = con.getSlackVarCoef(); // 如果有 slack var, 需要添加係數 1 或 -1 到 tableau 內
+	vector<double> postsolve(const vector<double>& reducedSolution) const { // 化簡後的解 -> 原本變數編號的解
+		vector<double> solution(originalVarCount, 0);
+		for (uint32_t k = 0; k < originalIndexs.size(); k++) solution[originalIndexs[k]] = reducedSolution[k];
+		for (auto it = removals.rbegin(); it != removals.rend(); it++) { // 代換列裡的變數比它晚刪除, 倒序還原時一定已經有值
+			double value = it->value;
+			for (auto& [q, coefQ]: it->terms) value -= coefQ * solution[q];
+			solution[it->varIndex] = value / it->coef;
+		}
+		return solution;
+	}
+	
+	void print() const { // debug
+		printf("Presolve: removed %u rows, %u vars, %u vars remain, objective offset = %.2f%s\n",
+			removedRowCount, removedVarCount, (uint32_t)originalIndexs.size(), objOffset, isInfeasible ? " (infeasible)" : "");
+	}
+};
+
+class LUFactor { // [revised simplex] 基底矩陣 B 的稀疏 LU 分解 (left-looking, 部分 pivot), 換基底時以 eta 矩陣 (乘積形式) 更新
+private:
+	struct Eta { // B_new^-1 = E * B_old^-1, E 只有第 pos 行不是單位向量
+		uint32_t pos; // 被換掉的基底位置
+		double pivot; // eta 在 pos 的值 (1 / alpha_pos)
+		vector<pair<uint32_t, double>> entries; // eta 在其他位置的值 (-alpha_i / alpha_pos)
+	};
+	
+	uint32_t m = 0; // 基底大小 (約束數)
+	vector<uint32_t> pivotRows; // 第 k 步選到的 pivot 列
+	vector<uint32_t> colOrder; // 第 k 步處理的基底位置
+	vector<vector<pair<uint32_t, double>>> lCols; // L 的第 k 行 (不含對角線 1): (列, 值)
+	vector<vector<pair<uint32_t, double>>> uCols; // U 的第 k 行 (不含對角線): (步驟 j < k, U(j,k))
+	vector<double> uDiag; // U 的對角線
+	vector<Eta> etas; // 上次分解之後的 eta 更新
+	vector<double> work; // 暫存用的稠密向量
+
+public:
+	static constexpr uint32_t REFACTOR_INTERVAL = 64; // 每 64 次 eta 更新就重新分解
+	static constexpr double SINGULAR_TOL = 1e-11; // pivot 小於這個值視為奇異
+	
+	uint32_t getEtaCount() const {
+		return etas.size();
+	}
+	
+	// 分解 B = [cols[0] cols[1] ... cols[m-1]], 每行為稀疏向量 (列, 值)
+	// 若 B 奇異, 會把奇異的基底位置換成某個未被 pivot 的列的 logical var 單位向量, 回傳 (基底位置, 列) 讓呼叫端更新基底
+	vector<pair<uint32_t, uint32_t>> factor(const vector<vector<pair<uint32_t, double>>>& cols) {
+		m = cols.size();
+		pivotRows.assign(m, 0);
+		colOrder.resize(m);
+		lCols.assign(m, {});
+		uCols.assign(m, {});
+		uDiag.assign(m, 0);
+		etas.clear();
+		work.assign(m, 0);
+		
+		for (uint32_t k = 0; k < m; k++) colOrder[k] = k; // 非零元素少的行先處理 (slack 的單位向量不會產生 fill-in)
+		stable_sort(colOrder.begin(), colOrder.end(), [&](uint32_t a, uint32_t b) { return cols[a].size() < cols[b].size(); });
+		
+		vector<int32_t> rowStep(m, -1); // 列在第幾步被選為 pivot, -1 代表還沒有
+		vector<pair<uint32_t, uint32_t>> replaced;
+		for (uint32_t k = 0; k < m; k++) {
+			for (auto& [row, value]: cols[colOrder[k]]) work[row] = value; // scatter
+			for (uint32_t j = 0; j < k; j++) { // 用前面的 L 行消去, 得到 U 的第 k 行
+				const double v = work[pivotRows[j]];
+				if (v == 0) continue;
+				uCols[k].push_back({ j, v });
+				work[pivotRows[j]] = 0;
+				for (auto& [row, l]: lCols[j]) work[row] -= l * v;
+			}
 			
-			tableau(rowIndex, tableau.cols - 1) = con.getRightConst(); // 在列的最右元素, 設定右側常數 (基底的值)
-			tableau.baseVarIndexs[rowIndex] = con.haveArtificialVar() ? -1 : slackVarColIndex; // -1 代表 artifical var
+			int32_t pivotRow = -1; // 部分 pivot: 在未選過的列中挑絕對值最大的
+			for (uint32_t row = 0; row < m; row++) if (rowStep[row] == -1 && (pivotRow == -1 || abs(work[row]) > abs(work[pivotRow]))) pivotRow = row;
+			if (abs(work[pivotRow]) < SINGULAR_TOL) { // 奇異: 換成這一列的 logical var, 單位向量不受前面的 L 影響
+				for (uint32_t row = 0; row < m; row++) work[row] = 0;
+				uCols[k].clear();
+				work[pivotRow] = 1;
+				replaced.push_back({ colOrder[k], (uint32_t)pivotRow });
+			}
 			
-			rowIndex++;
-		};
-		for (Constraint& con: multiCon) setTableauRow(con);
-		for (Constraint& con: varRangeMultiCon) setTableauRow(con);
+			pivotRows[k] = pivotRow;
+			rowStep[pivotRow] = k;
+			uDiag[k] = work[pivotRow];
+			work[pivotRow] = 0;
+			for (uint32_t row = 0; row < m; row++) if (work[row] != 0) { // gather, 剩下的都是未選過的列
+				lCols[k].push_back({ row, work[row] / uDiag[k] });
+				work[row] = 0;
+			}
+		}
+		return replaced;
 	}
 	
-	bool checkInfeasible() { // 檢查是否無解, 並做處理, 若無解則回傳 false, 非無解則回傳 true
-		if (!isTableauHaveArtificialVar()) return true; // 如果不存在 artificial var, 跳過這一步
-		
-		for (uint32_t i = 1; i < tableau.rows; i++) if (tableau.baseVarIndexs[i] == -1) {
-			tableau.addRowToRow(i, 0, 1); // 將 artificial var 的列加到第零列, 消去第零列的 art-var 係數 -1 (但我們的演算法不會儲存 art-var 的行係數)
+	void ftran(vector<double>& x) { // 解 B x = a, 輸入為以列編號的 a, 輸出為以基底位置編號的 x
+		for (uint32_t j = 0; j < m; j++) { // L y = a
+			const double v = x[pivotRows[j]];
+			if (v == 0) continue;
+			for (auto& [row, l]: lCols[j]) x[row] -= l * v;
+		}
+		for (uint32_t k = 0; k < m; k++) work[k] = x[pivotRows[k]]; // 改成以步驟編號
+		for (int32_t k = m - 1; k >= 0; k--) { // U z = y
+			if (work[k] == 0) continue;
+			work[k] /= uDiag[k];
+			for (auto& [j, u]: uCols[k]) work[j] -= u * work[k];
+		}
+		for (uint32_t k = 0; k < m; k++) {
+			x[colOrder[k]] = work[k]; // 改成以基底位置編號
+			work[k] = 0;
+		}
+		for (Eta& eta: etas) { // 依序套用 eta 更新
+			const double v = x[eta.pos];
+			if (v == 0) continue;
+			x[eta.pos] = v * eta.pivot;
+			for (auto& [pos, e]: eta.entries) x[pos] += e * v;
 		}
-		
-		if (!runMinSimplexMethod()) return false; // 嘗試求出一個最小的 L1-norm 起始向量, 若無解則回傳 false
-		
-		for (uint32_t j = 0; j < tableau.cols; j++) tableau(0, j) = 0; // 雖然理論上第零列應該是全 0 的, 只是為了消除小誤差
-		return true; // 可能為有界或無界
 	}
 	
-	void insertObjFuncToTableau() { // 將目標函數插入到 tableau 的第零列
-		for (auto& [varIndex, coef]: objFunc.terms) tableau(0, varIndex) = coef * (isMin ? -1 : 1);
-	} // 此時 tableau 的第零列是空的, 填入目標函數. 注意: 因為將 max obj func 變號會轉為 min 問題, 所以 max 問題在這裡會填入 +coef 而不是 -coef
+	void btran(vector<double>& y) { // 解 B^T y = c, 輸入為以基底位置編號的 c, 輸出為以列編號的 y (dual 值)
+		for (int32_t t = (int32_t)etas.size() - 1; t >= 0; t--) { // 反序套用 eta 更新 (只會改到 pos)
+			Eta& eta = etas[t];
+			double v = y[eta.pos] * eta.pivot;
+			for (auto& [pos, e]: eta.entries) v += y[pos] * e;
+			y[eta.pos] = v;
+		}
+		for (uint32_t k = 0; k < m; k++) { // U^T w = Q^T c
+			double v = y[colOrder[k]];
+			for (auto& [j, u]: uCols[k]) v -= u * work[j];
+			work[k] = v / uDiag[k];
+		}
+		for (int32_t j = m - 1; j >= 0; j--) { // L^T y = w
+			double v = work[j];
+			for (auto& [row, l]: lCols[j]) v -= l * y[row];
+			y[pivotRows[j]] = v; // lCols[j] 的列都在第 j 步之後才被選為 pivot, 所以 y[row] 已經算好了
+			work[j] = 0;
+		}
+	}
 	
-	void handleNonZeroHead() { // 處理 row 0 的非零基底行元素 (phase-2). 若沒做 phase-1 則這一步不會有實際影響
-		for (uint32_t i = 1; i < tableau.rows; i++) {
-			uint32_t baseVarIndex = tableau.baseVarIndexs[i]; // 檢查每一列對應的基底變數所對應的行的 row 0 元素是不是 0
-			if (!FOP::isZero(tableau(0, baseVarIndex))) tableau.addRowToRow(i, 0, -tableau(0, baseVarIndex)); // 如果非 0, 需要執行列運算, 消去它
+	void update(const vector<double>& alpha, uint32_t pos) { // 基底位置 pos 換成新的行, alpha = B^-1 a_q (ftran 的結果)
+		Eta eta;
+		eta.pos = pos;
+		eta.pivot = 1 / alpha[pos];
+		for (uint32_t i = 0; i < m; i++) if (i != pos && alpha[i] != 0) eta.entries.push_back({ i, -alpha[i] * eta.pivot });
+		etas.push_back(move(eta));
+	}
+};
+
+class RevisedSimplex { // [revised simplex] 稀疏矩陣 + LU 分解基底的 simplex, 每個約束有一個 logical var: sum a_ij x_j + s_i = b_i
+public:
+	enum class Status { OPTIMAL, UNBOUNDED, INFEASIBLE, ITERATION_LIMIT, CUTOFF };
+	enum ColStatus : uint8_t { BASIC, AT_LOWER, AT_UPPER, FREE }; // 基底, 非基底在下界, 非基底在上界, 非基底自由變數 (值為 0)
+	
+	struct Basis { // 給子節點 warm start 的基底
+		vector<uint32_t> baseColIndexs; // 每個基底位置的行編號
+		vector<uint8_t> colStatus; // 每一行的狀態
+	};
+	
+	static constexpr double FEAS_TOL = 1e-7; // primal 可行誤差
+	static constexpr double OPT_TOL = 1e-7; // reduced cost 誤差
+	static constexpr double PIVOT_TOL = 1e-7; // pivot 元素的最小絕對值
+	
+	const SparseModel& model; // 係數矩陣 A 直接讀 model 的 CSC, 右側常數 b 讀 model.rightConsts
+	uint32_t m; // 約束數
+	uint32_t n; // 一般變數數, 行 n ~ n+m-1 為 logical var
+	vector<double> cost; // 目標函數 (min), 長度 n+m
+	vector<double> lower; // 每一行的下界, 長度 n+m
+	vector<double> upper; // 每一行的上界, 長度 n+m
+	
+	vector<double> x; // 每一行的值 (解)
+	vector<double> ray; // 若無界, 一個讓目標函數無限下降的方向
+	double objValue = 0;
+	double cutoff = FP64_INF; // [cutoff] dual simplex 的目標值 (min) 達到這個值就提早結束
+	
+	RevisedSimplex(const SparseModel& model, bool isMin, const vector<pair<double, double>>& varRange)
+	: model(model), m(model.rowCount), n(model.colCount) {
+		lower.resize(n + m);
+		upper.resize(n + m);
+		for (uint32_t i = 0; i < m; i++) { // <=: s >= 0 ; >=: s <= 0 ; =: s = 0
+			lower[n + i] = model.relations[i] == Relation::GEQ ? -FP64_INF : 0;
+			upper[n + i] = model.relations[i] == Relation::LEQ ? FP64_INF : 0;
+		}
+		
+		cost.assign(n + m, 0);
+		for (uint32_t j = 0; j < n; j++) {
+			cost[j] = model.objCoefs[j] * (isMin ? 1 : -1); // 轉為 min 問題
+			lower[j] = varRange[j].first;
+			upper[j] = varRange[j].second;
 		}
 	}
 	
-	void handleBound() { // 處理有界的情況
-		solutionType = Type::BOUNDED;
+	Status solve(const Basis* warmBasis = nullptr) { // 有基底就從基底出發 (dual simplex), 否則從 slack 基底出發 (phase-1 + phase-2)
+		for (uint32_t j = 0; j < n; j++) if (lower[j] > upper[j]) return Status::INFEASIBLE;
 		
-		solution = vector<double>(varCount, 0); // 空的解向量, 長度為一般變數的數目
-		for (uint32_t i = 1; i < tableau.rows; i++) {
-			uint32_t baseVarIndex = tableau.baseVarIndexs[i];
-			if (baseVarIndex <= varCount - 1) solution[baseVarIndex] = tableau(i, tableau.cols - 1); // 如果基底變數編號為 0 ~ varCount-1 代表為一般變數
-		} // slack var 編號 >= varCount, 所以不會出現在解向量裡
+		if (warmBasis != nullptr) {
+			baseColIndexs = warmBasis->baseColIndexs;
+			colStatus = warmBasis->colStatus;
+		} else {
+			baseColIndexs.resize(m);
+			colStatus.assign(n + m, AT_LOWER);
+			for (uint32_t i = 0; i < m; i++) {
+				baseColIndexs[i] = n + i;
+				colStatus[n + i] = BASIC;
+			}
+		}
+		for (uint32_t j = 0; j < n + m; j++) if (colStatus[j] != BASIC) colStatus[j] = fitStatus(j, colStatus[j]);
+		refactor();
 		
-		extremum = tableau(0, tableau.cols - 1) * (isMin ? 1 : -1); // 極值
+		if (warmBasis != nullptr && !isPrimalFeasible() && makeDualFeasible()) { // 基底仍然 primal 可行 (例如 [what-if] 只改目標函數) 就直接 primal simplex, 否則 (改範圍或右側常數) 先 dual simplex
+			Status status = runDualSimplex();
+			if (status != Status::OPTIMAL) return status;
+		}
+		Status status = runPrimalSimplex(true); // phase-1: 最小化不可行量
+		if (status != Status::OPTIMAL) return status;
+		status = runPrimalSimplex(false); // phase-2
+		if (status == Status::OPTIMAL) computeObjValue();
+		return status;
+	}
+	
+	Basis getBasis() const {
+		return { baseColIndexs, colStatus };
+	}
+	
+	vector<double> getReducedCosts() { // [reduced cost fixing] 一般變數的 reduced cost (min), 基底變數為 0
+		computeDual(false);
+		vector<double> reducedCosts(n, 0);
+		for (uint32_t j = 0; j < n; j++) if (colStatus[j] != BASIC) reducedCosts[j] = reducedCost(j, false);
+		return reducedCosts;
 	}
 
-public:
-	enum class Type { BOUNDED, UNBOUNDED, INFEASIBLE }; // 有界, 無界, 無解
+private:
+	vector<uint32_t> baseColIndexs; // 每個基底位置的行編號
+	vector<uint8_t> colStatus; // 每一行的狀態
+	LUFactor lu;
+	vector<double> dual; // y = B^-T c_B
+	vector<double> alpha; // ftran 的結果
 	
-	Type solutionType; // 解的狀態
-	vector<double> solution; // 解向量, 若無解會是空的
-	vector<double> unboundedDirection; // 若無界, 此值會是一個方向向量, 即使往無窮遠移動仍然滿足目標函數
-	double extremum; // min/max 極值
+	uint8_t fitStatus(uint32_t j, uint8_t status) { // 依照變數範圍修正非基底狀態 (例如上界變成 inf 就只能停在下界)
+		const bool hasLower = !isinf(lower[j]), hasUpper = !isinf(upper[j]);
+		if (!hasLower && !hasUpper) return FREE;
+		if (status == AT_UPPER && hasUpper) return AT_UPPER;
+		if (status == AT_LOWER && hasLower) return AT_LOWER;
+		return hasLower ? AT_LOWER : AT_UPPER;
+	}
 	
-	LP(bool isMin, Linearform& objFunc, vector<Constraint>& multiCon, vector<pair<double, double>>& varRange)
-	: isMin(isMin), objFunc(objFunc), multiCon(multiCon) {
-		varCount = varRange.size();
-		uint32_t i = 0;
-		for (auto& [varMin, varMax]: varRange) { // min <= x_i <= max, 將變數範圍轉為約束
-			if (varMin > 0) varRangeMultiCon.push_back(Constraint().add(1, i).geq(varMin)); // x_i >= min
-			if (!isinf(varMax)) varRangeMultiCon.push_back(Constraint().add(1, i).leq(varMax)); // x_i <= max
-			i++;
+	double nonbasicValue(uint32_t j) { // 非基底變數的值
+		if (colStatus[j] == AT_LOWER) return lower[j];
+		if (colStatus[j] == AT_UPPER) return upper[j];
+		return 0;
+	}
+	
+	template <typename F>
+	void forEachInCol(uint32_t j, F f) { // 走訪第 j 行的非零元素 (列, 係數), logical var 的行為單位向量
+		if (j >= n) f(j - n, 1.0);
+		else for (uint32_t p = model.colStart[j]; p < model.colStart[j + 1]; p++) f(model.colRowIndexs[p], model.colCoefs[p]);
+	}
+	
+	double dotCol(const vector<double>& y, uint32_t j) { // y^T a_j
+		if (j >= n) return y[j - n];
+		double s = 0;
+		for (uint32_t p = model.colStart[j]; p < model.colStart[j + 1]; p++) s += y[model.colRowIndexs[p]] * model.colCoefs[p];
+		return s;
+	}
+	
+	void refactor() { // 重新分解基底, 並重新計算基底變數的值以消除累積誤差
+		vector<vector<pair<uint32_t, double>>> cols(m);
+		for (uint32_t pos = 0; pos < m; pos++) forEachInCol(baseColIndexs[pos], [&](uint32_t row, double coef) { cols[pos].push_back({ row, coef }); });
+		for (auto& [pos, row]: lu.factor(cols)) { // 奇異的基底位置換成 logical var
+			const uint32_t oldCol = baseColIndexs[pos];
+			colStatus[oldCol] = fitStatus(oldCol, AT_LOWER);
+			baseColIndexs[pos] = n + row;
+			colStatus[n + row] = BASIC;
 		}
 		
-		initTableau(); // init tableau
-		insertConToTableau(); // 將約束插入 tableau
+		x.assign(n + m, 0);
+		vector<double> r = model.rightConsts; // x_B = B^-1 (b - N x_N)
+		for (uint32_t j = 0; j < n + m; j++) if (colStatus[j] != BASIC) {
+			x[j] = nonbasicValue(j);
+			if (x[j] != 0) forEachInCol(j, [&](uint32_t row, double coef) { r[row] -= coef * x[j]; });
+		}
+		lu.ftran(r);
+		for (uint32_t pos = 0; pos < m; pos++) x[baseColIndexs[pos]] = r[pos];
+	}
+	
+	void computeDual(bool isPhase1) { // y = B^-T c_B, phase-1 的 c_B 為不可行量的梯度
+		dual.assign(m, 0);
+		for (uint32_t pos = 0; pos < m; pos++) {
+			const uint32_t j = baseColIndexs[pos];
+			if (!isPhase1) dual[pos] = cost[j];
+			else if (x[j] < lower[j] - FEAS_TOL) dual[pos] = -1;
+			else if (x[j] > upper[j] + FEAS_TOL) dual[pos] = 1;
+		}
+		lu.btran(dual);
+	}
+	
+	double reducedCost(uint32_t j, bool isPhase1) {
+		return (isPhase1 ? 0 : cost[j]) - dotCol(dual, j);
+	}
+	
+	void ftranCol(uint32_t j) { // alpha = B^-1 a_j
+		alpha.assign(m, 0);
+		forEachInCol(j, [&](uint32_t row, double coef) { alpha[row] = coef; });
+		lu.ftran(alpha);
+	}
+	
+	void pivot(uint32_t pos, uint32_t enterCol, uint8_t leaveStatus) { // 基底位置 pos 換成 enterCol, 離開的變數停在 leaveStatus
+		const uint32_t leaveCol = baseColIndexs[pos];
+		colStatus[leaveCol] = leaveStatus;
+		x[leaveCol] = nonbasicValue(leaveCol); // 去掉誤差, 剛好停在界上
+		baseColIndexs[pos] = enterCol;
+		colStatus[enterCol] = BASIC;
 		
-		if (!checkInfeasible()) { // 檢查是否無解, 並做處理 (phase-1)
-			solutionType = Type::INFEASIBLE; // checkInfeasible 輸出 false, 無解
-			extremum = FP64_NAN;
-		} else { // checkInfeasible 輸出 true, 可能為有界或無界. checkInfeasible 已處理基底不足的問題
-			insertObjFuncToTableau(); // 將目標函數插入到 tableau 的第零列
-			handleNonZeroHead(); // 處理 row 0 的非零基底行元素 (phase-2)
-			if (runMinSimplexMethod()) handleBound(); // 處理有界情況, 如果無界會提前終止並處理
+		if (lu.getEtaCount() >= LUFactor::REFACTOR_INTERVAL) refactor();
+		else lu.update(alpha, pos);
+	}
+	
+	void computeObjValue() {
+		objValue = 0;
+		for (uint32_t j = 0; j < n; j++) objValue += cost[j] * x[j];
+	}
+	
+	bool isPrimalFeasible() {
+		for (uint32_t pos = 0; pos < m; pos++) {
+			const uint32_t j = baseColIndexs[pos];
+			if (x[j] < lower[j] - FEAS_TOL || x[j] > upper[j] + FEAS_TOL) return false;
 		}
+		return true;
 	}
 	
-	void print(bool showCon = false) { // debug
-		if (showCon) {
-			VarBimap bimap; // 因為 IP 已經將字串變數轉為 index 跟 LP 溝通, 所以 LP 抽象層並不知道 varName, 所以這邊註冊一個 x0, x1, x2 (抽象 index)
-			for (uint32_t i = 0; i < varCount; i++) bimap.getVarIndex("x" + to_string(i)); // 註冊 x0, x1, x2, ...
+	Status runPrimalSimplex(bool isPhase1) { // bounded primal simplex, phase-1 以 "不可行量總和" 為目標
+		const uint32_t iterLimit = 50 * (n + m);
+		const uint32_t stallPivotCount = max<uint32_t>(50, m); // [anti-stalling] 連續這麼多次退化 pivot 就改用 Bland's rule
+		uint32_t degeneratePivotCount = 0;
+		const SolverCounters::Counter pivotCounter = isPhase1 ? SolverCounters::PHASE1_PIVOT : SolverCounters::PHASE2_PIVOT; // [stats]
+		for (uint32_t iter = 0; iter < iterLimit; iter++, lpPivotCount++, solverCounters->add(pivotCounter)) {
+			if (isPhase1 && isPrimalFeasible()) return Status::OPTIMAL;
+			const bool isBlandMode = enableAntiStalling && degeneratePivotCount >= stallPivotCount;
 			
-			printf(isMin ? "min " : "max "); // 印出目標函數
-			objFunc.print(bimap);
-			for (Constraint& con: multiCon) con.print(bimap); // 印出約束
+			computeDual(isPhase1);
+			int32_t enterCol = -1; // Dantzig: 選 |reduced cost| 最大且方向可行的非基底變數 (Bland: 編號最小的)
+			double maxImprove = OPT_TOL, enterDir = 0;
+			const uint32_t startCol = isBlandMode ? 0 : lpTieBreakSeed % (n + m); // [portfolio] 同分時選掃描順序中第一個
+			for (uint32_t k = 0, j = startCol; k < n + m; k++, j = j + 1 == n + m ? 0 : j + 1) {
+				if (colStatus[j] == BASIC || lower[j] == upper[j]) continue;
+				const double d = reducedCost(j, isPhase1);
+				if (colStatus[j] != AT_UPPER && -d > maxImprove) { maxImprove = -d; enterCol = j; enterDir = 1; } // 增加 x_j
+				if (colStatus[j] != AT_LOWER && d > maxImprove) { maxImprove = d; enterCol = j; enterDir = -1; } // 減少 x_j
+				if (isBlandMode && enterCol != -1) break;
+			}
+			if (enterCol == -1) return isPhase1 ? Status::INFEASIBLE : Status::OPTIMAL; // phase-1 沒有改善方向但仍不可行, 代表無解
 			
-			if (varRangeMultiCon.size() == 0) printf("Var range is empty.");
-			for (Constraint& con: varRangeMultiCon) { // 印出變數範圍
-				con.print(bimap, false);
-				printf("; ");
+			ftranCol(enterCol);
+			
+			// Harris two-pass ratio test: 第一次用放寬的界找最大步長, 第二次在步長內挑 |alpha| 最大的, 數值比較穩定
+			// [anti-stalling] Bland's rule 不放寬, 第二次挑精確最小比值中基底變數編號最小的
+			const double flipStep = upper[enterCol] - lower[enterCol]; // 進入的變數直接翻到另一個界
+			double maxStep = flipStep;
+			for (uint32_t pos = 0; pos < m; pos++) {
+				const double a = alpha[pos] * enterDir; // x_B[pos] 的變化率為 -a
+				if (abs(a) < PIVOT_TOL) continue;
+				bool isToLower = false; // ratioStep 回傳 inf 時不會設定
+				const double step = ratioStep(pos, a, isBlandMode ? 0 : FEAS_TOL, isToLower);
+				if (step < maxStep) maxStep = step;
 			}
-			printf("\n");
+			if (isinf(maxStep)) { // 沒有任何界限制步長
+				if (isPhase1) return Status::INFEASIBLE; // 理論上不會發生, 數值問題
+				handleUnbounded(enterCol, enterDir);
+				return Status::UNBOUNDED;
+			}
+			
+			int32_t leavePos = -1;
+			uint8_t leaveStatus = AT_LOWER;
+			double step = flipStep, maxAbsAlpha = 0;
+			for (uint32_t pos = 0; pos < m; pos++) {
+				const double a = alpha[pos] * enterDir;
+				if (abs(a) < PIVOT_TOL) continue;
+				bool isToLower = false; // ratioStep 回傳 inf 時不會設定
+				const double exactStep = ratioStep(pos, a, 0, isToLower);
+				if (exactStep > maxStep) continue;
+				if (isBlandMode ? leavePos == -1 || baseColIndexs[pos] < baseColIndexs[leavePos] : abs(a) > maxAbsAlpha) {
+					maxAbsAlpha = abs(a);
+					leavePos = pos;
+					leaveStatus = isToLower ? AT_LOWER : AT_UPPER;
+					step = max(0.0, exactStep);
+				}
+			}
+			if (leavePos != -1 && flipStep <= step) leavePos = -1; // 翻界比換基底先發生
+			degeneratePivotCount = leavePos != -1 && step <= FEAS_TOL ? degeneratePivotCount + 1 : 0; // 步長為 0 的 pivot 不會改變目標值
+			
+			x[enterCol] += enterDir * step; // 更新所有基底變數的值
+			for (uint32_t pos = 0; pos < m; pos++) x[baseColIndexs[pos]] -= enterDir * step * alpha[pos];
+			
+			if (leavePos == -1) { // 翻界, 不用換基底
+				colStatus[enterCol] = colStatus[enterCol] == AT_LOWER ? AT_UPPER : AT_LOWER;
+				x[enterCol] = nonbasicValue(enterCol);
+				continue;
+			}
+			pivot(leavePos, enterCol, leaveStatus);
 		}
-		
-		printf("Type: "); // 印出 LP 的解的類型
-		if (solutionType == Type::BOUNDED) printf("Bounded\n");
-		else if (solutionType == Type::UNBOUNDED) printf("Unbounded\n");
-		else if (solutionType == Type::INFEASIBLE) printf("Infeasible\n");
-		
-		printf(isMin ? "LP Minimum = " : "LP Maximum = "); // 印出極值
-		printf("%.2f\n", extremum);
-		
-		printf("LP Solution: "); // 印出解向量
-		for (size_t i = 0; i < solution.size(); i++) printf("x%d = %.2f; ", (int)i, solution[i]);
-		printf("\n");
-		
-		if (unboundedDirection.size() > 0) { // 如果無界, 印出方向向量
-			printf("Unbounded delta: ");
-			for (size_t i = 0; i < unboundedDirection.size(); i++) printf("x%d = %.2f; ", (int)i, unboundedDirection[i]);
-			printf("\n");
+		return Status::ITERATION_LIMIT;
+	}
+	
+	// ratio test: 基底位置 pos 的變數以速率 -a 改變, 回傳碰到界 (放寬 tol) 的步長, 沒有界回傳 inf
+	// phase-1 可能有不可行的基底變數, 往可行方向移動時, 第一個碰到的是它違反的那個界
+	double ratioStep(uint32_t pos, double a, double tol, bool& isToLower) {
+		const uint32_t j = baseColIndexs[pos];
+		const double v = x[j];
+		if (a > 0) { // 減少
+			if (v > upper[j] + FEAS_TOL) { isToLower = false; return (v - upper[j] + tol) / a; }
+			if (v >= lower[j] - FEAS_TOL && !isinf(lower[j])) { isToLower = true; return (v - lower[j] + tol) / a; }
+		} else { // 增加
+			if (v < lower[j] - FEAS_TOL) { isToLower = true; return (lower[j] + tol - v) / -a; }
+			if (v <= upper[j] + FEAS_TOL && !isinf(upper[j])) { isToLower = false; return (upper[j] + tol - v) / -a; }
+		}
+		return FP64_INF; // 往遠離可行的方向移動, 或沒有界
+	}
+	
+	void handleUnbounded(uint32_t enterCol, double enterDir) { // 無界方向: 進入的變數 +dir, 基底變數 -dir * alpha
+		ray.assign(n + m, 0);
+		ray[enterCol] = enterDir;
+		for (uint32_t pos = 0; pos < m; pos++) ray[baseColIndexs[pos]] = -enterDir * alpha[pos];
+	}
+	
+	bool makeDualFeasible() { // [warm start] 非基底變數的 reduced cost 要和它停的界一致, 有界的變數可以翻到另一個界, 否則回傳 false
+		computeDual(false);
+		bool isFlipped = false;
+		for (uint32_t j = 0; j < n + m; j++) {
+			if (colStatus[j] == BASIC || lower[j] == upper[j]) continue;
+			const double d = reducedCost(j, false);
+			if (colStatus[j] == FREE && abs(d) > OPT_TOL) return false;
+			if (colStatus[j] == AT_LOWER && d < -OPT_TOL) {
+				if (isinf(upper[j])) return false;
+				colStatus[j] = AT_UPPER;
+				isFlipped = true;
+			} else if (colStatus[j] == AT_UPPER && d > OPT_TOL) {
+				if (isinf(lower[j])) return false;
+				colStatus[j] = AT_LOWER;
+				isFlipped = true;
+			}
+		}
+		if (isFlipped) refactor(); // 重新計算基底變數的值
+		return true;
+	}
+	
+	Status runDualSimplex() { // [warm start] bounded dual simplex: 基底 dual 可行, 讓違反範圍的基底變數離開
+		const uint32_t iterLimit = 50 * (n + m);
+		vector<double> rho;
+		for (uint32_t iter = 0; iter < iterLimit; iter++, lpPivotCount++, solverCounters->add(SolverCounters::DUAL_PIVOT)) {
+			int32_t leavePos = -1; // 選違反範圍最多的基底變數離開
+			double maxViolation = FEAS_TOL;
+			for (uint32_t pos = 0; pos < m; pos++) {
+				const uint32_t j = baseColIndexs[pos];
+				const double violation = max(lower[j] - x[j], x[j] - upper[j]);
+				if (violation > maxViolation) {
+					maxViolation = violation;
+					leavePos = pos;
+				}
+			}
+			if (leavePos == -1) return Status::OPTIMAL;
+			if (!isinf(cutoff)) { // [cutoff] dual 可行基底的目標值是 LP 最佳值的下界, 而且只會增加
+				computeObjValue();
+				if (objValue >= cutoff) return Status::CUTOFF;
+			}
+			
+			const uint32_t leaveCol = baseColIndexs[leavePos];
+			const bool isToLower = x[leaveCol] < lower[leaveCol]; // 離開的變數停在下界 (要增加) 或上界 (要減少)
+			computeDual(false);
+			rho.assign(m, 0); // rho = e_pos^T B^-1, tableau 的第 pos 列為 rho^T A
+			rho[leavePos] = 1;
+			lu.btran(rho);
+			
+			// Harris two-pass dual ratio test: min |d_j| / |alpha_pj|, 在放寬的步長內挑 |alpha_pj| 最大的
+			vector<pair<uint32_t, double>> candidates; // (行, alpha_pj)
+			double maxStep = FP64_INF;
+			for (uint32_t j = 0; j < n + m; j++) {
+				if (colStatus[j] == BASIC || lower[j] == upper[j]) continue;
+				const double a = dotCol(rho, j); // x_B[pos] 隨 x_j 的變化率為 -a
+				const bool canIncrease = colStatus[j] != AT_UPPER, canDecrease = colStatus[j] != AT_LOWER;
+				const bool isEligible = isToLower
+					? (canIncrease && a < -PIVOT_TOL) || (canDecrease && a > PIVOT_TOL)
+					: (canIncrease && a > PIVOT_TOL) || (canDecrease && a < -PIVOT_TOL);
+				if (!isEligible) continue;
+				candidates.push_back({ j, a });
+				maxStep = min(maxStep, (abs(reducedCost(j, false)) + OPT_TOL) / abs(a));
+			}
+			if (candidates.empty()) return Status::INFEASIBLE; // 這一列無法回到範圍內, LP 無解
+			
+			int32_t enterCol = -1;
+			double enterAlpha = 0;
+			for (auto& [j, a]: candidates) {
+				if (abs(reducedCost(j, false)) / abs(a) <= maxStep && abs(a) > abs(enterAlpha)) {
+					enterCol = j;
+					enterAlpha = a;
+				}
+			}
+			
+			const double delta = (x[leaveCol] - (isToLower ? lower[leaveCol] : upper[leaveCol])) / enterAlpha; // x_q 的變化量
+			ftranCol(enterCol);
+			x[enterCol] += delta;
+			for (uint32_t pos = 0; pos < m; pos++) x[baseColIndexs[pos]] -= delta * alpha[pos];
+			pivot(leavePos, enterCol, isToLower ? AT_LOWER : AT_UPPER);
 		}
+		return Status::ITERATION_LIMIT;
 	}
 };
 
-class IP { // Integer Programming
+class LP { // Linear Programming
 private:
-	class Node { // branch & bound 的 node
+	class Tableau { // tableau, 注意: 第零列為 head, 第一列開始才是約束的部分
 	private:
-		static int32_t getSplitVarIndex(LP& lp) { // 決定下次分支要切分的基底變數編號, 如果基底變數的值全部都是整數 (LP feasible) 則回傳 -1
-			for (uint32_t i = 0; i < lp.solution.size(); i++) if (!FOP::isInt(lp.solution[i])) return i; // 目前的策略是尋找編號最小的 float 變數值
-			return -1;
-		}
+		vector<double> arr; // 扁平化的二維陣列
 		
-		static double getSplitValue(pair<double, double> varRange, double varSolution) { // 根據某個基底變數的範圍和 LP 解, 決定切分值
-			return varSolution; // 後來發現直接這樣切會更快
-			
-			if (varRange.second == FP64_INF) return varSolution; // 將 [?, inf] 切分為 [?, sol] & [sol, inf]
-			return (varRange.first + varRange.second) / 2; // 將 [a, b] 根據中點 (a+b)/2 切分
-		} // 因為如果照著某個 LP solution 去分支 (投影片的演算法), 會嘗試對特定變數切 1000, 999, 998, ... (所以目前是直接對半切)
+		double& arr_(uint32_t i, uint32_t j) { // 訪問扁平化的二維陣列
+			return arr[cols * i + j];
+		}
 	
 	public:
-		struct cmp { // priority queue 用的比較子, 會變成以 node 下界排序的 min-heap
-			bool operator()(const Node& a, const Node& b) const { return a.lowerBound > b.lowerBound; }
+		uint32_t rows; // row 數
+		uint32_t cols; // col 數
+		vector<int32_t> baseVarIndexs; // 基底變數的編號, -1 代表 artifical var
+		
+		struct BoundRow { // 由變數範圍轉成的約束列, 記錄它的 slack var 行編號, warm start 時可以直接收緊右側常數
+			uint32_t varIndex; // 被限制的變數 x_j
+			bool isUpper; // true: x_j <= bound ; false: x_j >= bound
+			uint32_t slackVarColIndex; // 這一列的 slack var 的行編號
+			double bound; // 目前的界
 		};
+		vector<BoundRow> boundRows; // 所有由變數範圍轉成的約束列
 		
-		enum class Type { IP_FEASIBLE, LP_FEASIBLE, INFEASIBLE, UNBOUNDED }; // 有 IP 解, 有 LP 解, 無解, 無界 (比較麻煩)
+		// [bounded simplex] tableau 內的變數 x' 範圍都是 [0, width], 非基底變數固定為 0
+		// 原座標 x = lower + x' (未翻轉) 或 x = lower + width - x' (翻轉, 代表非基底時 x 在上界)
+		vector<double> varLower; // 每一行變數的下界 (原座標), slack var 為 0
+		vector<double> varWidth; // 每一行變數的寬度 (上界 - 下界), 沒有上界為 inf
+		vector<uint8_t> isComplemented; // 每一行變數是否被翻轉
 		
-		vector<double> solution; // float LP 解
-		double lowerBound = FP64_NAN; // 節點的 float min LP 下界, int 解只可能更大
-		Type type; // node 的型態
-		vector<pair<double, double>> varRangeLeft; // 下一次分支, 左子節點每個變數的範圍, 注意: 變數 x_j 的範圍為 [varRange[j].first, varRange[j].second]
-		vector<pair<double, double>> varRangeRight; // 下一次分支, 右子節點每個變數的範圍
+		double& operator()(uint32_t i, uint32_t j) { // 訪問扁平化的二維陣列
+			return arr[cols * i + j];
+		};
 		
-		Node(Linearform& objFunc, vector<Constraint>& multiCon, vector<pair<double, double>>& varRange) {
-			LP lp(true, objFunc, multiCon, varRange); // 解 LP (已經將 max 標準化為 min)
-			solution = lp.solution; // float LP 解
-			lowerBound = lp.extremum; // float min LP 的極值
-			
-			if (lp.solutionType == LP::Type::INFEASIBLE) type = Type::INFEASIBLE;
-			else if (lp.solutionType == LP::Type::UNBOUNDED) type = Type::UNBOUNDED;
-			else if (lp.solutionType == LP::Type::BOUNDED) {
-				int32_t splitVarIndex = getSplitVarIndex(lp); // 下次分支要切分的基底變數編號
-				if (splitVarIndex == -1) { // 如果基底變數的值全部都是整數 (IP feasible), 更新全域的 int min IP 上界
-					type = Type::IP_FEASIBLE;
-				} else { // 如果有基底變數的值是 float, 計算出下一次分支的左右節點的變數範圍
-					type = Type::LP_FEASIBLE;
-					varRangeLeft = varRange; // 複製兩份 varRange, 分別為左右子節點的變數範圍
-					varRangeRight = varRange;
-					
-					double splitValue = floor(getSplitValue(varRangeLeft[splitVarIndex], lp.solution[splitVarIndex])); // 切分值
-					varRangeLeft[splitVarIndex].second = splitValue; // 將左子節點的切分基底值的上界設為 splitValue
-					varRangeRight[splitVarIndex].first = splitValue + 1; // 將右子節點的切分基底值的下界設為 splitValue + 1
-				}
-			}
+		double* data() { // [GPU] 整個 tableau 的連續記憶體, 上傳/下載用
+			return arr.data();
 		}
 		
-		void print(VarBimap bimap, bool showRange = false) {
-			if (type == Type::IP_FEASIBLE) {
-				printf("[IP solution found] Objective value = %.2f\n", lowerBound);
-			} else if (type == Type::INFEASIBLE) {
-				printf("IP solution is infeasible.\n");
-			} else if (type == Type::UNBOUNDED) {
-				printf("LP solution is unbounded, maybe IP solution does not exist.\n");
-			} else if (type == Type::LP_FEASIBLE) {
-				printf("IP feasible objective value >= %.2f\n", lowerBound);
+		void init(uint32_t rows, uint32_t cols) { // 初始化 tableau
+			this->rows = rows; // 設定列數
+			this->cols = cols; // 設定行數
+			arr = vector<double>(rows * cols, 0); // 預設全為零
+			baseVarIndexs = vector<int32_t>(rows, 0); // 因為第零列沒有基底編號, 使 index 對齊
+			varLower = vector<double>(cols - 1, 0); // 預設所有變數範圍為 [0, inf]
+			varWidth = vector<double>(cols - 1, FP64_INF);
+			isComplemented = vector<uint8_t>(cols - 1, 0);
+		}
+		
+		double getBaseVarWidth(uint32_t i) { // 列 i 的基底變數的寬度, artificial var 沒有上界
+			return baseVarIndexs[i] == -1 ? FP64_INF : varWidth[baseVarIndexs[i]];
+		}
+		
+		double getVarValue(uint32_t j, double value) { // 將 tableau 內變數 x'_j 的值轉回原座標
+			return varLower[j] + (isComplemented[j] ? varWidth[j] - value : value);
+		}
+		
+		void complementCol(uint32_t j) { // [bounded simplex] 非基底變數 x'_j 從 0 翻到 width (x'_j = width - x''_j), 基底的值會跟著改變
+			for (uint32_t i = 0; i < rows; i++) {
+				arr_(i, cols - 1) -= arr_(i, j) * varWidth[j];
+				arr_(i, j) = -arr_(i, j);
+			}
+			isComplemented[j] ^= 1;
+		}
+		
+		void complementBaseVar(uint32_t i) { // [bounded simplex] 將列 i 的基底變數換成 width - x' 表示, 值不變, 只有列 i 會改變
+			const uint32_t baseVarIndex = baseVarIndexs[i];
+			for (uint32_t j = 0; j < cols - 1; j++) if (j != baseVarIndex) arr_(i, j) = -arr_(i, j);
+			arr_(i, cols - 1) = varWidth[baseVarIndex] - arr_(i, cols - 1);
+			isComplemented[baseVarIndex] ^= 1;
+		}
+		
+		uint32_t appendRowAndSlackCol() { // 在最後新增一列, 並在右側常數行之前新增一個 slack var 行 (全為 0), 回傳新 slack var 的行編號
+			vector<double> newArr((rows + 1) * (cols + 1), 0);
+			for (uint32_t i = 0; i < rows; i++) {
+				for (uint32_t j = 0; j < cols - 1; j++) newArr[(cols + 1) * i + j] = arr_(i, j); // 原本的變數行
+				newArr[(cols + 1) * i + cols] = arr_(i, cols - 1); // 右側常數行往右移一格
+			}
+			arr = move(newArr);
+			rows++;
+			cols++;
+			baseVarIndexs.push_back(0);
+			varLower.push_back(0);
+			varWidth.push_back(FP64_INF);
+			isComplemented.push_back(0);
+			return cols - 2; // 新 slack var 的行編號 (右側常數行的左邊)
+		}
+		
+		void scaleRow(uint32_t i, double s) { // 將列 i 除以常數 s
+			if (enableMatrixEliminationParallel) simdKernels.divRow(&arr_(i, 0), s, cols);
+			else for (uint32_t k = 0; k < cols; k++) arr_(i, k) /= s;
+		}
+		
+		void addRowToRow(uint32_t i, uint32_t j, double s) { // 列 i 乘常數 s 加到列 j
+			if (enableMatrixEliminationParallel) simdKernels.subScaledRow(&arr_(j, 0), &arr_(i, 0), -s, cols);
+			else for (uint32_t k = 0; k < cols; k++) arr_(j, k) += arr_(i, k) * s;
+		}
+		
+		void elimination(uint32_t i, uint32_t j) { // 用 A_{ij} 消去行 j 的其他元素, 並將列 i 同除 A_{ij}, 使 A_{ij} = 1
+			CycleTimer timer(SolverCounters::ELIMINATION_CYCLES); // [stats]
+			if (enableMatrixEliminationParallel) { // 啟用矩陣列運算 SIMD 向量化加速
+				parallelArrayElimination(cols, arr, i, j);
+				return; // 跳過原始演算法
+			}
+			
+			const double aij = arr_(i, j);
+			if (useIntraLPParallel(arr.size())) { // [intra-LP parallel]
+				#pragma omp parallel for schedule(static)
+				for (uint32_t k = 0; k < rows; k++) if (k != i) addRowToRow(i, k, -arr_(k, j) / aij);
+			} else {
+				for (uint32_t k = 0; k < rows; k++) {
+					if (k != i) addRowToRow(i, k, -arr_(k, j) / aij); // 用 A_{ij} 消去行 j 的其他元素
+				}
+			}
+			// 消去完成後,再統一設為 0
+			for (uint32_t k = 0; k < rows; k++) {
+				if (k != i) arr_(k, j) = 0;
+			}
+			scaleRow(i, aij); // 將列 i 同除 A_{ij}, 使 A_{ij} = 1
+		}
+		
+		void print() { // debug
+			for (uint32_t i = 0; i < rows; i++) {
+				for (uint32_t j = 0; j < cols; j++) printf("%.02f ", (*this)(i, j));
+				if (i > 0) printf("= x_%d", baseVarIndexs[i]); // print 基底
+				printf("\n");
+			}
+		}
+	} tableau;
+	
+	bool isMin; // min/max
+	double cutoff; // [cutoff] 最佳值一定比這個值差 (min: >=, max: <=) 時可以提早結束, inf 代表沒有 cutoff
+	const SparseModel& model; // [sparse model] 目標函數和約束 (唯讀共用)
+	
+	uint32_t varCount; // 一般變數的個數, index 為 0 ~ varCount-1
+	vector<Tableau::BoundRow> varRangeBoundRows; // 將變數範圍轉為 bound 列: x_j >= min 或 x_j <= max
+	RevisedSimplex::Basis basis; // [revised simplex] 最佳基底
+	
+	static constexpr double HARRIS_TOL = 1e-7; // [Harris] ratio test 放寬的誤差, 遠小於 FOP::EPS
+	static constexpr uint32_t MIN_STALL_PIVOT_COUNT = 50; // [anti-stalling] 連續退化 pivot 至少這麼多次 (且 >= 列數) 才算停滯
+	bool isBlandMode = false; // [anti-stalling] 目前是否使用 Bland's rule
+	uint32_t degeneratePivotCount = 0; // [anti-stalling] 連續退化 pivot 的次數
+	vector<double> devexWeights; // [devex] 每一行的參考權重, 每次執行 simplex method 時重設為 1
+	
+	int32_t findNewBaseVarIndex() { // 尋找一個新的基底變數, 若沒找到則回傳 -1
+		const uint32_t colCount = tableau.cols - 1; // 最後一列是基底常數, 不能進入
+		const uint32_t startCol = isBlandMode || colCount == 0 ? 0 : lpTieBreakSeed % colCount; // [portfolio] Bland's rule 一定要照編號順序才不會循環
+		if (isBlandMode || pricingRule == PricingRule::FIRST_POSITIVE) { // 編號最小的正 reduced cost 就是 Bland's rule 的進入規則
+			if (enableMatrixEliminationParallel) { // [SIMD dispatch] FOP::isPos 就是 >= EPS
+				const int32_t j = simdKernels.findFirstAtLeast(&tableau(0, startCol), colCount - startCol, FOP::EPS);
+				if (j != -1 || startCol == 0) return j == -1 ? -1 : startCol + j;
+				return simdKernels.findFirstAtLeast(&tableau(0, 0), startCol, FOP::EPS); // [portfolio] 繞回開頭
+			}
+			for (uint32_t k = 0, j = startCol; k < colCount; k++, j = j + 1 == colCount ? 0 : j + 1) if (FOP::isPos(tableau(0, j))) return j;
+			return -1;
+		}
+		
+		int32_t newBaseVarIndex = -1; // [pricing] 分數最高的正 reduced cost: Dantzig 為 d_j, 最陡邊為 d_j^2 / ||a_j||^2, devex 為 d_j^2 / w_j
+		double maxScore = 0;
+		for (uint32_t k = 0, j = startCol; k < colCount; k++, j = j + 1 == colCount ? 0 : j + 1) { // [portfolio] 同分時選掃描順序中第一個
+			const double reducedCost = tableau(0, j);
+			if (!FOP::isPos(reducedCost)) continue;
+			double score = reducedCost;
+			if (pricingRule == PricingRule::STEEPEST_EDGE) { // 邊的方向為 (-a_j, e_j), 長度的平方 1 + sum a_ij^2
+				double normSquare = 1;
+				for (uint32_t i = 1; i < tableau.rows; i++) normSquare += tableau(i, j) * tableau(i, j);
+				score = reducedCost * reducedCost / normSquare;
+			} else if (pricingRule == PricingRule::DEVEX) score = reducedCost * reducedCost / devexWeights[j];
+			if (score > maxScore) {
+				maxScore = score;
+				newBaseVarIndex = j;
+			}
+		}
+		return newBaseVarIndex;
+	}
+	
+	void updateDevexWeights(uint32_t rowIndex, uint32_t newBaseVarIndex) { // [devex] pivot 之前用 pivot 列更新參考權重: w_j = max(w_j, (a_rj / a_rq)^2 w_q)
+		const double pivot = tableau(rowIndex, newBaseVarIndex), newBaseWeight = devexWeights[newBaseVarIndex];
+		for (uint32_t j = 0; j <= tableau.cols - 2; j++) if (j != newBaseVarIndex && tableau(rowIndex, j) != 0) {
+			const double ratio = tableau(rowIndex, j) / pivot;
+			devexWeights[j] = max(devexWeights[j], ratio * ratio * newBaseWeight);
+		}
+		const int32_t leavingVarIndex = tableau.baseVarIndexs[rowIndex]; // 離開的基底變數, artificial var 沒有行
+		if (leavingVarIndex >= 0) devexWeights[leavingVarIndex] = max(newBaseWeight / (pivot * pivot), 1.0);
+	}
+	
+	int32_t findMinPosRatioRowIndex(uint32_t baseVarIndex, double& minPosRatio, bool& isLeavingAtUpper) { // 選定要進入的基底後, 尋找一個 Aij / r 最小的正比值, 回傳這個值在第幾列, 找不到回傳 -1
+		minPosRatio = 1e300; // 最小正比值: 右側常數/係數
+		int32_t minPosRatioRowIndex = -1; // 要更換基底的 row index, 若為 -1 代表沒有找到
+		
+		auto scanRows = [&](uint32_t rowBegin, uint32_t rowEnd, double& bestRatio, int32_t& bestRowIndex, bool& bestIsUpper) { // 在 [rowBegin, rowEnd) 找最小正比值
+			for (uint32_t i = rowBegin; i < rowEnd; i++) {
+				const double aij = tableau(i, baseVarIndex);
+				double ratio;
+				bool isUpper = false;
+				if (FOP::isPos(aij)) ratio = tableau(i, tableau.cols - 1) / aij; // 要正比值, 基底變數減少到 0
+				else if (FOP::isPos(-aij) && !isinf(tableau.getBaseVarWidth(i))) { // [bounded simplex] 基底變數增加到上界
+					ratio = (tableau.getBaseVarWidth(i) - tableau(i, tableau.cols - 1)) / -aij;
+					isUpper = true;
+				} else continue;
+				
+				if (ratio < bestRatio || (isBlandMode && bestRowIndex != -1 && ratio == bestRatio && tableau.baseVarIndexs[i] < tableau.baseVarIndexs[bestRowIndex])) { // [anti-stalling] Bland's rule: 比值相同時取基底變數編號小的
+					bestRatio = ratio;
+					bestRowIndex = i;
+					bestIsUpper = isUpper;
+				}
+			}
+		};
+		if (enableHarrisRatioTest && !isBlandMode) return findHarrisRatioRowIndex(baseVarIndex, minPosRatio, isLeavingAtUpper); // Bland's rule 需要精確的最小比值
+		if (!useIntraLPParallel((size_t)tableau.rows * tableau.cols)) {
+			scanRows(1, tableau.rows, minPosRatio, minPosRatioRowIndex, isLeavingAtUpper);
+			return minPosRatioRowIndex;
+		}
+		
+		#pragma omp parallel // [intra-LP parallel] 每個 thread 找自己那段列的最小比值, 再合併
+		{
+			const uint32_t threadCount = omp_get_num_threads(), threadIndex = omp_get_thread_num();
+			const uint32_t chunk = (tableau.rows - 1 + threadCount - 1) / threadCount;
+			const uint32_t rowBegin = min(tableau.rows, 1 + threadIndex * chunk), rowEnd = min(tableau.rows, rowBegin + chunk);
+			double localMinRatio = 1e300;
+			int32_t localRowIndex = -1;
+			bool localIsUpper = false;
+			scanRows(rowBegin, rowEnd, localMinRatio, localRowIndex, localIsUpper);
+			
+			#pragma omp critical (ratioTest)
+			if (localRowIndex != -1 && (minPosRatioRowIndex == -1 || localMinRatio < minPosRatio || (localMinRatio == minPosRatio && (isBlandMode
+				? tableau.baseVarIndexs[localRowIndex] < tableau.baseVarIndexs[minPosRatioRowIndex]
+				: localRowIndex < minPosRatioRowIndex)))) {
+				minPosRatio = localMinRatio; // 比值相同時取編號小的列, 和單執行緒的結果一樣
+				minPosRatioRowIndex = localRowIndex;
+				isLeavingAtUpper = localIsUpper;
+			}
+		}
+		return minPosRatioRowIndex;
+	}
+	
+	int32_t findHarrisRatioRowIndex(uint32_t baseVarIndex, double& minPosRatio, bool& isLeavingAtUpper) { // [Harris] two-pass ratio test, 回傳值和 findMinPosRatioRowIndex 相同
+		const uint32_t rhsColIndex = tableau.cols - 1;
+		auto rowRatio = [&](uint32_t i, double tol, bool& isUpper) { // 列 i 的基底變數碰到界 (放寬 tol) 的比值, 不會碰到界回傳 inf
+			const double aij = tableau(i, baseVarIndex);
+			isUpper = false;
+			if (FOP::isPos(aij)) return (max(0.0, tableau(i, rhsColIndex)) + tol) / aij; // 誤差造成的負右側常數視為 0
+			if (FOP::isPos(-aij) && !isinf(tableau.getBaseVarWidth(i))) {
+				isUpper = true;
+				return (max(0.0, tableau.getBaseVarWidth(i) - tableau(i, rhsColIndex)) + tol) / -aij;
+			}
+			return FP64_INF;
+		};
+		const bool isParallel = useIntraLPParallel((size_t)tableau.rows * tableau.cols);
+		
+		double maxRatio = FP64_INF; // 第一次: 放寬的界裡最小的比值, 就是所有基底變數都不會超出 tol 的最大步長
+		#pragma omp parallel for reduction(min: maxRatio) if (isParallel)
+		for (uint32_t i = 1; i < tableau.rows; i++) {
+			bool isUpper;
+			maxRatio = min(maxRatio, rowRatio(i, HARRIS_TOL, isUpper));
+		}
+		
+		minPosRatio = 1e300;
+		int32_t minPosRatioRowIndex = -1;
+		double maxAbsPivot = 0;
+		#pragma omp parallel if (isParallel) // 第二次: 比值不超過最大步長的列之中, 挑 |A_ij| 最大的, 相同時取編號小的列
+		{
+			int32_t localRowIndex = -1;
+			double localRatio = 0, localAbsPivot = 0;
+			bool localIsUpper = false;
+			#pragma omp for nowait
+			for (uint32_t i = 1; i < tableau.rows; i++) {
+				bool isUpper;
+				const double ratio = rowRatio(i, 0, isUpper);
+				if (ratio > maxRatio || abs(tableau(i, baseVarIndex)) <= localAbsPivot) continue;
+				localRowIndex = i;
+				localRatio = ratio;
+				localAbsPivot = abs(tableau(i, baseVarIndex));
+				localIsUpper = isUpper;
+			}
+			
+			#pragma omp critical (harrisRatioTest)
+			if (localRowIndex != -1 && (localAbsPivot > maxAbsPivot || (localAbsPivot == maxAbsPivot && localRowIndex < minPosRatioRowIndex))) {
+				minPosRatioRowIndex = localRowIndex;
+				minPosRatio = localRatio;
+				maxAbsPivot = localAbsPivot;
+				isLeavingAtUpper = localIsUpper;
+			}
+		}
+		return minPosRatioRowIndex;
+	}
+	
+	void countDegeneratePivot(bool isDegenerate) { // [anti-stalling] 記錄連續退化 pivot 的次數, 太多次就切換到 Bland's rule, 目標值改善就換回來
+		if (!isDegenerate) {
+			degeneratePivotCount = 0;
+			isBlandMode = false;
+			return;
+		}
+		if (useAntiStalling() && ++degeneratePivotCount >= max(MIN_STALL_PIVOT_COUNT, tableau.rows)) isBlandMode = true;
+	}
+	
+	bool isTableauHaveArtificialVar() { // tableau 的基底是否含有 artificial var
+		for (uint32_t i = 1; i < tableau.rows; i++) if (tableau.baseVarIndexs[i] == -1) return true;
+		return false;
+	}
+	
+	bool isTableauHavePosArtificialVar() { // tableau 的基底是否含有值 > 0 的 artificial var (值為 0 的 artificial var 不影響可行性)
+		for (uint32_t i = 1; i < tableau.rows; i++) if (tableau.baseVarIndexs[i] == -1 && FOP::isPos(tableau(i, tableau.cols - 1))) return true;
+		return false;
+	}
+	
+	void driveOutArtificialVars() { // phase-1 結束後, 把值為 0 的 artificial var 換出基底, 否則 phase-2 可能讓它變成正的
+		for (uint32_t i = 1; i < tableau.rows; i++) if (tableau.baseVarIndexs[i] == -1) {
+			int32_t maxAbsColIndex = -1; // 選這一列絕對值最大的係數當 pivot, 數值比較穩定
+			for (uint32_t j = 0; j <= tableau.cols - 2; j++) {
+				if (!FOP::isZero(tableau(i, j)) && (maxAbsColIndex == -1 || abs(tableau(i, j)) > abs(tableau(i, maxAbsColIndex)))) maxAbsColIndex = j;
+			}
+			if (maxAbsColIndex == -1) continue; // 整列都是 0, 這是多餘的約束, artificial var 會一直是 0
+			
+			tableau.elimination(i, maxAbsColIndex); // 右側常數是 0, 所以不會改變解
+			tableau.baseVarIndexs[i] = maxAbsColIndex;
+		}
+	}
+	
+	void handleUnbound(uint32_t newBaseVarIndex) { // 若無界, 輸出當前向量和一個無限增長的方向向量 (這個向量集合仍然符合所有約束)
+		solutionType = Type::UNBOUNDED; // 無界
+		
+		solution = vector<double>(varCount, 0); // 空的解向量, 長度為一般變數的數目
+		unboundedDirection = vector<double>(varCount, 0); // 方向向量
+		for (uint32_t i = 1; i < tableau.rows; i++) {
+			uint32_t baseVarIndex = tableau.baseVarIndexs[i];
+			if (baseVarIndex <= varCount - 1) { // 如果基底變數編號為 0 ~ varCount-1 代表為一般變數
+				solution[baseVarIndex] = tableau.getVarValue(baseVarIndex, tableau(i, tableau.cols - 1));
+				unboundedDirection[baseVarIndex] = tableau(i, newBaseVarIndex) * (isMin ? 1 : -1) * (tableau.isComplemented[baseVarIndex] ? -1 : 1);
+			}
+		} // slack var 編號 >= varCount, 所以不會出現在解向量裡
+		
+		extremum = isMin ? -FP64_INF : FP64_INF; // min -> -inf ; max -> inf
+	}
+	
+	bool runMinSimplexMethod(bool isPhase1 = false) { // 對 tableau 執行 min simplex method, 若有界回傳 true, 無解或無界回傳 false. isPhase1 只影響 [stats] 的計數
+		isBlandMode = false;
+		degeneratePivotCount = 0;
+		if (pricingRule == PricingRule::DEVEX) devexWeights.assign(tableau.cols - 1, 1); // [devex] 參考架構為目前的非基底變數
+		const SolverCounters::Counter pivotCounter = isPhase1 ? SolverCounters::PHASE1_PIVOT : SolverCounters::PHASE2_PIVOT;
+#ifdef USE_GPU
+		if (useGpuTableau((size_t)tableau.rows * tableau.cols)) {
+			GpuTableau* gpuTableau = gpuTableauCreate(tableau.data(), tableau.rows, tableau.cols); // 整個 simplex 迴圈 tableau 都留在 device 上, 每次 pivot 只傳回兩個編號
+			if (gpuTableau != nullptr) { // 上傳失敗 (記憶體不足) 就照常在 CPU 上解
+				optional<bool> isBounded = runMinSimplexMethodOnGpu(gpuTableau, pivotCounter);
+				if (isBounded.has_value()) return *isBounded;
+			} // device 途中出錯: host 的 tableau 還是開始時的樣子, 改在 CPU 上從頭解
+		}
+#endif
+		for (;; lpPivotCount++, solverCounters->add(pivotCounter)) {
+			const int32_t newBaseVarIndex = findNewBaseVarIndex(); // 嘗試尋找新基底 [複雜度: n]
+			if (newBaseVarIndex == -1) break; // 若沒有找到可進入的基底, 跳出迴圈
+			
+			double minPosRatio;
+			bool isLeavingAtUpper;
+			const int32_t rowIndex = findMinPosRatioRowIndex(newBaseVarIndex, minPosRatio, isLeavingAtUpper); // 嘗試尋找最小正數比值的列編號 [複雜度: m]
+			if (tableau.varWidth[newBaseVarIndex] <= minPosRatio) { // [bounded simplex] 新基底先碰到自己的上界, 不用換基底, 直接翻到上界
+				tableau.complementCol(newBaseVarIndex);
+				countDegeneratePivot(false);
+				continue;
+			}
+			if (rowIndex == -1) { // 若新基底存在, 但最小正數比值不存在, 則 LP 問題無界
+				handleUnbound(newBaseVarIndex);
+				return false; // 提前結束迴圈
+			}
+			
+			countDegeneratePivot(minPosRatio <= HARRIS_TOL); // 步長為 0 的 pivot 不會改變目標值
+			if (isLeavingAtUpper) tableau.complementBaseVar(rowIndex); // [bounded simplex] 離開的基底變數停在上界, 翻轉後就是停在 0
+			if (pricingRule == PricingRule::DEVEX) updateDevexWeights(rowIndex, newBaseVarIndex);
+			tableau.elimination(rowIndex, newBaseVarIndex); // 對新基底的行做消元, 只留下最小正數比值的列 [複雜度: m*n]
+			tableau.baseVarIndexs[rowIndex] = newBaseVarIndex; // 更改新基底編號
+		}
+		
+		if (isTableauHavePosArtificialVar()) return false; // 執行完 simplex method, 若最小的 L1-norm 起始向量包含 artificial var, 則 LP 問題無解
+		return true;
+	}
+	
+#ifdef USE_GPU
+	optional<bool> runMinSimplexMethodOnGpu(GpuTableau* gpuTableau, SolverCounters::Counter pivotCounter) { // [GPU] 與 runMinSimplexMethod 相同的迴圈, pricing/ratio test/消元都在 device 上做, 結束時才把 tableau 複製回來. device 出錯時回傳 nullopt, host 的 tableau 維持原狀
+		const bool isDantzig = pricingRule == PricingRule::DANTZIG;
+		const vector<int32_t> startBaseVarIndexs = tableau.baseVarIndexs; // 出錯時還原, host 的 tableau 在成功複製回來之前都沒有動過
+		bool isBounded = true, isFailed = false;
+		for (;; lpPivotCount++, solverCounters->add(pivotCounter)) {
+			const int32_t newBaseVarIndex = gpuTableauFindEntering(gpuTableau, isDantzig, FOP::EPS);
+			if (newBaseVarIndex == -1) break;
+			if (newBaseVarIndex == GPU_TABLEAU_ERROR) {
+				isFailed = true;
+				break;
+			}
+			
+			double minPosRatio;
+			const int32_t rowIndex = gpuTableauFindLeaving(gpuTableau, newBaseVarIndex, FOP::EPS, minPosRatio);
+			if (rowIndex == GPU_TABLEAU_ERROR) {
+				isFailed = true;
+				break;
+			}
+			if (rowIndex == -1) { // 無界, handleUnbound 要讀 host 上的 tableau
+				if (!downloadGpuTableau(gpuTableau)) {
+					isFailed = true;
+					break;
+				}
+				isBounded = false;
+				handleUnbound(newBaseVarIndex);
+				break;
+			}
+			
+			bool isPivoted;
+			{
+				CycleTimer timer(SolverCounters::ELIMINATION_CYCLES); // [stats] gpuTableauPivot 會等 kernel 做完, 量到的是消元時間而不只是啟動時間
+				isPivoted = gpuTableauPivot(gpuTableau, rowIndex, newBaseVarIndex);
+			}
+			if (!isPivoted) {
+				isFailed = true;
+				break;
+			}
+			tableau.baseVarIndexs[rowIndex] = newBaseVarIndex;
+		}
+		if (isBounded && !isFailed && !downloadGpuTableau(gpuTableau)) isFailed = true;
+		gpuTableauDestroy(gpuTableau);
+		
+		if (isFailed) {
+			printf("GPU tableau failed, solving this LP on the CPU\n");
+			tableau.baseVarIndexs = startBaseVarIndexs;
+			return nullopt;
+		}
+		if (!isBounded) return false;
+		if (isTableauHavePosArtificialVar()) return false;
+		return true;
+	}
+	
+	bool downloadGpuTableau(GpuTableau* gpuTableau) { // [GPU] 先複製到暫存, 成功才寫進 host 的 tableau, 失敗時 tableau 維持原狀 (給 CPU 重解)
+		vector<double> buffer((size_t)tableau.rows * tableau.cols);
+		if (!gpuTableauDownload(gpuTableau, buffer.data())) return false;
+		copy(buffer.begin(), buffer.end(), tableau.data());
+		return true;
+	}
+#endif
+	
+	void initTableau() { // init tableau
+		uint32_t slackVarCount = 0; // 計算 slack var 個數, 決定 tableau 的 col 數 (因為要分配連續記憶體)
+		for (uint32_t i = 0; i < model.rowCount; i++) if (model.haveSlackVar(i)) slackVarCount++;
+		slackVarCount += varRangeBoundRows.size(); // bound 列都有 slack var
+		tableau.init(1 + model.rowCount + varRangeBoundRows.size(), varCount + slackVarCount + 1); // init tableau
+	}
+	
+	void insertConToTableau() { // 將約束插入 tableau
+		CycleTimer timer(SolverCounters::INSERT_CON_CYCLES); // [stats]
+		uint32_t rowIndex = 1;
+		uint32_t slackVarColIndex = varCount - 1; // 因為一般變數的 col index 為 0 ~ varCount-1, 所以 slack var 插入的 col index 從這裡開始數
+		auto setTableauRow = [&](const uint32_t* colIndexs, const double* coefs, uint32_t termCount, double rightConst, double slackVarCoef) { // 將一個約束加入到 tableau
+			for (uint32_t p = 0; p < termCount; p++) {
+				tableau(rowIndex, colIndexs[p]) = coefs[p]; // 填入一般變數
+				rightConst -= coefs[p] * tableau.varLower[colIndexs[p]]; // [bounded simplex] 變數平移到下界, 右側常數跟著改變
+			}
+			
+			if (rightConst < 0) { // 平移後右側常數變負, 整列變號 (<= 和 >= 轉向)
+				for (uint32_t j = 0; j < varCount; j++) tableau(rowIndex, j) = -tableau(rowIndex, j);
+				rightConst = -rightConst;
+				slackVarCoef = -slackVarCoef;
+			}
+			
+			if (slackVarCoef != 0) tableau(rowIndex, ++slackVarColIndex) = slackVarCoef; // 如果有 slack var, 需要添加係數 1 或 -1 到 tableau 內
+			
+			tableau(rowIndex, tableau.cols - 1) = rightConst; // 在列的最右元素, 設定右側常數 (基底的值)
+			tableau.baseVarIndexs[rowIndex] = slackVarCoef == 1 ? slackVarColIndex : -1; // 只有 slack var 係數為 1 才能當起始基底, -1 代表 artifical var
+			
+			rowIndex++;
+		};
+		for (uint32_t i = 0; i < model.rowCount; i++) { // [sparse model] 直接讀 CSR 的連續陣列
+			const uint32_t p = model.rowStart[i];
+			setTableauRow(&model.rowColIndexs[p], &model.rowCoefs[p], model.rowStart[i + 1] - p, model.rightConsts[i], model.getSlackVarCoef(i));
+		}
+		for (Tableau::BoundRow boundRow: varRangeBoundRows) {
+			const double coef = 1; // 變數範圍的約束只有一項 x_j
+			setTableauRow(&boundRow.varIndex, &coef, 1, boundRow.bound, boundRow.isUpper ? 1 : -1);
+			boundRow.slackVarColIndex = slackVarColIndex;
+			tableau.boundRows.push_back(boundRow); // 記錄 bound 列給 warm start 用
+		}
+	}
+	
+	bool checkInfeasible() { // 檢查是否無解, 並做處理, 若無解則回傳 false, 非無解則回傳 true
+		if (!isTableauHaveArtificialVar()) return true; // 如果不存在 artificial var, 跳過這一步
+		
+		for (uint32_t i = 1; i < tableau.rows; i++) if (tableau.baseVarIndexs[i] == -1) {
+			tableau.addRowToRow(i, 0, 1); // 將 artificial var 的列加到第零列, 消去第零列的 art-var 係數 -1 (但我們的演算法不會儲存 art-var 的行係數)
+		}
+		
+		if (!runMinSimplexMethod(true)) return false; // 嘗試求出一個最小的 L1-norm 起始向量, 若無解則回傳 false
+		driveOutArtificialVars(); // 剩下的 artificial var 值都是 0 (退化), 換出基底
+		
+		for (uint32_t j = 0; j < tableau.cols; j++) tableau(0, j) = 0; // 雖然理論上第零列應該是全 0 的, 只是為了消除小誤差
+		return true; // 可能為有界或無界
+	}
+	
+	void insertObjFuncToTableau() { // 將目標函數插入到 tableau 的第零列
+		double objConst = 0; // [bounded simplex] 變數平移/翻轉產生的目標函數常數項
+		for (uint32_t varIndex = 0; varIndex < varCount; varIndex++) {
+			const double coef = model.objCoefs[varIndex];
+			if (coef == 0) continue;
+			const bool isComplemented = tableau.isComplemented[varIndex];
+			tableau(0, varIndex) = coef * (isMin ? -1 : 1) * (isComplemented ? -1 : 1);
+			objConst += coef * (isMin ? 1 : -1) * (tableau.varLower[varIndex] + (isComplemented ? tableau.varWidth[varIndex] : 0));
+		}
+		tableau(0, tableau.cols - 1) = objConst;
+	} // 此時 tableau 的第零列是空的, 填入目標函數. 注意: 因為將 max obj func 變號會轉為 min 問題, 所以 max 問題在這裡會填入 +coef 而不是 -coef
+	
+	void handleNonZeroHead() { // 處理 row 0 的非零基底行元素 (phase-2). 若沒做 phase-1 則這一步不會有實際影響
+		for (uint32_t i = 1; i < tableau.rows; i++) {
+			if (tableau.baseVarIndexs[i] == -1) continue; // 多餘約束的 artificial var 沒有行
+			uint32_t baseVarIndex = tableau.baseVarIndexs[i]; // 檢查每一列對應的基底變數所對應的行的 row 0 元素是不是 0
+			if (!FOP::isZero(tableau(0, baseVarIndex))) tableau.addRowToRow(i, 0, -tableau(0, baseVarIndex)); // 如果非 0, 需要執行列運算, 消去它
+		}
+	}
+	
+	int32_t findDualRatioColIndex(uint32_t rowIndex) { // dual simplex: 在右側常數為負的列中, 尋找 (第零列 / A_rj) 最小且 A_rj < 0 的行, 找不到回傳 -1
+		if (enableMatrixEliminationParallel) return simdKernels.findMinNegRatio(&tableau(0, 0), &tableau(rowIndex, 0), tableau.cols - 1, FOP::EPS); // [SIMD dispatch] 第零列和第 r 列都是連續記憶體
+		
+		double minRatio = 1e300;
+		int32_t minRatioColIndex = -1;
+		for (uint32_t j = 0; j <= tableau.cols - 2; j++) if (FOP::isPos(-tableau(rowIndex, j))) {
+			double ratio = max(0.0, tableau(0, j) / tableau(rowIndex, j)); // 第零列理論上 <= 0, 誤差造成的負比值視為 0
+			if (ratio < minRatio) {
+				minRatio = ratio;
+				minRatioColIndex = j;
+			}
+		}
+		return minRatioColIndex;
+	}
+	
+	enum class DualResult { FEASIBLE, INFEASIBLE, STALLED, CUTOFF }; // dual simplex 的結果: 找到可行解, 無解, 超過 pivot 次數上限, 目標值超過 cutoff
+	
+	DualResult runDualSimplexMethod() { // 對 dual 可行 (第零列皆 <= 0) 但右側常數可能為負的 tableau 執行 dual simplex
+		const uint32_t pivotLimit = 10 * (tableau.rows + tableau.cols); // 避免數值誤差造成的循環, 超過上限就交給 cold start
+		for (uint32_t pivotCount = 0; pivotCount < pivotLimit; pivotCount++, lpPivotCount++, solverCounters->add(SolverCounters::DUAL_PIVOT)) {
+			double maxViolation = FOP::EPS; // 尋找最負的右側常數 (或超出上界最多的基底變數), 讓它的基底變數離開
+			int32_t rowIndex = -1;
+			for (uint32_t i = 1; i < tableau.rows; i++) {
+				const double rightConst = tableau(i, tableau.cols - 1);
+				const double violation = max(-rightConst, rightConst - tableau.getBaseVarWidth(i));
+				if (violation > maxViolation) {
+					maxViolation = violation;
+					rowIndex = i;
+				}
+			}
+			if (rowIndex == -1) return DualResult::FEASIBLE; // 右側常數全部在 [0, width] 內, primal 可行
+			if (tableau(0, tableau.cols - 1) >= cutoff * (isMin ? 1 : -1)) return DualResult::CUTOFF; // [cutoff] 第零列的右側常數是 LP 最佳值的下界, 而且只會增加
+			if (tableau(rowIndex, tableau.cols - 1) > 0) tableau.complementBaseVar(rowIndex); // [bounded simplex] 超出上界, 翻轉後變成右側常數為負
+			
+			const int32_t newBaseVarIndex = findDualRatioColIndex(rowIndex);
+			if (newBaseVarIndex == -1) return DualResult::INFEASIBLE; // 這一列的係數全部 >= 0, 但右側常數 < 0, LP 無解
+			
+			tableau.elimination(rowIndex, newBaseVarIndex);
+			tableau.baseVarIndexs[rowIndex] = newBaseVarIndex;
+		}
+		return DualResult::STALLED;
+	}
+	
+	void applyBoundToTableau(uint32_t varIndex, bool isUpper, double bound) { // [warm start] 將 x_j <= bound 或 x_j >= bound 加入最佳 tableau, 右側常數可能變負
+		for (Tableau::BoundRow& boundRow: tableau.boundRows) if (boundRow.varIndex == varIndex && boundRow.isUpper == isUpper) {
+			// 已經有這個變數的 bound 列, 直接收緊: 右側常數改變 delta, 等於加上 delta * (slack var 在目前 tableau 的行)
+			const double delta = (bound - boundRow.bound) * (isUpper ? 1 : -1);
+			for (uint32_t i = 0; i < tableau.rows; i++) tableau(i, tableau.cols - 1) += delta * tableau(i, boundRow.slackVarColIndex);
+			boundRow.bound = bound;
+			return;
+		}
+		
+		// 沒有這個變數的 bound 列, 在最後新增 "x_j + s = bound" 或 "-x_j + s = -bound" (s 為新的基底)
+		const uint32_t slackVarColIndex = tableau.appendRowAndSlackCol();
+		const uint32_t rowIndex = tableau.rows - 1;
+		const double sign = isUpper ? 1 : -1;
+		tableau(rowIndex, varIndex) = sign;
+		tableau(rowIndex, slackVarColIndex) = 1;
+		tableau(rowIndex, tableau.cols - 1) = sign * bound;
+		tableau.baseVarIndexs[rowIndex] = slackVarColIndex;
+		tableau.boundRows.push_back({ varIndex, isUpper, slackVarColIndex, bound });
+		
+		for (uint32_t i = 1; i < rowIndex; i++) if (tableau.baseVarIndexs[i] == (int32_t)varIndex) { // 若 x_j 是基底, 用它的列消去新列的 x_j 係數
+			tableau.addRowToRow(i, rowIndex, -sign);
+			tableau(rowIndex, varIndex) = 0;
+			break;
+		}
+	}
+	
+	void applyVarRangeToTableau(uint32_t varIndex, double varMin, double varMax) { // [bounded simplex][warm start] 直接修改 x_j 的範圍, 基底的值可能超出範圍
+		const int32_t baseRowIndex = findBaseRowIndex(varIndex);
+		if (baseRowIndex != -1) { // x_j 是基底: 先換回未翻轉的表示, 再平移下界, 只有基底的列會改變
+			if (tableau.isComplemented[varIndex]) tableau.complementBaseVar(baseRowIndex);
+			tableau(baseRowIndex, tableau.cols - 1) += tableau.varLower[varIndex] - varMin;
+		} else { // x_j 非基底: 停在新的下界 (或上界), 所有基底的值跟著改變
+			const bool isComplemented = tableau.isComplemented[varIndex] && !isinf(varMax);
+			const double oldValue = tableau.getVarValue(varIndex, 0);
+			const double newValue = isComplemented ? varMax : varMin;
+			const double sign = tableau.isComplemented[varIndex] ? -1 : 1; // tableau 內的行轉回原座標的係數
+			for (uint32_t i = 0; i < tableau.rows; i++) tableau(i, tableau.cols - 1) -= sign * tableau(i, varIndex) * (newValue - oldValue);
+			if (isComplemented != (bool)tableau.isComplemented[varIndex]) { // 上界變成 inf, 只能停在下界
+				for (uint32_t i = 0; i < tableau.rows; i++) tableau(i, varIndex) = -tableau(i, varIndex);
+				tableau.isComplemented[varIndex] = isComplemented;
+			}
+		}
+		tableau.varLower[varIndex] = varMin;
+		tableau.varWidth[varIndex] = varMax - varMin;
+	}
+	
+	int32_t findBaseRowIndex(uint32_t varIndex) { // x_j 是哪一列的基底, 非基底回傳 -1
+		for (uint32_t i = 1; i < tableau.rows; i++) if (tableau.baseVarIndexs[i] == (int32_t)varIndex) return i;
+		return -1;
+	}
+	
+	bool isTableauDualFeasible() { // 第零列是否沒有正的 reduced cost (dual simplex 的前提)
+		for (uint32_t j = 0; j <= tableau.cols - 2; j++) if (FOP::isPos(tableau(0, j))) return false;
+		return true;
+	}
+	
+	void solveColdStart(vector<pair<double, double>>& varRange) { // 從頭建立 tableau 並執行 phase-1 & phase-2
+		uint32_t i = 0;
+		for (auto& [varMin, varMax]: varRange) { // min <= x_i <= max, 將變數範圍轉為約束
+			if (varMin > varMax) { // 變數範圍是空的
+				handleInfeasible();
+				return;
+			}
+			if (!enableBoundedSimplex) { // [bounded simplex] 變數範圍直接交給 ratio test, 不轉為約束
+				if (varMin > 0) varRangeBoundRows.push_back({ i, false, 0, varMin }); // x_i >= min
+				if (!isinf(varMax)) varRangeBoundRows.push_back({ i, true, 0, varMax }); // x_i <= max
+			}
+			i++;
+		}
+		
+		initTableau(); // init tableau
+		if (enableBoundedSimplex) for (uint32_t j = 0; j < varCount; j++) { // [bounded simplex] 設定每個變數的範圍
+			tableau.varLower[j] = varRange[j].first;
+			tableau.varWidth[j] = varRange[j].second - varRange[j].first;
+		}
+		insertConToTableau(); // 將約束插入 tableau
+		
+		if (!checkInfeasible()) { // 檢查是否無解, 並做處理 (phase-1)
+			handleInfeasible(); // checkInfeasible 輸出 false, 無解
+		} else { // checkInfeasible 輸出 true, 可能為有界或無界. checkInfeasible 已處理基底不足的問題
+			insertObjFuncToTableau(); // 將目標函數插入到 tableau 的第零列
+			handleNonZeroHead(); // 處理 row 0 的非零基底行元素 (phase-2)
+			if (runMinSimplexMethod()) handleBound(); // 處理有界情況, 如果無界會提前終止並處理
+		}
+	}
+	
+	void solveRevised(vector<pair<double, double>>& varRange, const RevisedSimplex::Basis* parentBasis) { // [revised simplex] 用 revised simplex 解 LP
+		RevisedSimplex revisedSimplex(model, isMin, varRange);
+		revisedSimplex.cutoff = cutoff * (isMin ? 1 : -1);
+		RevisedSimplex::Status status = revisedSimplex.solve(parentBasis);
+		if (status == RevisedSimplex::Status::ITERATION_LIMIT && parentBasis != nullptr) status = revisedSimplex.solve(); // warm start 失敗, 從 slack 基底重新解
+		if (status == RevisedSimplex::Status::ITERATION_LIMIT) { // 數值不穩, 交給 tableau 引擎
+			solveColdStart(varRange);
+			return;
+		}
+		
+		if (status == RevisedSimplex::Status::INFEASIBLE) {
+			handleInfeasible();
+			return;
+		}
+		if (status == RevisedSimplex::Status::CUTOFF) {
+			handleCutoff(revisedSimplex.objValue);
+			return;
+		}
+		solution = vector<double>(revisedSimplex.x.begin(), revisedSimplex.x.begin() + varCount);
+		if (status == RevisedSimplex::Status::UNBOUNDED) {
+			solutionType = Type::UNBOUNDED;
+			unboundedDirection = vector<double>(revisedSimplex.ray.begin(), revisedSimplex.ray.begin() + varCount);
+			extremum = isMin ? -FP64_INF : FP64_INF;
+			return;
+		}
+		solutionType = Type::BOUNDED;
+		extremum = revisedSimplex.objValue * (isMin ? 1 : -1);
+		basis = revisedSimplex.getBasis();
+		if (useReducedCostFixing()) reducedCosts = revisedSimplex.getReducedCosts();
+	}
+	
+	void handleInfeasible() { // 處理無解的情況
+		solutionType = Type::INFEASIBLE;
+		extremum = FP64_NAN;
+	}
+	
+	void handleCutoff(double minObjValue) { // [cutoff] LP 最佳值一定比 cutoff 差, 沒有解完就結束
+		solutionType = Type::CUTOFF;
+		extremum = minObjValue * (isMin ? 1 : -1); // 目前已知的界
+	}
+	
+	void handleBound() { // 處理有界的情況
+		solutionType = Type::BOUNDED;
+		
+		solution = vector<double>(varCount, 0); // 空的解向量, 長度為一般變數的數目
+		for (uint32_t j = 0; j < varCount; j++) solution[j] = tableau.getVarValue(j, 0); // [bounded simplex] 非基底變數在下界或上界
+		for (uint32_t i = 1; i < tableau.rows; i++) {
+			uint32_t baseVarIndex = tableau.baseVarIndexs[i];
+			if (baseVarIndex <= varCount - 1) solution[baseVarIndex] = tableau.getVarValue(baseVarIndex, tableau(i, tableau.cols - 1)); // 如果基底變數編號為 0 ~ varCount-1 代表為一般變數
+		} // slack var 編號 >= varCount, 所以不會出現在解向量裡
+		
+		extremum = tableau(0, tableau.cols - 1) * (isMin ? 1 : -1); // 極值
+		if (useReducedCostFixing()) computeReducedCosts();
+	}
+	
+	void computeReducedCosts() { // [reduced cost fixing] 第零列是 -reduced cost (對 tableau 內的變數 x'), 換回原座標 x 的 reduced cost
+		vector<uint8_t> isBaseCol(tableau.cols - 1, 0);
+		for (uint32_t i = 1; i < tableau.rows; i++) if (tableau.baseVarIndexs[i] >= 0) isBaseCol[tableau.baseVarIndexs[i]] = 1;
+		reducedCosts.assign(varCount, 0);
+		for (uint32_t j = 0; j < varCount; j++) if (!isBaseCol[j]) reducedCosts[j] = -tableau(0, j) * (tableau.isComplemented[j] ? -1 : 1); // 翻轉的變數在上界
+		for (const Tableau::BoundRow& boundRow: tableau.boundRows) if (!isBaseCol[boundRow.slackVarColIndex]) { // bound 列的 slack var 非基底, x_j 停在這個界上
+			const double slackReducedCost = -tableau(0, boundRow.slackVarColIndex);
+			reducedCosts[boundRow.varIndex] = boundRow.isUpper ? -slackReducedCost : slackReducedCost; // 上界: s = bound - x ; 下界: s = x - bound
+		}
+	}
+
+public:
+	enum class Type { BOUNDED, UNBOUNDED, INFEASIBLE, CUTOFF }; // 有界, 無界, 無解, 提早結束 (最佳值一定比 cutoff 差)
+	
+	Type solutionType; // 解的狀態
+	vector<double> solution; // 解向量, 若無解會是空的
+	vector<double> reducedCosts; // [reduced cost fixing] 只在 useReducedCostFixing() 且 BOUNDED 時有值, 每個一般變數的 reduced cost (min 化的目標函數)
+	vector<double> unboundedDirection; // 若無界, 此值會是一個方向向量, 即使往無窮遠移動仍然滿足目標函數
+	double extremum; // min/max 極值
+	
+	using TableauPtr = shared_ptr<const Tableau>; // [warm start] 左右子節點共用父節點的最佳 tableau (唯讀)
+	using BasisPtr = shared_ptr<const RevisedSimplex::Basis>; // [warm start] revised simplex 引擎只需要保存基底
+	
+	LP(bool isMin, const SparseModel& model, vector<pair<double, double>>& varRange, double cutoff = FP64_INF, LPEngine engine = lpEngine) // engine: 預設用全域設定的引擎
+	: isMin(isMin), cutoff(cutoff), model(model) {
+		varCount = varRange.size();
+		if (engine == LPEngine::REVISED) solveRevised(varRange, nullptr);
+		else solveColdStart(varRange);
+	}
+	
+	LP(bool isMin, const SparseModel& model, vector<pair<double, double>>& varRange,
+		const RevisedSimplex::Basis& parentBasis, double cutoff = FP64_INF) // [revised simplex][warm start] 從父節點的最佳基底出發, 用 dual simplex 重新最佳化
+	: isMin(isMin), cutoff(cutoff), model(model) {
+		varCount = varRange.size();
+		solveRevised(varRange, &parentBasis);
+	}
+	
+	LP(bool isMin, const SparseModel& model, vector<pair<double, double>>& varRange,
+		const Tableau& parentTableau, double cutoff = FP64_INF) // [warm start] 從父節點的最佳 tableau 出發, 只加入/收緊改變的變數範圍, 再用 dual simplex 重新最佳化
+	: tableau(parentTableau), isMin(isMin), cutoff(cutoff), model(model) { // 和成員宣告的順序相同 (tableau 在前)
+		varCount = varRange.size();
+		
+		if (enableBoundedSimplex) { // [bounded simplex] 直接修改變數範圍, tableau 大小不變
+			for (uint32_t j = 0; j < varCount; j++) {
+				auto [varMin, varMax] = varRange[j];
+				if (varMin != tableau.varLower[j] || varMax - varMin != tableau.varWidth[j]) applyVarRangeToTableau(j, varMin, varMax);
+			}
+		} else { // 父節點 tableau 內的變數範圍由 bound 列表示 (沒有 bound 列代表 [0, inf]), 只處理改變的部分
+			vector<pair<double, double>> parentVarRange(varCount, { 0, FP64_INF });
+			for (const Tableau::BoundRow& boundRow: tableau.boundRows) {
+				(boundRow.isUpper ? parentVarRange[boundRow.varIndex].second : parentVarRange[boundRow.varIndex].first) = boundRow.bound;
+			}
+			for (uint32_t j = 0; j < varCount; j++) {
+				auto [varMin, varMax] = varRange[j];
+				if (varMax != parentVarRange[j].second) applyBoundToTableau(j, true, varMax); // 上界變小 (左子節點)
+				if (varMin != parentVarRange[j].first) applyBoundToTableau(j, false, varMin); // 下界變大 (右子節點)
+			}
+		}
+		
+		DualResult dualResult = isTableauDualFeasible() ? runDualSimplexMethod() : DualResult::STALLED;
+		if (dualResult == DualResult::STALLED) { // 數值不穩 (或範圍放寬造成 dual 不可行), 放棄 warm start, 重新從頭解
+			tableau = Tableau();
+			solveColdStart(varRange);
+		} else if (dualResult == DualResult::INFEASIBLE) {
+			handleInfeasible();
+		} else if (dualResult == DualResult::CUTOFF) {
+			handleCutoff(tableau(0, tableau.cols - 1));
+		} else if (runMinSimplexMethod()) { // primal 可行, 再跑一次 primal simplex 清掉誤差造成的正 reduced cost
+			handleBound();
+		}
+	}
+	
+	bool hasBasis() const { // [revised simplex] 這個 LP 是否由 revised simplex 解出 (只有基底沒有 tableau), 數值不穩退回 tableau 引擎時為 false
+		return !basis.baseColIndexs.empty();
+	}
+	
+	TableauPtr exportTableau() { // [warm start] 將最佳 tableau 移交給 node 保存, 之後這個 LP 不能再使用 tableau
+		return make_shared<const Tableau>(move(tableau));
+	}
+	
+	BasisPtr exportBasis() { // [revised simplex][warm start] 將最佳基底移交給 node 保存
+		return make_shared<const RevisedSimplex::Basis>(move(basis));
+	}
+	
+	vector<Constraint> getGomoryCuts(uint32_t maxCutCount) { // [cutting plane] 從最佳 tableau 的列讀出 Gomory mixed-integer cut (換回原本變數的 >= 約束). 只在 LP 是 min 問題, 用 tableau 解完, 而且變數範圍都是整數時有意義
+		vector<Constraint> cuts;
+		if (solutionType != Type::BOUNDED || tableau.baseVarIndexs.empty()) return cuts; // revised simplex 引擎沒有 tableau
+		const uint32_t colCount = tableau.cols - 1;
+		
+		// tableau 的每一行是哪一種變數: 一般變數 (0 ~ varCount-1), 約束的 slack var, bound 列的 slack var
+		vector<int32_t> slackRowIndexs(colCount, -1), boundRowIndexs(colCount, -1);
+		for (uint32_t i = 0, j = varCount; i < model.rowCount; i++) if (model.haveSlackVar(i)) slackRowIndexs[j++] = i;
+		for (uint32_t b = 0; b < tableau.boundRows.size(); b++) boundRowIndexs[tableau.boundRows[b].slackVarColIndex] = b;
+		
+		vector<uint8_t> isIntCol(colCount, 0), isBaseCol(colCount, 0);
+		for (uint32_t j = 0; j < colCount; j++) {
+			if (j < varCount) isIntCol[j] = FOP::isInt(tableau.varLower[j]) && (isinf(tableau.varWidth[j]) || FOP::isInt(tableau.varWidth[j]));
+			else if (boundRowIndexs[j] >= 0) isIntCol[j] = FOP::isInt(tableau.boundRows[boundRowIndexs[j]].bound);
+			else if (slackRowIndexs[j] >= 0) { // 係數和右側常數都是整數的約束, slack var 也一定是整數
+				const uint32_t i = slackRowIndexs[j];
+				isIntCol[j] = FOP::isInt(model.rightConsts[i]);
+				for (uint32_t p = model.rowStart[i]; p < model.rowStart[i + 1]; p++) if (!FOP::isInt(model.rowCoefs[p])) isIntCol[j] = 0;
+			}
+		}
+		for (uint32_t i = 1; i < tableau.rows; i++) if (tableau.baseVarIndexs[i] >= 0) isBaseCol[tableau.baseVarIndexs[i]] = 1;
+		
+		vector<pair<double, uint32_t>> sourceRows; // 基底是整數變數, 但值的小數部分離整數夠遠的列, 越接近 .5 越先使用
+		for (uint32_t i = 1; i < tableau.rows; i++) {
+			const int32_t baseVarIndex = tableau.baseVarIndexs[i];
+			if (baseVarIndex < 0 || !isIntCol[baseVarIndex]) continue;
+			const double value = tableau(i, tableau.cols - 1), f0 = value - floor(value);
+			if (f0 < 0.01 || f0 > 0.99) continue;
+			sourceRows.push_back({ abs(f0 - 0.5), i });
+		}
+		sort(sourceRows.begin(), sourceRows.end());
+		
+		for (auto& [_, i]: sourceRows) {
+			if (cuts.size() >= maxCutCount) break;
+			const double value = tableau(i, tableau.cols - 1), f0 = value - floor(value);
+			vector<double> cutCoefs(varCount, 0); // 原本變數的係數 pi, cut 為 pi x >= pi0
+			double cutConst = 1;
+			bool isValid = true;
+			for (uint32_t j = 0; j < colCount && isValid; j++) {
+				const double a = tableau(i, j);
+				if (isBaseCol[j] || abs(a) < 1e-9) continue;
+				double g; // tableau 內的非基底變數 t_j >= 0 在 cut sum g_j t_j >= 1 裡的係數
+				if (isIntCol[j]) {
+					const double f = a - floor(a);
+					g = f <= f0 ? f / f0 : (1 - f) / (1 - f0);
+				} else g = a >= 0 ? a / f0 : -a / (1 - f0);
+				if (g == 0) continue;
+				
+				if (j < varCount) { // t = x - lower 或 (翻轉) lower + width - x
+					if (isinf(tableau.varWidth[j]) && tableau.isComplemented[j]) isValid = false;
+					else if (tableau.isComplemented[j]) cutCoefs[j] -= g, cutConst -= g * (tableau.varLower[j] + tableau.varWidth[j]);
+					else cutCoefs[j] += g, cutConst += g * tableau.varLower[j];
+				} else if (boundRowIndexs[j] >= 0) { // 上界: s = bound - x ; 下界: s = x - bound
+					const Tableau::BoundRow& boundRow = tableau.boundRows[boundRowIndexs[j]];
+					const double sign = boundRow.isUpper ? -1 : 1;
+					cutCoefs[boundRow.varIndex] += sign * g;
+					cutConst += sign * g * boundRow.bound;
+				} else if (slackRowIndexs[j] >= 0) { // <=: s = b - ax ; >=: s = ax - b
+					const uint32_t r = slackRowIndexs[j];
+					const double sign = model.relations[r] == Relation::LEQ ? -1 : 1;
+					for (uint32_t p = model.rowStart[r]; p < model.rowStart[r + 1]; p++) cutCoefs[model.rowColIndexs[p]] += sign * g * model.rowCoefs[p];
+					cutConst += sign * g * model.rightConsts[r];
+				} else isValid = false;
+			}
+			if (!isValid) continue;
+			
+			double maxAbsCoef = 0, minAbsCoef = FP64_INF, activity = 0;
+			for (uint32_t j = 0; j < varCount; j++) {
+				if (abs(cutCoefs[j]) < 1e-9) cutCoefs[j] = 0;
+				if (cutCoefs[j] == 0) continue;
+				maxAbsCoef = max(maxAbsCoef, abs(cutCoefs[j]));
+				minAbsCoef = min(minAbsCoef, abs(cutCoefs[j]));
+				activity += cutCoefs[j] * solution[j];
+			}
+			if (maxAbsCoef == 0 || maxAbsCoef > 1e6 * minAbsCoef) continue; // 數值不穩的 cut 不要
+			if (cutConst - activity < 1e-6 * max(1.0, abs(cutConst))) continue; // 沒有切掉目前的 LP 解
+			
+			Constraint cut;
+			for (uint32_t j = 0; j < varCount; j++) if (cutCoefs[j] != 0) cut.add(cutCoefs[j] / maxAbsCoef, j); // 縮放到最大係數為 1
+			cut.geq(cutConst / maxAbsCoef);
+			cut.stdOfNegativeRightConst();
+			cuts.push_back(cut);
+		}
+		return cuts;
+	}
+	
+	void print(bool showCon = false) { // debug
+		if (showCon) {
+			VarBimap bimap; // 因為 IP 已經將字串變數轉為 index 跟 LP 溝通, 所以 LP 抽象層並不知道 varName, 所以這邊註冊一個 x0, x1, x2 (抽象 index)
+			for (uint32_t i = 0; i < varCount; i++) bimap.getVarIndex("x" + to_string(i)); // 註冊 x0, x1, x2, ...
+			
+			printf(isMin ? "min " : "max "); // 印出目標函數
+			model.print(bimap); // 印出目標函數和約束
+			
+			if (varRangeBoundRows.size() == 0) printf("Var range is empty.");
+			for (const Tableau::BoundRow& boundRow: varRangeBoundRows) { // 印出變數範圍
+				printf("%s %s %.2f; ", bimap.getVarName(boundRow.varIndex).c_str(), boundRow.isUpper ? "<=" : ">=", boundRow.bound);
+			}
+			printf("\n");
+		}
+		
+		printf("Type: "); // 印出 LP 的解的類型
+		if (solutionType == Type::BOUNDED) printf("Bounded\n");
+		else if (solutionType == Type::UNBOUNDED) printf("Unbounded\n");
+		else if (solutionType == Type::INFEASIBLE) printf("Infeasible\n");
+		else if (solutionType == Type::CUTOFF) printf("Cutoff\n");
+		
+		printf(isMin ? "LP Minimum = " : "LP Maximum = "); // 印出極值
+		printf("%.2f\n", extremum);
+		
+		printf("LP Solution: "); // 印出解向量
+		for (size_t i = 0; i < solution.size(); i++) printf("x%d = %.2f; ", (int)i, solution[i]);
+		printf("\n");
+		
+		if (unboundedDirection.size() > 0) { // 如果無界, 印出方向向量
+			printf("Unbounded delta: ");
+			for (size_t i = 0; i < unboundedDirection.size(); i++) printf("x%d = %.2f; ", (int)i, unboundedDirection[i]);
+			printf("\n");
+		}
+	}
+};
+
+class Incumbent { // [atomic incumbent] 全域最佳 IP 解. 目標值放在 atomic double 給 worker wait-free 讀取, 解向量以 shared_ptr 整份替換 (CAS)
+public:
+	struct Entry { // 一份發佈後就不再修改的解
+		double objValue;
+		vector<double> solution;
+	};
+	
+	function<void()> onUpdate; // [anytime] 發佈新的解之後呼叫 (可能從任何 thread), 不會被複製, IP 每次 solve 重新設定
+	
+	Incumbent() = default;
+	Incumbent(const Incumbent& other): objValue(other.getObjValue()), entry(other.get()) {} // IP 需要可以複製 (build_supply_chain_ip 回傳值)
+	Incumbent(Incumbent&& other) noexcept: objValue(other.getObjValue()), entry(other.get()) {} // [batch] noexcept, vector<IP> 擴充時才會用 move 而不是 copy
+	Incumbent& operator=(const Incumbent& other) {
+		objValue = other.getObjValue();
+		atomic_store(&entry, other.get());
+		return *this;
+	}
+	
+	double getObjValue() const { // 目前的全域上界, 沒有解時為 inf
+		return objValue.load(memory_order_acquire);
+	}
+	
+	shared_ptr<const Entry> get() const { // 目前的解, 沒有解時為 nullptr
+		return atomic_load(&entry);
+	}
+	
+	bool tryUpdate(double newObjValue, const vector<double>& solution) { // 若比目前的解更好就發佈, 回傳是否成功
+		if (newObjValue >= getObjValue()) return false; // 大部分情況在這裡就結束, 不用配置記憶體
+		
+		shared_ptr<const Entry> newEntry = make_shared<const Entry>(Entry{ newObjValue, solution });
+		shared_ptr<const Entry> oldEntry = get();
+		do {
+			if (oldEntry != nullptr && oldEntry->objValue <= newObjValue) return false; // 別的 thread 搶先發佈了更好的解
+		} while (!atomic_compare_exchange_weak(&entry, &oldEntry, newEntry));
+		
+		double oldObjValue = getObjValue(); // 解向量換成功後才降低目標值 (單調遞減), 讀到的上界一定有對應的解
+		while (newObjValue < oldObjValue && !objValue.compare_exchange_weak(oldObjValue, newObjValue, memory_order_acq_rel));
+		if (onUpdate) onUpdate();
+		return true;
+	}
+
+private:
+	atomic<double> objValue{ FP64_INF };
+	shared_ptr<const Entry> entry; // 只透過 atomic_load/atomic_store/atomic_compare_exchange 存取
+};
+
+class Bytes { // [spill][MPI] 依序把 POD 值和 vector 寫進 byte buffer, 再用同樣的順序讀出來. 只接受 trivially copyable 的型別, pair 之類的要拆成欄位寫
+public:
+	template <typename T>
+	static void write(vector<char>& buffer, const T& value) {
+		static_assert(is_trivially_copyable_v<T>, "Bytes::write needs a trivially copyable type");
+		const char* bytes = reinterpret_cast<const char*>(&value);
+		buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+	}
+	
+	template <typename T>
+	static void writeVector(vector<char>& buffer, const vector<T>& values) {
+		static_assert(is_trivially_copyable_v<T>, "Bytes::writeVector needs a trivially copyable type");
+		write(buffer, (uint32_t)values.size());
+		const char* bytes = reinterpret_cast<const char*>(values.data());
+		buffer.insert(buffer.end(), bytes, bytes + values.size() * sizeof(T));
+	}
+	
+	template <typename T>
+	static T read(const char*& ptr) {
+		static_assert(is_trivially_copyable_v<T>, "Bytes::read needs a trivially copyable type");
+		T value;
+		memcpy(&value, ptr, sizeof(T));
+		ptr += sizeof(T);
+		return value;
+	}
+	
+	template <typename T>
+	static vector<T> readVector(const char*& ptr) {
+		static_assert(is_trivially_copyable_v<T>, "Bytes::readVector needs a trivially copyable type");
+		vector<T> values(read<uint32_t>(ptr));
+		memcpy(values.data(), ptr, values.size() * sizeof(T));
+		ptr += values.size() * sizeof(T);
+		return values;
+	}
+};
+
+struct ModelView { // [model file] 唯讀的模型 (目標函數, CSR 約束矩陣, 變數範圍, 整數性), 陣列指向 ModelData 的 vector 或 mmap 的檔案, IP::fromModel 直接從這裡建模不另外複製
+	bool isMin = true;
+	uint32_t varCount = 0;
+	uint32_t rowCount = 0;
+	double objConst = 0; // 目標函數的常數項
+	const double* objCoefs = nullptr; // [varCount]
+	const double* lower = nullptr; // [varCount] 變數下界, 可以是 -inf
+	const double* upper = nullptr; // [varCount] 變數上界, 可以是 inf
+	const uint8_t* isInteger = nullptr; // [varCount]
+	const int32_t* priorities = nullptr; // [varCount] 分支優先權
+	const uint64_t* rowStart = nullptr; // [rowCount + 1] 第 i 列的非零元素為 [rowStart[i], rowStart[i+1])
+	const uint32_t* colIndexs = nullptr; // [nonzero]
+	const double* coefs = nullptr; // [nonzero]
+	const uint8_t* relations = nullptr; // [rowCount] Relation
+	const double* rightConsts = nullptr; // [rowCount]
+	function<string(uint32_t)> varName; // 變數名稱, 只在需要時呼叫
+
+	uint64_t getNonzeroCount() const {
+		return rowStart[rowCount];
+	}
+};
+
+class ModelData { // [model file] 可修改的模型, MPS/LP reader 和 IP::exportModel 的輸出
+public:
+	bool isMin = true;
+	double objConst = 0;
+	vector<string> varNames;
+	vector<double> objCoefs;
+	vector<double> lower;
+	vector<double> upper;
+	vector<uint8_t> isInteger;
+	vector<int32_t> priorities;
+	vector<uint64_t> rowStart = { 0 };
+	vector<uint32_t> colIndexs;
+	vector<double> coefs;
+	vector<uint8_t> relations;
+	vector<double> rightConsts;
+
+	uint32_t getVarCount() const {
+		return varNames.size();
+	}
+
+	uint32_t addVar(const string& name, bool isInteger = false) { // 新增一個變數, 預設範圍 [0, inf]
+		varNames.push_back(name);
+		objCoefs.push_back(0);
+		lower.push_back(0);
+		upper.push_back(FP64_INF);
+		this->isInteger.push_back(isInteger);
+		priorities.push_back(0);
+		return varNames.size() - 1;
+	}
+
+	void addRow(const vector<pair<uint32_t, double>>& terms, Relation relation, double rightConst) {
+		for (auto& [varIndex, coef]: terms) {
+			colIndexs.push_back(varIndex);
+			coefs.push_back(coef);
+		}
+		rowStart.push_back(colIndexs.size());
+		relations.push_back((uint8_t)relation);
+		rightConsts.push_back(rightConst);
+	}
+
+	ModelView view() const { // 名稱函數參照這個 ModelData, 只在它存在時有效
+		ModelView view;
+		view.isMin = isMin;
+		view.varCount = getVarCount();
+		view.rowCount = relations.size();
+		view.objConst = objConst;
+		view.objCoefs = objCoefs.data();
+		view.lower = lower.data();
+		view.upper = upper.data();
+		view.isInteger = isInteger.data();
+		view.priorities = priorities.data();
+		view.rowStart = rowStart.data();
+		view.colIndexs = colIndexs.data();
+		view.coefs = coefs.data();
+		view.relations = relations.data();
+		view.rightConsts = rightConsts.data();
+		view.varName = [this](uint32_t j) { return varNames[j]; };
+		return view;
+	}
+};
+
+class ModelFile { // [model file] 二進位模型檔 (mmap 載入), MPS 和 LP 檔的讀寫
+private:
+	static constexpr char BINARY_MAGIC[8] = { 'P', 'P', 'I', 'P', 'M', 'D', 'L', '\0' };
+	static constexpr uint32_t BINARY_VERSION = 1;
+
+	struct BinaryHeader { // 二進位檔的開頭, 之後的陣列都從 8 的倍數位置開始 (host byte order)
+		char magic[8];
+		uint32_t version;
+		uint32_t isMin;
+		uint32_t varCount;
+		uint32_t rowCount;
+		uint64_t nonzeroCount;
+		uint64_t nameBytes; // 所有名稱的總長度 (不含結尾字元)
+		double objConst;
+	};
+
+	struct BinaryLayout { // 每個陣列在檔案內的位置 (bytes), 寫入和讀取共用
+		uint64_t objCoefs, lower, upper, rightConsts, rowStart, nameStart, coefs, colIndexs, priorities, isInteger, relations, names, end;
+
+		explicit BinaryLayout(const BinaryHeader& header) {
+			const uint64_t n = header.varCount, m = header.rowCount, nonzero = header.nonzeroCount;
+			uint64_t offset = sizeof(BinaryHeader);
+			auto next = [&](uint64_t bytes) { // 從目前位置放一個陣列, 下一個陣列對齊 8 bytes
+				const uint64_t start = offset;
+				offset = (offset + bytes + 7) / 8 * 8;
+				return start;
+			};
+			objCoefs = next(n * sizeof(double));
+			lower = next(n * sizeof(double));
+			upper = next(n * sizeof(double));
+			rightConsts = next(m * sizeof(double));
+			rowStart = next((m + 1) * sizeof(uint64_t));
+			nameStart = next((n + 1) * sizeof(uint64_t));
+			coefs = next(nonzero * sizeof(double));
+			colIndexs = next(nonzero * sizeof(uint32_t));
+			priorities = next(n * sizeof(int32_t));
+			isInteger = next(n);
+			relations = next(m);
+			names = next(header.nameBytes);
+			end = offset;
+		}
+	};
+
+	static vector<string> splitFields(const char* line) { // MPS 的一行用空白分開
+		vector<string> fields;
+		const char* p = line;
+		while (*p != '\0') {
+			while (*p != '\0' && isspace((unsigned char)*p)) p++;
+			const char* start = p;
+			while (*p != '\0' && !isspace((unsigned char)*p)) p++;
+			if (p > start) fields.emplace_back(start, p);
+		}
+		return fields;
+	}
+
+	static string toLower(string s) {
+		for (char& c: s) c = tolower((unsigned char)c);
+		return s;
+	}
+
+public:
+	class Mapping { // 唯讀 mmap 的檔案, 最後一個參照消失時才 munmap (IP 的變數名稱直接讀這裡)
+	public:
+		const char* data = nullptr;
+		size_t size = 0;
+
+		~Mapping() {
+			if (data != nullptr) munmap((void*)data, size);
+		}
+	};
+
+	static shared_ptr<Mapping> mapBinary(const string& path, ModelView& view) { // 將二進位模型檔 mmap 進來, view 的陣列直接指向檔案內容, 失敗回傳 nullptr
+		const int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			printf("Cannot open %s\n", path.c_str());
+			return nullptr;
+		}
+		struct stat fileStat;
+		auto mapping = make_shared<Mapping>();
+		if (fstat(fd, &fileStat) == 0 && fileStat.st_size >= (off_t)sizeof(BinaryHeader)) {
+			void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data != MAP_FAILED) {
+				mapping->data = (const char*)data;
+				mapping->size = fileStat.st_size;
+			}
+		}
+		close(fd); // mmap 之後就不需要 fd
+		if (mapping->data == nullptr) {
+			printf("Cannot map %s\n", path.c_str());
+			return nullptr;
+		}
+
+		BinaryHeader header;
+		memcpy(&header, mapping->data, sizeof(BinaryHeader));
+		if (memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0 || header.version != BINARY_VERSION) {
+			printf("%s is not a model file (version %u)\n", path.c_str(), BINARY_VERSION);
+			return nullptr;
+		}
+		if (header.nonzeroCount > mapping->size || header.nameBytes > mapping->size) { // 先擋掉過大的數量, 避免 BinaryLayout 的位置計算溢位
+			printf("%s is truncated\n", path.c_str());
+			return nullptr;
+		}
+		const BinaryLayout layout(header);
+		if (layout.end > mapping->size) {
+			printf("%s is truncated\n", path.c_str());
+			return nullptr;
+		}
+
+		const char* base = mapping->data;
+		view.isMin = header.isMin;
+		view.varCount = header.varCount;
+		view.rowCount = header.rowCount;
+		view.objConst = header.objConst;
+		view.objCoefs = (const double*)(base + layout.objCoefs);
+		view.lower = (const double*)(base + layout.lower);
+		view.upper = (const double*)(base + layout.upper);
+		view.isInteger = (const uint8_t*)(base + layout.isInteger);
+		view.priorities = (const int32_t*)(base + layout.priorities);
+		view.rowStart = (const uint64_t*)(base + layout.rowStart);
+		view.colIndexs = (const uint32_t*)(base + layout.colIndexs);
+		view.coefs = (const double*)(base + layout.coefs);
+		view.relations = (const uint8_t*)(base + layout.relations);
+		view.rightConsts = (const double*)(base + layout.rightConsts);
+		// 陣列直接指向檔案內容, 之後不會再檢查索引: 損壞的檔案要在這裡擋下, 不然讀模型時會越界
+		if (view.rowStart[0] != 0 || view.rowStart[header.rowCount] != header.nonzeroCount) {
+			printf("%s has an inconsistent row index\n", path.c_str());
+			return nullptr;
+		}
+		for (uint32_t i = 0; i < header.rowCount; i++) {
+			if (view.rowStart[i] > view.rowStart[i + 1]) {
+				printf("%s has a decreasing row index at row %u\n", path.c_str(), i);
+				return nullptr;
+			}
+			if (view.relations[i] > (uint8_t)Relation::GEQ) {
+				printf("%s has an invalid relation code %u at row %u\n", path.c_str(), view.relations[i], i);
+				return nullptr;
+			}
+		}
+		for (uint64_t p = 0; p < header.nonzeroCount; p++) {
+			if (view.colIndexs[p] >= header.varCount) {
+				printf("%s has an out-of-range column index %u\n", path.c_str(), view.colIndexs[p]);
+				return nullptr;
+			}
+		}
+		const uint64_t* nameStart = (const uint64_t*)(base + layout.nameStart);
+		if (nameStart[0] != 0 || nameStart[header.varCount] != header.nameBytes) {
+			printf("%s has an inconsistent name index\n", path.c_str());
+			return nullptr;
+		}
+		for (uint32_t j = 0; j < header.varCount; j++) {
+			if (nameStart[j] > nameStart[j + 1]) {
+				printf("%s has a decreasing name index at variable %u\n", path.c_str(), j);
+				return nullptr;
+			}
+		}
+		const char* names = base + layout.names;
+		view.varName = [mapping, nameStart, names](uint32_t j) { return string(names + nameStart[j], names + nameStart[j + 1]); }; // 名稱也不複製, 只在印出時才建立字串
+		return mapping;
+	}
+
+	static bool writeBinary(const ModelView& model, const string& path) {
+		vector<string> names(model.varCount);
+		BinaryHeader header;
+		memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+		header.version = BINARY_VERSION;
+		header.isMin = model.isMin;
+		header.varCount = model.varCount;
+		header.rowCount = model.rowCount;
+		header.nonzeroCount = model.getNonzeroCount();
+		header.nameBytes = 0;
+		header.objConst = model.objConst;
+		vector<uint64_t> nameStart(model.varCount + 1, 0);
+		for (uint32_t j = 0; j < model.varCount; j++) {
+			names[j] = model.varName(j);
+			header.nameBytes += names[j].size();
+			nameStart[j + 1] = header.nameBytes;
+		}
+		const BinaryLayout layout(header);
+
+		vector<char> buffer(layout.end, 0);
+		auto put = [&](uint64_t offset, const void* data, size_t bytes) { if (bytes > 0) memcpy(buffer.data() + offset, data, bytes); };
+		put(0, &header, sizeof(BinaryHeader));
+		put(layout.objCoefs, model.objCoefs, model.varCount * sizeof(double));
+		put(layout.lower, model.lower, model.varCount * sizeof(double));
+		put(layout.upper, model.upper, model.varCount * sizeof(double));
+		put(layout.rightConsts, model.rightConsts, model.rowCount * sizeof(double));
+		put(layout.rowStart, model.rowStart, (model.rowCount + 1) * sizeof(uint64_t));
+		put(layout.nameStart, nameStart.data(), nameStart.size() * sizeof(uint64_t));
+		put(layout.coefs, model.coefs, header.nonzeroCount * sizeof(double));
+		put(layout.colIndexs, model.colIndexs, header.nonzeroCount * sizeof(uint32_t));
+		put(layout.priorities, model.priorities, model.varCount * sizeof(int32_t));
+		put(layout.isInteger, model.isInteger, model.varCount);
+		put(layout.relations, model.relations, model.rowCount);
+		for (uint32_t j = 0; j < model.varCount; j++) put(layout.names + nameStart[j], names[j].data(), names[j].size());
+
+		FILE* file = fopen(path.c_str(), "wb");
+		if (file == nullptr || fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+			printf("Cannot write %s\n", path.c_str());
+			if (file != nullptr) fclose(file);
+			return false;
+		}
+		fclose(file);
+		return true;
+	}
+
+	static bool writeMps(const ModelView& model, const string& path) { // free MPS: 名稱不能有空白, 整數變數放在 MARKER 之間, 上界為 inf 的整數變數寫出 PL (有些 reader 的預設上界是 1)
+		FILE* file = fopen(path.c_str(), "w");
+		if (file == nullptr) {
+			printf("Cannot open %s\n", path.c_str());
+			return false;
+		}
+		vector<vector<pair<uint32_t, double>>> colTerms(model.varCount); // COLUMNS 要依照行寫
+		for (uint32_t i = 0; i < model.rowCount; i++) {
+			for (uint64_t p = model.rowStart[i]; p < model.rowStart[i + 1]; p++) colTerms[model.colIndexs[p]].push_back({ i, model.coefs[p] });
+		}
+		const char* rowTypes[] = { "L", "E", "G" }; // 依照 Relation 的順序
+
+		fprintf(file, "NAME          model\nOBJSENSE\n    %s\nROWS\n N  OBJ\n", model.isMin ? "MIN" : "MAX");
+		for (uint32_t i = 0; i < model.rowCount; i++) fprintf(file, " %s  R%u\n", rowTypes[model.relations[i]], i);
+		fprintf(file, "COLUMNS\n");
+		bool isInMarker = false;
+		for (uint32_t j = 0; j < model.varCount; j++) {
+			if ((bool)model.isInteger[j] != isInMarker) {
+				isInMarker = model.isInteger[j];
+				fprintf(file, "    MARKER    'MARKER'    '%s'\n", isInMarker ? "INTORG" : "INTEND");
+			}
+			const string name = model.varName(j);
+			if (model.objCoefs[j] != 0) fprintf(file, "    %s  OBJ  %.17g\n", name.c_str(), model.objCoefs[j]);
+			for (auto& [i, coef]: colTerms[j]) fprintf(file, "    %s  R%u  %.17g\n", name.c_str(), i, coef);
+			if (model.objCoefs[j] == 0 && colTerms[j].empty()) fprintf(file, "    %s  OBJ  0\n", name.c_str()); // 沒有出現的變數也要宣告
+		}
+		if (isInMarker) fprintf(file, "    MARKER    'MARKER'    'INTEND'\n");
+		fprintf(file, "RHS\n");
+		if (model.objConst != 0) fprintf(file, "    RHS  OBJ  %.17g\n", -model.objConst);
+		for (uint32_t i = 0; i < model.rowCount; i++) if (model.rightConsts[i] != 0) fprintf(file, "    RHS  R%u  %.17g\n", i, model.rightConsts[i]);
+		fprintf(file, "BOUNDS\n");
+		for (uint32_t j = 0; j < model.varCount; j++) {
+			const string name = model.varName(j);
+			const double lower = model.lower[j], upper = model.upper[j];
+			if (lower == upper) {
+				fprintf(file, " FX BND  %s  %.17g\n", name.c_str(), lower);
+				continue;
+			}
+			if (lower == -FP64_INF && upper == FP64_INF) {
+				fprintf(file, " FR BND  %s\n", name.c_str());
+				continue;
+			}
+			if (lower == -FP64_INF) fprintf(file, " MI BND  %s\n", name.c_str());
+			else if (lower != 0) fprintf(file, " LO BND  %s  %.17g\n", name.c_str(), lower);
+			if (upper != FP64_INF) fprintf(file, " UP BND  %s  %.17g\n", name.c_str(), upper);
+			else if (model.isInteger[j]) fprintf(file, " PL BND  %s\n", name.c_str());
+		}
+		fprintf(file, "ENDATA\n");
+		fclose(file);
+		return true;
+	}
+
+	static optional<ModelData> readMps(const string& path) { // 一行一行讀 fixed/free MPS (名稱不能有空白), 不支援 RANGES 和 semi-continuous
+		FILE* file = fopen(path.c_str(), "r");
+		if (file == nullptr) {
+			printf("Cannot open %s\n", path.c_str());
+			return nullopt;
+		}
+		ModelData data;
+		unordered_map<string, uint32_t> varIndexs;
+		unordered_map<string, int64_t> rowIndexs; // -1 代表目標函數, -2 代表其他的 N 列 (忽略)
+		vector<vector<pair<uint32_t, double>>> rowTerms;
+		vector<Relation> relations;
+		vector<double> rightConsts;
+		string section, objRowName, error;
+		bool isIntegerMarker = false;
+
+		auto getRow = [&](const string& name, int64_t& rowIndex) {
+			auto it = rowIndexs.find(name);
+			if (it == rowIndexs.end()) error = "unknown row " + name;
+			else rowIndex = it->second;
+			return it != rowIndexs.end();
+		};
+		auto getVar = [&](const string& name, uint32_t& varIndex) {
+			auto it = varIndexs.find(name);
+			if (it == varIndexs.end()) error = "unknown column " + name;
+			else varIndex = it->second;
+			return it != varIndexs.end();
+		};
+
+		char* line = nullptr;
+		size_t lineCapacity = 0;
+		uint64_t lineNumber = 0;
+		while (error.empty() && getline(&line, &lineCapacity, file) != -1) {
+			lineNumber++;
+			if (line[0] == '*') continue; // 註解
+			const vector<string> fields = splitFields(line);
+			if (fields.empty()) continue;
+
+			if (!isspace((unsigned char)line[0])) { // 第一格不是空白的是 section
+				section = fields[0];
+				if (section == "OBJSENSE" && fields.size() > 1) data.isMin = fields[1].rfind("MAX", 0) != 0;
+				else if (section == "ENDATA") break;
+				else if (section == "RANGES" || section == "SOS") error = section + " section is not supported";
+				continue;
+			}
+
+			if (section == "OBJSENSE") data.isMin = fields[0].rfind("MAX", 0) != 0;
+			else if (section == "ROWS" && fields.size() >= 2) {
+				const string& type = fields[0];
+				if (type == "N") {
+					rowIndexs[fields[1]] = objRowName.empty() ? -1 : -2; // 第一個 N 列是目標函數
+					if (objRowName.empty()) objRowName = fields[1];
+					continue;
+				}
+				rowIndexs[fields[1]] = rowTerms.size();
+				rowTerms.emplace_back();
+				relations.push_back(type == "L" ? Relation::LEQ : type == "G" ? Relation::GEQ : Relation::EQ);
+				rightConsts.push_back(0);
+			} else if (section == "COLUMNS") {
+				if (fields.size() >= 3 && fields[1] == "'MARKER'") {
+					isIntegerMarker = fields[2] == "'INTORG'";
+					continue;
+				}
+				uint32_t varIndex;
+				auto it = varIndexs.find(fields[0]);
+				if (it != varIndexs.end()) varIndex = it->second;
+				else varIndex = varIndexs[fields[0]] = data.addVar(fields[0], isIntegerMarker);
+				for (size_t f = 1; f + 1 < fields.size(); f += 2) {
+					int64_t rowIndex;
+					if (!getRow(fields[f], rowIndex)) break;
+					const double value = stod(fields[f + 1]);
+					if (rowIndex == -1) data.objCoefs[varIndex] += value;
+					else if (rowIndex >= 0) rowTerms[rowIndex].push_back({ varIndex, value });
+				}
+			} else if (section == "RHS") {
+				for (size_t f = fields.size() % 2; f + 1 < fields.size(); f += 2) { // 欄位數為奇數時第一個是 RHS 的名稱
+					int64_t rowIndex;
+					if (!getRow(fields[f], rowIndex)) break;
+					const double value = stod(fields[f + 1]);
+					if (rowIndex == -1) data.objConst = -value; // 目標列的 RHS 是常數項的相反數
+					else if (rowIndex >= 0) rightConsts[rowIndex] = value;
+				}
+			} else if (section == "BOUNDS" && fields.size() >= 2) {
+				const string& type = fields[0];
+				const bool haveValue = type == "UP" || type == "LO" || type == "FX" || type == "LI" || type == "UI";
+				const size_t nameField = fields.size() == (haveValue ? 4u : 3u) ? 2 : 1; // 有沒有 bound 的名稱
+				uint32_t varIndex;
+				if (nameField >= fields.size() || !getVar(fields[nameField], varIndex)) {
+					if (error.empty()) error = "bad bound";
+					break;
+				}
+				const double value = haveValue && nameField + 1 < fields.size() ? stod(fields[nameField + 1]) : 0;
+				double& lower = data.lower[varIndex];
+				double& upper = data.upper[varIndex];
+				if (type == "UP" || type == "UI") {
+					upper = value;
+					if (value < 0 && lower == 0) lower = -FP64_INF; // MPS 的慣例: 負的上界讓下界變成 -inf
+				} else if (type == "LO" || type == "LI") lower = value;
+				else if (type == "FX") lower = upper = value;
+				else if (type == "FR") lower = -FP64_INF, upper = FP64_INF;
+				else if (type == "MI") lower = -FP64_INF;
+				else if (type == "PL") upper = FP64_INF;
+				else if (type == "BV") lower = 0, upper = 1;
+				else error = "bound type " + type + " is not supported";
+				if (type == "LI" || type == "UI" || type == "BV") data.isInteger[varIndex] = 1;
+			}
+		}
+		free(line);
+		fclose(file);
+		if (!error.empty()) {
+			printf("%s:%llu: %s\n", path.c_str(), (unsigned long long)lineNumber, error.c_str());
+			return nullopt;
+		}
+		for (size_t i = 0; i < rowTerms.size(); i++) data.addRow(rowTerms[i], relations[i], rightConsts[i]); // MPS 依行給係數, 讀完才能依列寫入 CSR
+		return data;
+	}
+
+	class LpTokenizer { // LP 檔的 token 串流, 一次只讀需要的字元, 保留幾個 token 給 lookahead
+	public:
+		enum class Type { NAME, NUMBER, RELATION, COLON, SIGN, END };
+		struct Token {
+			Type type;
+			string text;
+			double value = 0;
+		};
+
+	private:
+		FILE* file;
+		vector<int> pushback; // 讀過頭的字元 (ungetc 只保證一個)
+		deque<Token> lookahead; // push_back 不會讓之前 peek 拿到的參照失效
+		
+		int getChar() {
+			if (pushback.empty()) return getc(file);
+			const int c = pushback.back();
+			pushback.pop_back();
+			return c;
+		}
+		
+		void ungetChar(int c) {
+			pushback.push_back(c);
+		}
+
+		Token readToken() {
+			int c = getChar();
+			while (c != EOF) { // 跳過空白和註解 (\ 到行尾)
+				if (c == '\\') while (c != EOF && c != '\n') c = getChar();
+				else if (!isspace(c)) break;
+				c = getChar();
+			}
+			if (c == EOF) return { Type::END, "" };
+			if (c == ':') return { Type::COLON, ":" };
+			if (c == '+' || c == '-') return { Type::SIGN, string(1, (char)c) };
+			if (c == '<' || c == '>' || c == '=') { // <, <=, =<, >, >=, =>, =
+				int next = getChar();
+				const bool isPair = next == '=' || (c == '=' && (next == '<' || next == '>'));
+				if (!isPair) ungetChar(next);
+				const char relation = c == '=' && isPair ? (char)next : (char)c;
+				return { Type::RELATION, relation == '<' ? "<=" : relation == '>' ? ">=" : "=" };
+			}
+			string text(1, (char)c);
+			if (isdigit(c) || c == '.') { // 數字: 123, 1.5, .5, 1e-05
+				while (true) {
+					c = getChar();
+					if (isdigit(c) || c == '.') text += (char)c;
+					else if (c == 'e' || c == 'E') {
+						const int sign = getChar();
+						const bool isExponent = isdigit(sign) || ((sign == '+' || sign == '-') && isdigit(peekChar()));
+						ungetChar(sign);
+						if (!isExponent) break;
+						text += (char)c;
+						text += (char)getChar();
+					} else break;
+				}
+				ungetChar(c);
+				return { Type::NUMBER, text, stod(text) };
+			}
+			while (true) { // 名稱: 到空白或運算子為止
+				c = getChar();
+				if (c == EOF || isspace(c) || strchr("\\:+-<>=", c) != nullptr) break;
+				text += (char)c;
+			}
+			ungetChar(c);
+			return { Type::NAME, text };
+		}
+
+		int peekChar() {
+			const int c = getChar();
+			ungetChar(c);
+			return c;
+		}
+
+	public:
+		explicit LpTokenizer(FILE* file): file(file) {}
+
+		const Token& peek(size_t offset = 0) {
+			while (lookahead.size() <= offset) lookahead.push_back(readToken());
+			return lookahead[offset];
+		}
+
+		Token next() {
+			peek();
+			Token token = move(lookahead.front());
+			lookahead.pop_front();
+			return token;
+		}
+	};
+
+	static optional<ModelData> readLp(const string& path) { // CPLEX LP 格式的線性部分: 目標函數, Subject To, Bounds, General, Binary
+		FILE* file = fopen(path.c_str(), "r");
+		if (file == nullptr) {
+			printf("Cannot open %s\n", path.c_str());
+			return nullopt;
+		}
+		using Type = LpTokenizer::Type;
+		LpTokenizer tokens(file);
+		ModelData data;
+		unordered_map<string, uint32_t> varIndexs;
+		string error;
+
+		auto getVar = [&](const string& name) {
+			auto it = varIndexs.find(name);
+			if (it != varIndexs.end()) return it->second;
+			return varIndexs[name] = data.addVar(name);
+		};
+		auto getKeyword = [&]() -> string { // 目前的 token 是 section 關鍵字的話, 讀掉並回傳它的類型
+			const LpTokenizer::Token& token = tokens.peek();
+			if (token.type != Type::NAME || tokens.peek(1).type == Type::COLON) return "";
+			const string word = toLower(token.text);
+			string keyword;
+			if (word == "minimize" || word == "minimum" || word == "min") keyword = "min";
+			else if (word == "maximize" || word == "maximum" || word == "max") keyword = "max";
+			else if (word == "st" || word == "s.t." || word == "st.") keyword = "subject";
+			else if ((word == "subject" && toLower(tokens.peek(1).text) == "to") || (word == "such" && toLower(tokens.peek(1).text) == "that")) {
+				tokens.next();
+				keyword = "subject";
+			} else if (word == "bounds" || word == "bound") keyword = "bounds";
+			else if (word == "general" || word == "generals" || word == "gen" || word == "integer" || word == "integers") keyword = "general";
+			else if (word == "binary" || word == "binaries" || word == "bin") keyword = "binary";
+			else if (word == "end") keyword = "end";
+			else if (word == "semi-continuous" || word == "semis" || word == "semi" || word == "sos") keyword = "unsupported";
+			if (!keyword.empty()) tokens.next();
+			return keyword;
+		};
+		auto isKeyword = [&]() {
+			const string word = toLower(tokens.peek().text);
+			static const vector<string> words = { "minimize", "minimum", "min", "maximize", "maximum", "max", "st", "s.t.", "st.", "subject", "such",
+				"bounds", "bound", "general", "generals", "gen", "integer", "integers", "binary", "binaries", "bin", "end", "semi-continuous", "semis", "semi", "sos" };
+			return tokens.peek().type == Type::NAME && tokens.peek(1).type != Type::COLON && find(words.begin(), words.end(), word) != words.end();
+		};
+		auto skipLabel = [&]() { // "name:"
+			if (tokens.peek().type == Type::NAME && tokens.peek(1).type == Type::COLON) {
+				tokens.next();
+				tokens.next();
+			}
+		};
+		auto readExpression = [&](vector<pair<uint32_t, double>>& terms, double& constant) { // 讀 [+-] [係數] 變數 的序列, 到關係符號或關鍵字為止
+			double sign = 1;
+			while (true) {
+				const LpTokenizer::Token& token = tokens.peek();
+				if (token.type == Type::SIGN) {
+					if (token.text == "-") sign = -sign;
+					tokens.next();
+				} else if (token.type == Type::NUMBER) {
+					const double coef = sign * tokens.next().value;
+					if (tokens.peek().type == Type::NAME && !isKeyword()) terms.push_back({ getVar(tokens.next().text), coef });
+					else constant += coef;
+					sign = 1;
+				} else if (token.type == Type::NAME && !isKeyword()) {
+					terms.push_back({ getVar(tokens.next().text), sign });
+					sign = 1;
+				} else break;
+			}
+		};
+		auto readValue = [&](double& value) { // [+-] 數字或 inf
+			double sign = 1;
+			while (tokens.peek().type == Type::SIGN) if (tokens.next().text == "-") sign = -sign;
+			const LpTokenizer::Token& token = tokens.peek();
+			const string word = toLower(token.text);
+			if (token.type == Type::NUMBER) value = sign * token.value;
+			else if (token.type == Type::NAME && (word == "inf" || word == "infinity")) value = sign * FP64_INF;
+			else return false;
+			tokens.next();
+			return true;
+		};
+		auto isValueNext = [&]() {
+			size_t offset = 0;
+			while (tokens.peek(offset).type == Type::SIGN) offset++;
+			const LpTokenizer::Token& token = tokens.peek(offset);
+			const string word = toLower(token.text);
+			return token.type == Type::NUMBER || (token.type == Type::NAME && (word == "inf" || word == "infinity"));
+		};
 
-				// 只有 LP_FEASIBLE 才會有左右子區間；先檢查向量是否為空
-				if (!varRangeLeft.empty() && !varRangeRight.empty()) {
-					for (size_t i = 0; i < solution.size(); ++i) {
-						if (varRangeLeft[i].first != varRangeRight[i].first) {
-							printf("Next split: %s = ", bimap.getVarName((uint32_t)i).c_str());
-							printf("[%.2f %.2f] & ", varRangeLeft[i].first, varRangeLeft[i].second);
-							printf("[%.2f %.2f]\n", varRangeRight[i].first, varRangeRight[i].second);
+		string section;
+		while (error.empty()) {
+			const string keyword = getKeyword();
+			if (keyword == "end" || tokens.peek().type == Type::END) break;
+			if (keyword == "unsupported") error = "semi-continuous and SOS sections are not supported";
+			else if (keyword == "min" || keyword == "max") {
+				data.isMin = keyword == "min";
+				skipLabel();
+				vector<pair<uint32_t, double>> terms;
+				double constant = 0;
+				readExpression(terms, constant);
+				for (auto& [j, coef]: terms) data.objCoefs[j] += coef;
+				data.objConst += constant;
+				section = "objective";
+			} else if (!keyword.empty()) section = keyword;
+			else if (section == "subject") {
+				skipLabel();
+				vector<pair<uint32_t, double>> terms;
+				double constant = 0, rightConst;
+				readExpression(terms, constant);
+				if (tokens.peek().type != Type::RELATION) {
+					error = "expected a relation, got '" + tokens.peek().text + "'";
+					break;
+				}
+				const string relation = tokens.next().text;
+				if (!readValue(rightConst)) {
+					error = "expected a number after " + relation;
+					break;
+				}
+				data.addRow(terms, relation == "<=" ? Relation::LEQ : relation == ">=" ? Relation::GEQ : Relation::EQ, rightConst - constant);
+			} else if (section == "bounds") { // x free | x rel v | v rel x [rel v]
+				double value;
+				if (isValueNext()) {
+					readValue(value);
+					const string relation = tokens.peek().type == Type::RELATION ? tokens.next().text : "";
+					if (relation.empty() || tokens.peek().type != Type::NAME) {
+						error = "bad bound";
+						break;
+					}
+					const uint32_t j = getVar(tokens.next().text);
+					if (relation == "<=") data.lower[j] = value;
+					else if (relation == ">=") data.upper[j] = value;
+					else data.lower[j] = data.upper[j] = value;
+					if (tokens.peek().type == Type::RELATION) {
+						const string upperRelation = tokens.next().text;
+						if (!readValue(value)) {
+							error = "bad bound";
+							break;
+						}
+						if (upperRelation == "<=") data.upper[j] = value;
+						else data.lower[j] = value;
+					}
+				} else if (tokens.peek().type == Type::NAME) {
+					const uint32_t j = getVar(tokens.next().text);
+					if (tokens.peek().type == Type::NAME && toLower(tokens.peek().text) == "free") {
+						tokens.next();
+						data.lower[j] = -FP64_INF;
+						data.upper[j] = FP64_INF;
+					} else if (tokens.peek().type == Type::RELATION) {
+						const string relation = tokens.next().text;
+						if (!readValue(value)) {
+							error = "bad bound";
 							break;
 						}
+						if (relation == "<=") data.upper[j] = value;
+						else if (relation == ">=") data.lower[j] = value;
+						else data.lower[j] = data.upper[j] = value;
+					} else error = "bad bound";
+				} else error = "bad bound";
+			} else if (section == "general" || section == "binary") {
+				if (tokens.peek().type != Type::NAME) {
+					error = "expected a variable name";
+					break;
+				}
+				const uint32_t j = getVar(tokens.next().text);
+				data.isInteger[j] = 1;
+				if (section == "binary") data.lower[j] = 0, data.upper[j] = 1;
+			} else error = "unexpected '" + tokens.peek().text + "'";
+		}
+		fclose(file);
+		if (!error.empty()) {
+			printf("%s: %s\n", path.c_str(), error.c_str());
+			return nullopt;
+		}
+		return data;
+	}
+
+	static bool writeSolution(const string& path, double objValue, const vector<double>& solution, const function<string(uint32_t)>& varName) { // Gurobi 的 .sol 格式 (名稱 值), 可以直接和 Gurobi 的解比對
+		FILE* file = fopen(path.c_str(), "w");
+		if (file == nullptr) {
+			printf("Cannot open %s\n", path.c_str());
+			return false;
+		}
+		fprintf(file, "# Objective value = %.17g\n", objValue);
+		for (uint32_t j = 0; j < solution.size(); j++) { // IP 只接受純整數模型 (fromModel), 每一欄都是整數欄: LP 值帶有浮點誤差 (19.999999999999996, 1.13e-14), 寫檔前取整數 (+ 0.0 把 -0 變成 0)
+			fprintf(file, "%s %.17g\n", varName(j).c_str(), round(solution[j]) + 0.0);
+		}
+		fclose(file);
+		return true;
+	}
+};
+
+class IP { // Integer Programming
+public:
+	struct GapSample { // [stats] 某個時間點的上下界 (原本的 min/max 方向)
+		double timeMs, primalBound, dualBound, gap;
+	};
+	
+	struct Stats { // [stats] 所有 thread 的計數加總, 用來判斷慢在 pivot (LP), 搶鎖/等待 (queue), 還是 node tree 太大
+		uint64_t phase1PivotCount, phase2PivotCount, dualPivotCount;
+		double eliminationMs, insertConMs, queueWaitMs, queueLockMs; // 各 thread 的時間加總, queueWaitMs 包含 queueLockMs (取 node 時)
+		uint64_t nodeSolvedCount, branchedNodeCount, boundPrunedNodeCount, infeasibleNodeCount, integralNodeCount, spilledNodeCount;
+		double elapsedMs, primalBound, dualBound, gap; // 目前的 incumbent 和下界 (solve 中為近似值), 沒有時為 inf
+		bool isSolving;
+		vector<GapSample> gapHistory;
+	};
+	
+	enum class StopReason { COMPLETED, TIME_LIMIT, NODE_LIMIT, GAP_LIMIT }; // [limits] 搜尋完畢 (解是最佳的), 或是因為哪個限制提早停下 (解只是目前最好的)
+	
+	using IncumbentCallback = function<void(double objValue, const vector<double>& solution)>; // [anytime] 新的 incumbent (原本的 min/max 方向和變數編號)
+	
+	struct PortfolioSetting { // [portfolio] 一個賽跑成員的設定
+		BranchingRule branchingRule;
+		NodeSelection nodeSelection;
+		uint32_t divingFrequency; // [heuristic] 0 代表只在 root 做
+		uint32_t tieBreakSeed; // 選進入基底變數時的掃描起點 (lpTieBreakSeed), 0 代表照編號順序
+	};
+
+private:
+	class Brancher;
+	
+	class Node { // branch & bound 的 node
+	public:
+		struct cmp { // priority queue 用的比較子, 會變成以 node 下界排序的 min-heap
+			bool operator()(const Node& a, const Node& b) const { return a.lowerBound > b.lowerBound; }
+		};
+		
+		struct BranchRecord { // [compact node] 分支路徑上的一步: 在父節點的範圍上加一個 x_j <= bound 或 x_j >= bound
+			const BranchRecord* parent; // nullptr 代表 root node
+			uint32_t varIndex;
+			bool isUpper;
+			double bound;
+		};
+		
+		class BranchArena { // [compact node] 每個 thread 自己的 BranchRecord 配置區, 以 chunk 為單位配置, 位址不會移動, IP 解完才一起釋放
+		private:
+			static constexpr uint32_t CHUNK_SIZE = 4096;
+			vector<unique_ptr<BranchRecord[]>> chunks;
+			uint32_t usedCount = CHUNK_SIZE; // 最後一個 chunk 用了幾個
+		
+		public:
+			BranchArena() = default;
+			BranchArena(const BranchArena&) {} // [portfolio] 紀錄只被 solve 中的 node 參考, 複製 IP 時不用帶過去 (init 會重新配置)
+			BranchArena(BranchArena&&) = default;
+			BranchArena& operator=(BranchArena&&) = default;
+			
+			const BranchRecord* add(const BranchRecord& record) {
+				if (usedCount == CHUNK_SIZE) {
+					chunks.push_back(make_unique<BranchRecord[]>(CHUNK_SIZE));
+					usedCount = 0;
+				}
+				BranchRecord* ptr = &chunks.back()[usedCount++];
+				*ptr = record;
+				return ptr;
+			}
+		};
+		
+		enum class Type { IP_FEASIBLE, LP_FEASIBLE, INFEASIBLE, UNBOUNDED, CUTOFF }; // 有 IP 解, 有 LP 解, 無解, 無界 (比較麻煩), LP 沒解完就確定比全域上界差
+		
+		vector<double> solution; // float LP 解, 只有 IP_FEASIBLE 會保留 (其他 node 在 queue 裡不需要)
+		double lowerBound = FP64_NAN; // 節點的 float min LP 下界, int 解只可能更大
+		Type type; // node 的型態
+		const BranchRecord* branch = nullptr; // [compact node] 從 root 到這個 node 的分支路徑, 變數範圍在 pop 出來時才重建
+		int32_t splitVarIndex = -1; // 下一次分支要切分的變數編號
+		double splitValue = 0; // 下一次分支: 左子節點 x_j <= splitValue, 右子節點 x_j >= splitValue + 1
+		double splitFraction = 0; // [branching] 切分變數 LP 解的小數部分, 子節點解完後用來更新 pseudocost
+		LP::TableauPtr tableau; // [warm start] 這個 node 的 LP 最佳 tableau, 給左右子節點熱啟動用
+		LP::BasisPtr basis; // [warm start] revised simplex 引擎的最佳基底
+		vector<pair<uint32_t, double>> reducedCosts; // [reduced cost fixing] 非零的 reduced cost, 分支時用當下的 incumbent 收緊子節點的變數範圍
+		
+		static LP solveLP(const SparseModel& model, vector<pair<double, double>>& varRange, const Node* parent, double cutoff) { // 解 LP (已經將 max 標準化為 min), 有父節點的 tableau/基底就 warm start
+			if (parent != nullptr && parent->tableau != nullptr) return LP(true, model, varRange, *parent->tableau, cutoff);
+			if (parent != nullptr && parent->basis != nullptr) return LP(true, model, varRange, *parent->basis, cutoff);
+			return LP(true, model, varRange, cutoff);
+		}
+		
+		Node(const SparseModel& model, Brancher& brancher, vector<pair<double, double>>& varRange, const BranchRecord* branch = nullptr,
+			const Node* parent = nullptr, double cutoff = FP64_INF): branch(branch) {
+			LP lp = solveLP(model, varRange, parent, cutoff);
+			lowerBound = lp.extremum; // float min LP 的極值
+			
+			if (lp.solutionType == LP::Type::INFEASIBLE) type = Type::INFEASIBLE;
+			else if (lp.solutionType == LP::Type::UNBOUNDED) type = Type::UNBOUNDED;
+			else if (lp.solutionType == LP::Type::CUTOFF) type = Type::CUTOFF; // [cutoff] 直接丟掉
+			else if (lp.solutionType == LP::Type::BOUNDED) {
+				bool isIntegral = true;
+				for (double value: lp.solution) if (!FOP::isInt(value)) isIntegral = false;
+				if (isIntegral) { // 如果基底變數的值全部都是整數 (IP feasible), 更新全域的 int min IP 上界
+					type = Type::IP_FEASIBLE;
+					solution = move(lp.solution); // float LP 解
+				} else { // 如果有基底變數的值是 float, 記錄切分的變數和切分值, 左右子節點的變數範圍在分支時才計算
+					type = Type::LP_FEASIBLE;
+					if (enableWarmStartDualSimplex && lp.hasBasis()) basis = lp.exportBasis(); // 保存最佳基底給子節點熱啟動 (strong branching 也會用到). 依照 LP 實際的解法, [what-if] root 在 tableau 引擎下也是用基底
+					else if (enableWarmStartDualSimplex) tableau = lp.exportTableau(); // 保存最佳 tableau 給子節點熱啟動
+					
+					for (uint32_t j = 0; j < lp.reducedCosts.size(); j++) if (abs(lp.reducedCosts[j]) > FOP::EPS) reducedCosts.push_back({ j, lp.reducedCosts[j] });
+					splitVarIndex = brancher.select(model, *this, lp.solution, varRange, cutoff); // [branching] 下次分支要切分的變數編號
+					splitValue = floor(lp.solution[splitVarIndex]); // 切分值: 直接照 LP 解切 (對半切會嘗試 1000, 999, 998, ...)
+					splitFraction = lp.solution[splitVarIndex] - splitValue;
+				}
+			}
+		}
+		
+		Node(const BranchRecord* branch, Type type): type(type), branch(branch) {} // [propagation] 不用解 LP 就確定型態的 node (bound propagation 發現範圍是空的)
+		
+		vector<pair<double, double>> getVarRange(const vector<pair<double, double>>& rootVarRange) const { // [compact node] 從 root 的範圍沿著分支路徑重建每個變數的範圍. 越深的紀錄越緊, 所以每個界只取第一次遇到的
+			vector<pair<double, double>> varRange(rootVarRange);
+			vector<uint8_t> isSet(varRange.size(), 0); // bit 0: 下界已設定, bit 1: 上界已設定
+			for (const BranchRecord* record = branch; record != nullptr; record = record->parent) {
+				const uint8_t bit = record->isUpper ? 2 : 1;
+				if (isSet[record->varIndex] & bit) continue;
+				isSet[record->varIndex] |= bit;
+				(record->isUpper ? varRange[record->varIndex].second : varRange[record->varIndex].first) = record->bound;
+			}
+			return varRange;
+		}
+		
+		void print(VarBimap bimap, bool showRange = false) {
+			if (type == Type::IP_FEASIBLE) {
+				printf("[IP solution found] Objective value = %.2f\n", lowerBound);
+			} else if (type == Type::INFEASIBLE) {
+				printf("IP solution is infeasible.\n");
+			} else if (type == Type::UNBOUNDED) {
+				printf("LP solution is unbounded, maybe IP solution does not exist.\n");
+			} else if (type == Type::LP_FEASIBLE) {
+				printf("IP feasible objective value >= %.2f\n", lowerBound);
+				printf("Next split: %s = ", bimap.getVarName((uint32_t)splitVarIndex).c_str());
+				printf("[? %.2f] & [%.2f ?]\n", splitValue, splitValue + 1);
+			}
+
+			if (showRange) {
+				printf("Branch path (leaf to root): ");
+				for (const BranchRecord* record = branch; record != nullptr; record = record->parent) {
+					printf("%s %s %.2f; ", bimap.getVarName(record->varIndex).c_str(), record->isUpper ? "<=" : ">=", record->bound);
+				}
+				printf("\n");
+			}
+		}
+	};
+	
+	class Brancher { // [branching] 選擇分支變數: 先看優先權, 再依照分支規則評分. pseudocost 統計由所有 thread 共用 (omp atomic)
+	private:
+		vector<double> pseudocostSum[2]; // [0]: 下分支 (x_j <= floor), [1]: 上分支 (x_j >= ceil). 每單位小數變化的目標值增加量
+		vector<double> pseudocostCount[2];
+		
+		static double atomicLoad(const double& x) {
+			double value;
+			#pragma omp atomic read
+			value = x;
+			return value;
+		}
+		
+		double getPseudocost(uint32_t varIndex, uint32_t dir) const { // 沒有觀察紀錄時用所有變數的平均值, 都沒有時為 1
+			const double count = atomicLoad(pseudocostCount[dir][varIndex]);
+			if (count > 0) return atomicLoad(pseudocostSum[dir][varIndex]) / count;
+			double sum = 0, totalCount = 0;
+			for (uint32_t j = 0; j < pseudocostSum[dir].size(); j++) {
+				sum += atomicLoad(pseudocostSum[dir][j]);
+				totalCount += atomicLoad(pseudocostCount[dir][j]);
+			}
+			return totalCount > 0 ? sum / totalCount : 1;
+		}
+		
+		static double getScore(double downGain, double upGain) { // product rule: 兩邊都要增加才是好的分支
+			return max(downGain, 1e-6) * max(upGain, 1e-6);
+		}
+		
+		double strongBranch(const SparseModel& model, const Node& node, uint32_t varIndex, double value, vector<pair<double, double>>& varRange, double cutoff) { // 實際解兩個子節點的 LP, 回傳分數
+			const pair<double, double> range = varRange[varIndex];
+			const double floorValue = floor(value), fraction = value - floorValue;
+			double gains[2];
+			for (uint32_t dir = 0; dir < 2; dir++) {
+				varRange[varIndex] = dir == 0 ? make_pair(range.first, floorValue) : make_pair(floorValue + 1, range.second);
+				LP lp = Node::solveLP(model, varRange, &node, cutoff);
+				if (lp.solutionType == LP::Type::BOUNDED) {
+					gains[dir] = max(0.0, lp.extremum - node.lowerBound);
+					update(varIndex, dir, gains[dir] / (dir == 0 ? fraction : 1 - fraction));
+				} else gains[dir] = lp.solutionType == LP::Type::UNBOUNDED ? 0 : 1e20; // 無解或被 cutoff 的一邊可以直接剪掉, 非常好
+			}
+			varRange[varIndex] = range;
+			return getScore(gains[0], gains[1]);
+		}
+	
+	public:
+		BranchingRule rule = BranchingRule::FIRST_INDEX;
+		vector<int32_t> priorities; // 每個變數的分支優先權 (預設 0), 只在優先權最高的 fractional 變數中選
+		uint32_t reliabilityThreshold = 4; // [reliability] 兩邊的觀察次數都達到這個值才相信 pseudocost
+		uint32_t strongCandidateLimit = 8; // [strong/reliability] 每個 node 最多用 strong branching 評估幾個候選變數
+		
+		void init(uint32_t varCount) {
+			priorities.resize(varCount, 0);
+			for (uint32_t dir = 0; dir < 2; dir++) {
+				pseudocostSum[dir].assign(varCount, 0);
+				pseudocostCount[dir].assign(varCount, 0);
+			}
+		}
+		
+		uint32_t getVarCount() const { // pseudocost 統計的變數數
+			return pseudocostSum[0].size();
+		}
+		
+		void update(uint32_t varIndex, uint32_t dir, double gainPerUnit) { // 加入一筆 pseudocost 觀察
+			#pragma omp atomic
+			pseudocostSum[dir][varIndex] += gainPerUnit;
+			#pragma omp atomic
+			pseudocostCount[dir][varIndex] += 1;
+		}
+		
+		int32_t select(const SparseModel& model, const Node& node, const vector<double>& solution, vector<pair<double, double>>& varRange, double cutoff) { // 回傳分支變數, solution 至少要有一個非整數. varRange 是 node 的範圍, strong branching 改過的項目會還原
+			vector<uint32_t> candidates; // 優先權最高的 fractional 變數 (依照編號)
+			int32_t maxPriority = numeric_limits<int32_t>::min();
+			for (uint32_t j = 0; j < solution.size(); j++) if (!FOP::isInt(solution[j])) {
+				const int32_t priority = j < priorities.size() ? priorities[j] : 0;
+				if (priority > maxPriority) {
+					maxPriority = priority;
+					candidates.clear();
+				}
+				if (priority == maxPriority) candidates.push_back(j);
+			}
+			if (rule == BranchingRule::FIRST_INDEX) return candidates[0];
+			
+			auto getFraction = [&](uint32_t j) { return solution[j] - floor(solution[j]); };
+			auto getPseudocostScore = [&](uint32_t j) {
+				const double f = getFraction(j);
+				return getScore(getPseudocost(j, 0) * f, getPseudocost(j, 1) * (1 - f));
+			};
+			
+			int32_t bestIndex = candidates[0];
+			double bestScore = -1;
+			if (rule == BranchingRule::MOST_FRACTIONAL || rule == BranchingRule::PSEUDOCOST) {
+				for (uint32_t j: candidates) {
+					const double score = rule == BranchingRule::MOST_FRACTIONAL ? min(getFraction(j), 1 - getFraction(j)) : getPseudocostScore(j);
+					if (score > bestScore) {
+						bestScore = score;
+						bestIndex = j;
+					}
+				}
+				return bestIndex;
+			}
+			
+			// STRONG: 評估最接近 .5 的前幾個候選 ; RELIABILITY: 候選依照 pseudocost 排序, 不可靠的前幾個用 strong branching 評估, 其他直接用 pseudocost
+			vector<pair<double, uint32_t>> rankedCandidates;
+			for (uint32_t j: candidates) {
+				const double f = getFraction(j);
+				rankedCandidates.push_back({ rule == BranchingRule::STRONG ? min(f, 1 - f) : getPseudocostScore(j), j });
+			}
+			sort(rankedCandidates.begin(), rankedCandidates.end(), greater<pair<double, uint32_t>>());
+			uint32_t strongCount = 0;
+			for (auto& [rankScore, j]: rankedCandidates) {
+				const bool isReliable = atomicLoad(pseudocostCount[0][j]) >= reliabilityThreshold && atomicLoad(pseudocostCount[1][j]) >= reliabilityThreshold;
+				double score;
+				if (rule == BranchingRule::RELIABILITY && isReliable) score = rankScore;
+				else if (strongCount < strongCandidateLimit) {
+					score = strongBranch(model, node, j, solution[j], varRange, cutoff);
+					strongCount++;
+				} else if (rule == BranchingRule::STRONG) break; // 其餘候選不評估
+				else score = rankScore;
+				
+				if (score > bestScore) {
+					bestScore = score;
+					bestIndex = j;
+				}
+			}
+			return bestIndex;
+		}
+	};
+	
+	class PrimalHeuristic { // [heuristic] 不分支直接找整數可行解當作 incumbent: simple rounding, fractional diving, feasibility pump
+	private:
+		vector<uint32_t> lockCounts[2]; // [0]: 變數變小可能違反的約束數 (down-lock), [1]: 變數變大可能違反的約束數 (up-lock)
+		vector<pair<double, double>> rootVarRange; // [presolve] root node 的變數範圍
+		
+		static LP solveLP(const SparseModel& model, vector<pair<double, double>>& varRange, const LP::TableauPtr& tableau, const LP::BasisPtr& basis, double cutoff) { // 有上一個 LP 的 tableau/基底就 warm start
+			if (tableau != nullptr) return LP(true, model, varRange, *tableau, cutoff);
+			if (basis != nullptr) return LP(true, model, varRange, *basis, cutoff);
+			return LP(true, model, varRange, cutoff);
+		}
+		
+		static void exportWarmStart(LP& lp, LP::TableauPtr& tableau, LP::BasisPtr& basis) { // 和 Node 相同的規則保存 warm start 資料
+			if (enableWarmStartDualSimplex && lp.hasBasis()) basis = lp.exportBasis();
+			else if (enableWarmStartDualSimplex) tableau = lp.exportTableau();
+		}
+		
+		static double getObjValue(const SparseModel& model, const vector<double>& x) {
+			double objValue = 0;
+			for (uint32_t j = 0; j < model.colCount; j++) objValue += model.objCoefs[j] * x[j];
+			return objValue;
+		}
+		
+		bool isFeasible(const SparseModel& model, const vector<double>& x) const { // 整數解 x 是否滿足所有約束和 root 的變數範圍
+			for (uint32_t j = 0; j < model.colCount; j++) if (x[j] < rootVarRange[j].first || x[j] > rootVarRange[j].second) return false;
+			for (uint32_t i = 0; i < model.rowCount; i++) {
+				double lhs = 0;
+				for (uint32_t p = model.rowStart[i]; p < model.rowStart[i + 1]; p++) lhs += model.rowCoefs[p] * x[model.rowColIndexs[p]];
+				const double rhs = model.rightConsts[i], tolerance = FOP::EPS * max(1.0, abs(rhs));
+				if (model.relations[i] != Relation::GEQ && lhs > rhs + tolerance) return false;
+				if (model.relations[i] != Relation::LEQ && lhs < rhs - tolerance) return false;
+			}
+			return true;
+		}
+		
+		bool tryCandidate(const SparseModel& model, const vector<double>& x, Incumbent& incumbent) const { // 可行就發佈成 incumbent
+			if (!isFeasible(model, x)) return false;
+			return incumbent.tryUpdate(getObjValue(model, x), x);
+		}
+		
+		static int32_t selectDivingVar(const vector<double>& solution, const vector<int32_t>& priorities) { // 優先權最高的 fractional 變數中, 小數部分最接近整數的那個. 沒有 fractional 變數回傳 -1
+			int32_t bestIndex = -1, bestPriority = numeric_limits<int32_t>::min();
+			double bestDistance = 1;
+			for (uint32_t j = 0; j < solution.size(); j++) if (!FOP::isInt(solution[j])) {
+				const int32_t priority = j < priorities.size() ? priorities[j] : 0;
+				const double distance = abs(solution[j] - std::round(solution[j]));
+				if (priority > bestPriority || (priority == bestPriority && distance < bestDistance)) {
+					bestIndex = j;
+					bestPriority = priority;
+					bestDistance = distance;
+				}
+			}
+			return bestIndex;
+		}
+	
+	public:
+		uint32_t divingFrequency = 100; // solve 過程中每處理幾個 node 就從那個 node 做一次 diving, 0 代表只在 root 做
+		uint32_t divingLPLimit = 200; // 一次 diving 最多解幾個 LP
+		uint32_t pumpRoundLimit = 20; // feasibility pump 最多幾輪
+		
+		void init(const SparseModel& model, const vector<pair<double, double>>& rootVarRange) {
+			this->rootVarRange = rootVarRange;
+			for (uint32_t dir = 0; dir < 2; dir++) lockCounts[dir].assign(model.colCount, 0);
+			for (uint32_t i = 0; i < model.rowCount; i++) for (uint32_t p = model.rowStart[i]; p < model.rowStart[i + 1]; p++) {
+				const uint32_t j = model.rowColIndexs[p];
+				const double coef = model.rowCoefs[p];
+				if (model.relations[i] != Relation::GEQ) lockCounts[coef > 0 ? 1 : 0][j]++; // <= 約束: 正係數不能變大, 負係數不能變小
+				if (model.relations[i] != Relation::LEQ) lockCounts[coef > 0 ? 0 : 1][j]++; // >= 約束: 正係數不能變小, 負係數不能變大
+			}
+		}
+		
+		bool round(const SparseModel& model, const vector<double>& solution, Incumbent& incumbent) const { // simple rounding: 每個 fractional 變數往不會違反任何約束的方向取整數
+			vector<double> x(solution.size());
+			for (uint32_t j = 0; j < solution.size(); j++) {
+				if (FOP::isInt(solution[j])) x[j] = std::round(solution[j]);
+				else if (lockCounts[0][j] == 0) x[j] = floor(solution[j]);
+				else if (lockCounts[1][j] == 0) x[j] = ceil(solution[j]);
+				else return false; // 兩個方向都可能違反約束
+			}
+			return tryCandidate(model, x, incumbent);
+		}
+		
+		bool dive(const SparseModel& model, const vector<int32_t>& priorities, vector<pair<double, double>>& varRange,
+			LP::TableauPtr tableau, LP::BasisPtr basis, Incumbent& incumbent) const { // fractional diving: 反覆把一個 fractional 變數往最近的整數收緊並重解 LP (warm start), 無解時回溯一次. varRange 會被收緊, 呼叫者傳自己的副本
+			int32_t lastVarIndex = -1; // 上一步收緊的變數
+			bool isLastUpper = false;
+			double lastValue = 0, lastRangeMin = 0, lastRangeMax = FP64_INF;
+			bool hasBacktracked = false;
+			for (uint32_t lpCount = 0; lpCount < divingLPLimit; lpCount++) {
+				LP lp = solveLP(model, varRange, tableau, basis, incumbent.getObjValue());
+				if (lp.solutionType == LP::Type::INFEASIBLE && lastVarIndex >= 0 && !hasBacktracked) { // 改走另一邊
+					if (isLastUpper) varRange[lastVarIndex] = { floor(lastValue) + 1, lastRangeMax };
+					else varRange[lastVarIndex] = { lastRangeMin, ceil(lastValue) - 1 };
+					hasBacktracked = true;
+					continue;
+				}
+				if (lp.solutionType != LP::Type::BOUNDED) return false; // 無解, 無界, 或不可能比 incumbent 好
+				
+				const int32_t j = selectDivingVar(lp.solution, priorities);
+				if (j < 0) return incumbent.tryUpdate(lp.extremum, lp.solution); // LP 解已經是整數
+				if (round(model, lp.solution, incumbent)) return true;
+				
+				exportWarmStart(lp, tableau, basis);
+				lastVarIndex = j;
+				lastValue = lp.solution[j];
+				isLastUpper = lastValue - floor(lastValue) < 0.5; // 往最近的整數收緊
+				lastRangeMin = varRange[j].first;
+				lastRangeMax = varRange[j].second;
+				if (isLastUpper) varRange[j].second = floor(lastValue);
+				else varRange[j].first = ceil(lastValue);
+			}
+			return false;
+		}
+		
+		bool feasibilityPump(const SparseModel& model, const vector<double>& rootSolution, Incumbent& incumbent) const { // feasibility pump: 在 LP 可行域裡找離取整點 (L1 距離) 最近的點, 交替取整直到距離為 0
+			const uint32_t n = model.colCount, m = model.rowCount;
+			Linearform distance; // min sum d_j, d_j >= |x_j - r_j|
+			vector<Constraint> multiCon(m);
+			for (uint32_t i = 0; i < m; i++) {
+				for (uint32_t p = model.rowStart[i]; p < model.rowStart[i + 1]; p++) multiCon[i].add(model.rowCoefs[p], model.rowColIndexs[p]);
+				if (model.relations[i] == Relation::LEQ) multiCon[i].leq(model.rightConsts[i]);
+				else if (model.relations[i] == Relation::EQ) multiCon[i].eq(model.rightConsts[i]);
+				else multiCon[i].geq(model.rightConsts[i]);
+			}
+			for (uint32_t j = 0; j < n; j++) {
+				distance.add(1, n + j);
+				multiCon.push_back(Constraint().add(1, j).add(-1, n + j).leq(0)); // x_j - d_j <= r_j, 右側常數每輪更新
+				multiCon.push_back(Constraint().add(1, j).add(1, n + j).geq(0)); // x_j + d_j >= r_j
+			}
+			SparseModel pumpModel(distance, multiCon, 2 * n);
+			
+			vector<double> x(rootSolution), rounded(n), lastRounded;
+			for (uint32_t pumpRound = 0; pumpRound < pumpRoundLimit; pumpRound++) {
+				for (uint32_t j = 0; j < n; j++) rounded[j] = clamp(std::round(x[j]), rootVarRange[j].first, rootVarRange[j].second);
+				if (rounded == lastRounded) { // 循環: 翻轉離取整點最遠的幾個變數
+					vector<pair<double, uint32_t>> scores;
+					for (uint32_t j = 0; j < n; j++) if (abs(x[j] - rounded[j]) > FOP::EPS) scores.push_back({ abs(x[j] - rounded[j]), j });
+					sort(scores.begin(), scores.end(), greater<pair<double, uint32_t>>());
+					for (uint32_t t = 0; t < scores.size() && t < 10; t++) {
+						const uint32_t j = scores[t].second;
+						rounded[j] = clamp(rounded[j] + (x[j] > rounded[j] ? 1 : -1), rootVarRange[j].first, rootVarRange[j].second);
+					}
+				}
+				if (tryCandidate(model, rounded, incumbent)) return true;
+				lastRounded = rounded;
+				
+				for (uint32_t j = 0; j < n; j++) pumpModel.rightConsts[m + 2 * j] = pumpModel.rightConsts[m + 2 * j + 1] = rounded[j];
+				vector<pair<double, double>> pumpVarRange(rootVarRange);
+				pumpVarRange.resize(2 * n, { 0, FP64_INF });
+				LP lp(true, pumpModel, pumpVarRange);
+				if (lp.solutionType != LP::Type::BOUNDED) return false;
+				x.assign(lp.solution.begin(), lp.solution.begin() + n);
+				
+				bool isIntegral = true;
+				for (uint32_t j = 0; j < n; j++) if (!FOP::isInt(x[j])) isIntegral = false;
+				if (isIntegral) {
+					for (uint32_t j = 0; j < n; j++) rounded[j] = std::round(x[j]);
+					return tryCandidate(model, rounded, incumbent);
+				}
+			}
+			return false;
+		}
+		
+		void runAtRoot(const SparseModel& model, const vector<int32_t>& priorities, const Node& rootNode, Incumbent& incumbent) const { // root node 解完後依序試 rounding, diving, (都失敗才) feasibility pump
+			vector<pair<double, double>> varRange(rootVarRange);
+			LP lp = solveLP(model, varRange, rootNode.tableau, rootNode.basis, FP64_INF); // 有 tableau/基底時不需要 pivot, 只是要拿回 LP 解
+			if (lp.solutionType != LP::Type::BOUNDED) return;
+			if (round(model, lp.solution, incumbent)) return;
+			dive(model, priorities, varRange, rootNode.tableau, rootNode.basis, incumbent);
+			if (incumbent.get() == nullptr) feasibilityPump(model, lp.solution, incumbent);
+		}
+	};
+	
+	class NodeQueue { // [spill] 以下界排序的 min-heap. 記憶體中的 node 超過預算時, 把下界最大的一半寫成磁碟上的 segment, 記憶體中的 node 用完 (或 segment 裡有更小的下界) 時再整段讀回來
+	private:
+		struct SegmentFile { // segment 檔案, 最後一個參考消失時刪除 (IP 被複製時共用)
+			string path;
+			~SegmentFile() {
+				remove(path.c_str());
+			}
+		};
+		
+		struct Segment {
+			shared_ptr<SegmentFile> file;
+			double minBound; // segment 內最小的下界
+			size_t nodeCount;
+		};
+		
+		vector<Node> heap; // 用 push_heap/pop_heap 維護, 需要直接存取元素才能挑出下界最大的一半
+		vector<Segment> segments;
+		size_t memoryBytes = 0; // 記憶體中 node 的估計大小
+		size_t spilledNodeCount = 0; // segment 內的 node 數
+		
+		static size_t getNodeBytes(const Node& node) { // 估計 node 佔用的記憶體, 共用的 tableau/基底也全部算進去 (保守)
+			size_t bytes = sizeof(Node) + node.solution.capacity() * sizeof(double) + node.reducedCosts.capacity() * sizeof(pair<uint32_t, double>);
+			if (node.tableau != nullptr) bytes += (size_t)node.tableau->rows * node.tableau->cols * sizeof(double);
+			if (node.basis != nullptr) bytes += node.basis->baseColIndexs.size() * sizeof(uint32_t) + node.basis->colStatus.size();
+			return bytes;
+		}
+		
+		static void serialize(vector<char>& buffer, const Node& node) { // 只寫分支需要的資料. 分支路徑只寫指標 (BranchArena 在 solve 結束前不會釋放), tableau 太大不寫 (子節點改從基底或重新解 LP)
+			Bytes::write(buffer, node.lowerBound);
+			Bytes::write(buffer, (uint8_t)node.type);
+			Bytes::write(buffer, (uintptr_t)node.branch);
+			Bytes::write(buffer, node.splitVarIndex);
+			Bytes::write(buffer, node.splitValue);
+			Bytes::write(buffer, node.splitFraction);
+			Bytes::write(buffer, (uint32_t)node.reducedCosts.size()); // pair 不是 trivially copyable, 逐欄位寫
+			for (const auto& [j, reducedCost] : node.reducedCosts) {
+				Bytes::write(buffer, j);
+				Bytes::write(buffer, reducedCost);
+			}
+			Bytes::write(buffer, (uint8_t)(node.basis != nullptr));
+			if (node.basis != nullptr) {
+				Bytes::writeVector(buffer, node.basis->baseColIndexs);
+				Bytes::writeVector(buffer, node.basis->colStatus);
+			}
+		}
+		
+		static Node deserialize(const char*& ptr) {
+			const double lowerBound = Bytes::read<double>(ptr);
+			const Node::Type type = (Node::Type)Bytes::read<uint8_t>(ptr);
+			Node node((const Node::BranchRecord*)Bytes::read<uintptr_t>(ptr), type);
+			node.lowerBound = lowerBound;
+			node.splitVarIndex = Bytes::read<int32_t>(ptr);
+			node.splitValue = Bytes::read<double>(ptr);
+			node.splitFraction = Bytes::read<double>(ptr);
+			node.reducedCosts.resize(Bytes::read<uint32_t>(ptr));
+			for (auto& [j, reducedCost] : node.reducedCosts) {
+				j = Bytes::read<uint32_t>(ptr);
+				reducedCost = Bytes::read<double>(ptr);
+			}
+			if (Bytes::read<uint8_t>(ptr)) {
+				RevisedSimplex::Basis basis;
+				basis.baseColIndexs = Bytes::readVector<uint32_t>(ptr);
+				basis.colStatus = Bytes::readVector<uint8_t>(ptr);
+				node.basis = make_shared<const RevisedSimplex::Basis>(move(basis));
+			}
+			return node;
+		}
+		
+		void spill() { // 把下界最大的一半 node 寫成一個 segment
+			const size_t keepCount = heap.size() / 2;
+			nth_element(heap.begin(), heap.begin() + keepCount, heap.end(), [](const Node& a, const Node& b) { return a.lowerBound < b.lowerBound; });
+			
+			vector<char> buffer;
+			double minBound = FP64_INF;
+			for (size_t c = keepCount; c < heap.size(); c++) {
+				serialize(buffer, heap[c]);
+				minBound = min(minBound, heap[c].lowerBound);
+			}
+			static atomic<uint32_t> segmentId{ 0 };
+			const string path = spillDirectory + "/bnb-" + to_string(getpid()) + "-" + to_string(segmentId++) + ".seg";
+			FILE* file = fopen(path.c_str(), "wb");
+			if (file == nullptr || fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) { // 寫不了就不再 spill, 留在記憶體
+				printf("Cannot write node segment %s, keeping nodes in memory\n", path.c_str());
+				if (file != nullptr) fclose(file);
+				remove(path.c_str());
+				memoryLimit = SIZE_MAX;
+				return;
+			}
+			fclose(file);
+			
+			const size_t nodeCount = heap.size() - keepCount;
+			for (size_t c = keepCount; c < heap.size(); c++) memoryBytes -= getNodeBytes(heap[c]);
+			heap.erase(heap.begin() + keepCount, heap.end());
+			make_heap(heap.begin(), heap.end(), Node::cmp());
+			segments.push_back({ make_shared<SegmentFile>(), minBound, nodeCount });
+			segments.back().file->path = path;
+			spilledNodeCount += nodeCount;
+			solverCounters->add(SolverCounters::SPILLED_NODE, nodeCount); // [stats]
+		}
+		
+		void load(size_t segmentIndex) { // 把一個 segment 讀回記憶體 (不會再觸發 spill, 下一次 push 時才檢查預算)
+			Segment segment = move(segments[segmentIndex]);
+			segments.erase(segments.begin() + segmentIndex);
+			spilledNodeCount -= segment.nodeCount;
+			
+			FILE* file = fopen(segment.file->path.c_str(), "rb");
+			vector<char> buffer;
+			if (file != nullptr) {
+				fseek(file, 0, SEEK_END);
+				buffer.resize(ftell(file));
+				fseek(file, 0, SEEK_SET);
+				if (fread(buffer.data(), 1, buffer.size(), file) != buffer.size()) buffer.clear();
+				fclose(file);
+			}
+			if (buffer.empty()) { // 讀不回來的話這些 node 就遺失了, 結果不再是最佳解
+				printf("Cannot read node segment %s\n", segment.file->path.c_str());
+				lostNodeCount += segment.nodeCount;
+				return;
+			}
+			
+			const char* ptr = buffer.data();
+			for (size_t c = 0; c < segment.nodeCount; c++) {
+				heap.push_back(deserialize(ptr));
+				memoryBytes += getNodeBytes(heap.back());
+				push_heap(heap.begin(), heap.end(), Node::cmp());
+			}
+		}
+		
+		void refill() { // 記憶體中的 node 用完, 或 segment 裡有比 heap 頂端更小的下界時讀回來, 維持 best-first 的順序
+			while (segments.size() > 0) {
+				size_t bestIndex = 0;
+				for (size_t s = 1; s < segments.size(); s++) if (segments[s].minBound < segments[bestIndex].minBound) bestIndex = s;
+				if (heap.size() > 0 && heap.front().lowerBound <= segments[bestIndex].minBound) return;
+				load(bestIndex);
+			}
+		}
+	
+	public:
+		size_t memoryLimit = SIZE_MAX; // 記憶體中 node 的預算 (bytes)
+		string spillDirectory; // segment 檔案的目錄
+		size_t lostNodeCount = 0; // segment 讀取失敗而遺失的 node 數
+		
+		NodeQueue(size_t memoryLimit = SIZE_MAX, const string& spillDirectory = "."): memoryLimit(memoryLimit), spillDirectory(spillDirectory) {}
+		
+		void push(Node node) {
+			memoryBytes += getNodeBytes(node);
+			heap.push_back(move(node));
+			push_heap(heap.begin(), heap.end(), Node::cmp());
+			if (memoryBytes > memoryLimit && heap.size() >= 2) spill();
+		}
+		
+		const Node& top() {
+			refill();
+			return heap.front();
+		}
+		
+		void pop() {
+			refill();
+			pop_heap(heap.begin(), heap.end(), Node::cmp());
+			memoryBytes -= getNodeBytes(heap.back());
+			heap.pop_back();
+		}
+		
+		size_t size() { // 先讀回需要的 segment, 讀取失敗時 node 數會變少, 之後 top/pop 才安全
+			refill();
+			return heap.size() + spilledNodeCount;
+		}
+	};
+	
+	bool isMin; // min = 1, max = 0
+	Linearform objFunc; // 目標函數
+	double objConst = 0; // [model file] 目標函數的常數項 (原本的方向), 不影響求解, 只加到回報的極值和統計
+	vector<Constraint> multiCon; // 多個約束
+	SparseModel model; // [sparse model] 建模完成後 (init) 由 objFunc 和 multiCon 建立, 給所有 node 的 LP 唯讀共用
+	
+	VarBimap bimap; // 變數映射
+	NodeQueue nodeQueue; // 以 float LP 下界排序的 min-heap, 先展開下界較小的 node 比較容易找到更小的解. [spill] 超過記憶體預算時下界大的 node 寫到磁碟
+	Brancher brancher; // [branching] 分支規則和 pseudocost 統計
+	PrimalHeuristic heuristic; // [heuristic] rounding, diving, feasibility pump
+	Presolver presolver; // [presolve] 化簡和 postsolve
+	vector<pair<double, double>> rootVarRange; // [presolve] root node 的變數範圍 (沒有 presolve 時全為 [0, inf])
+	vector<Constraint> cutPool; // [cutting plane] root 加入的 cut (已經在 model 裡, 子節點直接繼承)
+	uint32_t cutRoundLimit = 10; // [cutting plane] 最多幾輪
+	uint32_t cutsPerRound = 20; // [cutting plane] 每輪最多幾個 Gomory cut
+	NodeSelection nodeSelection = NodeSelection::BEST_BOUND; // [node selection] node 選擇策略
+	bool isIncremental = false; // [what-if] 保留 root 的最佳基底和上一次的解, 修改模型後再 solve 會從這些資訊出發
+	LP::BasisPtr rootBasis; // [what-if] 上一次 root LP 的最佳基底 (只有 revised simplex 引擎會保留)
+	vector<uint32_t> pseudocostOriginalIndexs; // [what-if] pseudocost 統計對應的原本變數編號
+	vector<int32_t> branchPriorities; // [branching] 使用者設定的分支優先權 (原本的變數編號), init 時換成化簡後的編號交給 brancher
+	vector<Node::BranchArena> branchArenas; // [compact node] 每個 thread 一個分支紀錄配置區
+	Incumbent incumbent; // [atomic incumbent] 因為是求 min IP 問題, 所以有一個全域上界 (和它的解)
+	
+	uint32_t nodeSolvedCount = 0; // [debug 變數] 計算了幾次 LP 問題
+	uint64_t pivotCount = 0; // [benchmark] 這次 solve 所有 LP (包含 strong branching, heuristic, cut) 的 simplex 迭代數
+	vector<SolverCounters> threadCounters; // [stats] 每個 thread 一份計數器, 只在 resetStats 時重新配置 (和 getStats 互斥)
+	vector<GapSample> gapHistory; // [stats] incumbent 改善或每隔 gapSampleIntervalMs 記錄一次
+	double gapSampleIntervalMs = 100;
+	bool isSolving = false; // [stats] 以下都只在 critical (stats) 內存取
+	double statsObjOffset = 0; // [stats] presolve 的目標常數, 另一個 thread 讀不到 presolver 的一致狀態
+	double lastSampleObjValue = FP64_NAN, lastSampleTimeMs = 0;
+	chrono::steady_clock::time_point solveStartTime, solveEndTime;
+	uint64_t solveStartCycle = 0, solveEndCycle = 0;
+	size_t nodeMemoryLimit = SIZE_MAX; // [spill] 所有 open node 的記憶體預算 (bytes), node-level parallel 時平均分給每個 shard
+	string spillDirectory = "."; // [spill] segment 檔案的目錄
+	double timeLimitMs = FP64_INF; // [limits] 從 solve 開始算的牆鐘時間
+	uint64_t nodeLimit = UINT64_MAX; // [limits] 解過 LP 的 node 數
+	double relativeGapLimit = 0, absoluteGapLimit = 0; // [limits] gap 小於等於其中一個就停下, 0 代表不檢查
+	double stoppedDualBound = FP64_INF; // [limits] 提早停下時的全域下界 (min 問題), 只在 critical (stats) 內存取
+	IncumbentCallback incumbentCallback; // [anytime]
+	double lastReportedObjValue = FP64_INF; // [anytime] 只在 critical (incumbentCallback) 內存取
+	uint32_t tieBreakSeed = 0; // [portfolio] solve 的每個 thread 設定給 lpTieBreakSeed
+	
+	struct Portfolio { // [portfolio] 賽跑成員共用的狀態, 成員的化簡模型都一樣 (同一份模型和 presolve), 解向量可以直接交換
+		Incumbent incumbent; // 所有成員找到的最佳解
+		atomic<bool> isFinished{ false }; // 有成員停下 (證明最佳或碰到限制) 之後, 其他成員也停下
+	};
+	Portfolio* portfolio = nullptr; // [portfolio] 只有賽跑成員不是 nullptr
+	int32_t portfolioWinnerIndex = -1; // [portfolio] 上一次 solvePortfolio 採用哪個成員的結果
+	int64_t lastTimePrintNodeInfo = getSystemTimeSec(); // [debug 變數] 上一次印出 node queue 資訊的時間
+	
+	void init() { // 初始化 IP 問題
+		const vector<double> previousSolution = isIncremental && solutionType == Type::BOUNDED ? solution : vector<double>(); // [what-if] 上一次的解
+		incumbent = Incumbent(); // 可以重複 solve: 清掉上一次的狀態
+		lastReportedObjValue = FP64_INF;
+		if (incumbentCallback || portfolio != nullptr) incumbent.onUpdate = [this]() {
+			if (portfolio != nullptr) publishToPortfolio();
+			if (incumbentCallback) reportIncumbent();
+		};
+		lpTieBreakSeed = tieBreakSeed; // [portfolio] 呼叫的 thread, node-level parallel 的其他 thread 在 runNodeScheduler 設定
+		nodeQueue = NodeQueue(nodeMemoryLimit, spillDirectory);
+		cutPool.clear();
+		solutionType = Type::INFEASIBLE;
+		solution.clear();
+		nodeSolvedCount = 0;
+		
+		Linearform minObjFunc = objFunc; // 將 max 問題轉為 min 問題, 只需要將目標函數變號即可 (objFunc 保持原本的方向, [what-if] 才能直接修改係數)
+		if (!isMin) minObjFunc.negate();
+		
+		model = presolver.run(minObjFunc, multiCon, bimap.getVarCount(), enablePresolve); // 只建立一次, 之後每個 node 都不再複製約束
+		#pragma omp critical (stats)
+		statsObjOffset = presolver.objOffset + (isMin ? objConst : -objConst);
+		if (presolver.isInfeasible) return; // [presolve] 化簡時就發現無解
+		rootVarRange = presolver.varRange; // 沒有 presolve 時, branch & bound 的 root node 的變數範圍全為 [0, inf]
+		if (model.colCount == 0) { // [presolve] 所有變數都被固定了
+			incumbent.tryUpdate(0, {});
+			return;
+		}
+		
+		if (enableCuttingPlanes) separateRootCuts(); // [cutting plane] 模型加上 root 的 cut 之後才建 root node
+		uint32_t varCount = model.colCount; // 化簡後變數的個數
+		vector<pair<double, double>> varRange(rootVarRange);
+		branchArenas.clear();
+		branchArenas.resize(omp_get_max_threads());
+		vector<int32_t> priorities(varCount, 0); // [presolve] 分支優先權換成化簡後的編號
+		vector<uint32_t> originalIndexs(varCount);
+		for (uint32_t j = 0; j < varCount; j++) {
+			originalIndexs[j] = presolver.getOriginalIndex(j);
+			if (originalIndexs[j] < branchPriorities.size()) priorities[j] = branchPriorities[originalIndexs[j]];
+		}
+		if (!isIncremental || originalIndexs != pseudocostOriginalIndexs) brancher.init(varCount); // [what-if] 化簡後的變數都沒變才沿用 pseudocost
+		pseudocostOriginalIndexs = move(originalIndexs);
+		brancher.priorities = move(priorities);
+		if (isIncremental && previousSolution.size() > 0) seedIncumbent(previousSolution);
+		Node rootNode = isIncremental ? createIncrementalRootNode(varRange) : Node(model, brancher, varRange); // root node
+		if (checkNode(rootNode)) { // 檢查 node 的 solution type
+			if (enablePrimalHeuristics) {
+				heuristic.init(model, rootVarRange);
+				heuristic.runAtRoot(model, brancher.priorities, rootNode, incumbent); // [heuristic] 分支前先找一個 incumbent
+			}
+			if (rootNode.lowerBound < incumbent.getObjValue()) nodeQueue.push(move(rootNode));
+			else solverCounters->add(SolverCounters::BOUND_PRUNED_NODE); // [stats] heuristic 找到的解已經和 root 下界一樣好
+		}
+	}
+	
+	void seedIncumbent(const vector<double>& previousSolution) { // [what-if] 上一次的解 (原本的變數編號) 若仍然滿足修改後的約束, 用新的目標函數算目標值當作 incumbent
+		for (const Constraint& con: multiCon) {
+			double activity = 0;
+			for (auto& [j, coef]: con.getTerms()) activity += coef * (j < previousSolution.size() ? previousSolution[j] : 0);
+			const double rightConst = con.getRightConst(), tolerance = FOP::EPS * max(1.0, abs(rightConst));
+			if (con.getRelation() != Relation::GEQ && activity > rightConst + tolerance) return;
+			if (con.getRelation() != Relation::LEQ && activity < rightConst - tolerance) return;
+		}
+		vector<double> reducedSolution(model.colCount); // [presolve] 換成化簡後的編號
+		double objValue = 0;
+		for (uint32_t j = 0; j < model.colCount; j++) {
+			const uint32_t originalIndex = presolver.getOriginalIndex(j);
+			reducedSolution[j] = originalIndex < previousSolution.size() ? previousSolution[originalIndex] : 0;
+			if (reducedSolution[j] < rootVarRange[j].first - FOP::EPS || reducedSolution[j] > rootVarRange[j].second + FOP::EPS) return;
+			objValue += model.objCoefs[j] * reducedSolution[j];
+		}
+		incumbent.tryUpdate(objValue, reducedSolution);
+	}
+	
+	Node createIncrementalRootNode(vector<pair<double, double>>& varRange) { // [what-if] root LP 從上一次的最佳基底出發 (只改目標函數: primal simplex, 改右側常數: dual simplex), 舊解的目標值當作 cutoff
+		if (lpEngine != LPEngine::REVISED) return Node(model, brancher, varRange, nullptr, nullptr, incumbent.getObjValue()); // tableau 的右側常數和第零列都過期了, 只沿用 incumbent 和 pseudocost
+		
+		const bool isBasisUsable = rootBasis != nullptr && rootBasis->baseColIndexs.size() == model.rowCount && rootBasis->colStatus.size() == model.colCount + model.rowCount; // presolve/cut 改變模型大小時只能重新解
+		vector<pair<double, double>> basisVarRange(varRange);
+		LP rootLP = isBasisUsable ? LP(true, model, basisVarRange, *rootBasis) : LP(true, model, basisVarRange); // 不加 cutoff, 基底才是最佳的
+		if (!rootLP.hasBasis() || rootLP.solutionType != LP::Type::BOUNDED) return Node(model, brancher, varRange, nullptr, nullptr, incumbent.getObjValue());
+		rootBasis = rootLP.exportBasis();
+		
+		Node basisNode(nullptr, Node::Type::LP_FEASIBLE); // 只用來把基底交給 root node 熱啟動
+		basisNode.basis = rootBasis;
+		return Node(model, brancher, varRange, nullptr, &basisNode, incumbent.getObjValue());
+	}
+	
+	static vector<Constraint> separateCoverCuts(const SparseModel& model, const vector<pair<double, double>>& varRange, const vector<double>& solution) { // [cutting plane] 只含 0-1 變數且係數 > 0 的 <= 列 (knapsack): 找被 LP 解違反的 cover C, 加入 sum_{C 和係數 >= max_C 的變數} x_j <= |C| - 1 (extended cover)
+		vector<Constraint> cuts;
+		for (uint32_t i = 0; i < model.rowCount; i++) {
+			if (model.relations[i] != Relation::LEQ) continue;
+			bool isKnapsack = true;
+			vector<pair<double, uint32_t>> items; // (1 - x*_j) / a_j, p: 越小越先放進 cover
+			for (uint32_t p = model.rowStart[i]; p < model.rowStart[i + 1] && isKnapsack; p++) {
+				const uint32_t j = model.rowColIndexs[p];
+				if (model.rowCoefs[p] <= 0 || varRange[j].first != 0 || varRange[j].second != 1) isKnapsack = false;
+				else items.push_back({ (1 - solution[j]) / model.rowCoefs[p], p });
+			}
+			if (!isKnapsack || items.size() < 2) continue;
+			sort(items.begin(), items.end());
+			
+			double weight = 0, coverValue = 0, maxCoverCoef = 0;
+			uint32_t coverSize = 0;
+			for (auto& [_, p]: items) {
+				if (weight > model.rightConsts[i] + FOP::EPS) break;
+				weight += model.rowCoefs[p];
+				coverValue += solution[model.rowColIndexs[p]];
+				maxCoverCoef = max(maxCoverCoef, model.rowCoefs[p]);
+				coverSize++;
+			}
+			if (weight <= model.rightConsts[i] + FOP::EPS || coverValue <= coverSize - 1 + FOP::EPS) continue; // 不是 cover, 或沒有被違反
+			
+			Constraint cut;
+			for (uint32_t c = 0; c < items.size(); c++) {
+				const uint32_t p = items[c].second;
+				if (c < coverSize || model.rowCoefs[p] >= maxCoverCoef) cut.add(1, model.rowColIndexs[p]); // [lifting] 係數不小於 cover 內最大係數的變數也可以加進來
+			}
+			cuts.push_back(cut.leq(coverSize - 1));
+		}
+		return cuts;
+	}
+	
+	void separateRootCuts() { // [cutting plane] root LP 解完後加入幾輪 cut, 直到下界停止改善. Gomory cut 要讀 tableau, 所以這幾個 LP 一律用 tableau 引擎解 (不改全域設定, batch 可能有其他 IP 同時在解)
+		double lastBound = -FP64_INF;
+		for (uint32_t round = 0; round < cutRoundLimit; round++) {
+			vector<pair<double, double>> varRange(rootVarRange);
+			LP lp(true, model, varRange, FP64_INF, LPEngine::TABLEAU);
+			if (lp.solutionType != LP::Type::BOUNDED) break;
+			if (lp.extremum - lastBound < 1e-4 * max(1.0, abs(lp.extremum))) break; // 下界停滯
+			lastBound = lp.extremum;
+			
+			vector<Constraint> cuts = lp.getGomoryCuts(cutsPerRound);
+			for (Constraint& cut: separateCoverCuts(model, rootVarRange, lp.solution)) cuts.push_back(cut);
+			if (cuts.empty()) break;
+			model.appendRows(cuts);
+			cutPool.insert(cutPool.end(), cuts.begin(), cuts.end());
+		}
+	}
+	
+	const Node::BranchRecord* fixByReducedCost(const Node& node, vector<pair<double, double>>& varRange, Node::BranchArena& arena) { // [reduced cost fixing] 非基底變數離開界 k 單位會讓目標值至少增加 k |d_j|, 超過 incumbent 的部分可以直接切掉. 收緊的界記錄在分支路徑上給整個子樹用
+		const Node::BranchRecord* branch = node.branch;
+		const double gap = incumbent.getObjValue() - node.lowerBound;
+		if (isinf(gap)) return branch;
+		for (auto& [j, reducedCost]: node.reducedCosts) {
+			auto& [varMin, varMax] = varRange[j];
+			const double steps = floor(gap / abs(reducedCost) + FOP::EPS); // 最多可以離開界幾單位
+			if (reducedCost > 0 && varMin + steps < varMax) { // 停在下界
+				varMax = varMin + steps;
+				branch = arena.add({ branch, j, true, varMax });
+			} else if (reducedCost < 0 && varMax - steps > varMin) { // 停在上界
+				varMin = varMax - steps;
+				branch = arena.add({ branch, j, false, varMin });
+			}
+		}
+		return branch;
+	}
+	
+	bool propagateBounds(vector<pair<double, double>>& varRange) const { // [propagation] 用每一列的活動範圍收緊整數變數的範圍 (例如 W[k] = 0 使 X[*,*,k] = 0), 回傳 false 代表範圍是空的
+		for (uint32_t pass = 0; pass < 3; pass++) {
+			bool isChanged = false;
+			for (uint32_t i = 0; i < model.rowCount; i++) {
+				double minActivity = 0, maxActivity = 0;
+				uint32_t minInfCount = 0, maxInfCount = 0;
+				for (uint32_t p = model.rowStart[i]; p < model.rowStart[i + 1]; p++) {
+					const double coef = model.rowCoefs[p];
+					auto [varMin, varMax] = varRange[model.rowColIndexs[p]];
+					const double low = coef > 0 ? varMin : varMax, high = coef > 0 ? varMax : varMin;
+					if (isinf(low)) minInfCount++; else minActivity += coef * low;
+					if (isinf(high)) maxInfCount++; else maxActivity += coef * high;
+				}
+				const Relation relation = model.relations[i];
+				const double rightConst = model.rightConsts[i], tolerance = FOP::EPS * max(1.0, abs(rightConst));
+				if (relation != Relation::GEQ && minInfCount == 0 && minActivity > rightConst + tolerance) return false;
+				if (relation != Relation::LEQ && maxInfCount == 0 && maxActivity < rightConst - tolerance) return false;
+				
+				for (uint32_t p = model.rowStart[i]; p < model.rowStart[i + 1]; p++) { // sum a_q x_q <= r 時 a_j x_j <= r - (其他項的最小值), >= 同理
+					const double coef = model.rowCoefs[p];
+					auto& [varMin, varMax] = varRange[model.rowColIndexs[p]];
+					const double low = coef > 0 ? varMin : varMax, high = coef > 0 ? varMax : varMin;
+					double newMin = varMin, newMax = varMax;
+					if (relation != Relation::GEQ && (minInfCount == 0 || (minInfCount == 1 && isinf(low)))) {
+						const double value = (rightConst - (minActivity - (isinf(low) ? 0 : coef * low))) / coef;
+						if (coef > 0) newMax = min(newMax, floor(value + FOP::EPS));
+						else newMin = max(newMin, ceil(value - FOP::EPS));
+					}
+					if (relation != Relation::LEQ && (maxInfCount == 0 || (maxInfCount == 1 && isinf(high)))) {
+						const double value = (rightConst - (maxActivity - (isinf(high) ? 0 : coef * high))) / coef;
+						if (coef > 0) newMin = max(newMin, ceil(value - FOP::EPS));
+						else newMax = min(newMax, floor(value + FOP::EPS));
+					}
+					if (newMin > newMax) return false;
+					if (newMin != varMin || newMax != varMax) {
+						varMin = newMin;
+						varMax = newMax;
+						isChanged = true;
 					}
 				}
 			}
-
-			if (showRange && type == Type::LP_FEASIBLE && !varRangeLeft.empty() && !varRangeRight.empty()) {
-				printf("Left child node var range: ");
-				for (size_t vi = 0; vi < varRangeLeft.size(); ++vi) {
-					const auto &rng = varRangeLeft[vi];
-					if (rng.first != 0 || rng.second != FP64_INF) {
-						printf("%s = [%.2f, %.2f]; ", bimap.getVarName((uint32_t)vi).c_str(), rng.first, rng.second);
+			if (!isChanged) break;
+		}
+		return true;
+	}
+	
+	Node createChildNode(vector<pair<double, double>> varRange, const Node::BranchRecord* branch, const Node& parent, Node::BranchArena& arena) { // [propagation] 先收緊變數範圍, 範圍是空的就不用解 LP. 收緊的界記錄在分支路徑上, 子樹不用再從頭傳遞
+		if (enableBoundPropagation && enableRowPropagation) {
+			const vector<pair<double, double>> pathVarRange(varRange);
+			if (!propagateBounds(varRange)) return Node(branch, Node::Type::INFEASIBLE);
+			for (uint32_t j = 0; j < varRange.size(); j++) {
+				if (varRange[j].first > pathVarRange[j].first) branch = arena.add({ branch, j, false, varRange[j].first });
+				if (varRange[j].second < pathVarRange[j].second) branch = arena.add({ branch, j, true, varRange[j].second });
+			}
+		}
+		return Node(model, brancher, varRange, branch, &parent, incumbent.getObjValue());
+	}
+	
+	pair<Node, Node> branchNode(const Node& node, uint32_t threadIndex) { // [compact node] 沿分支路徑重建變數範圍, 生成並計算左右子節點的 LP 問題
+		vector<pair<double, double>> varRange = node.getVarRange(rootVarRange);
+		Node::BranchArena& arena = branchArenas[threadIndex];
+		const Node::BranchRecord* branch = node.branch; // 子節點共用的分支路徑
+		if (useReducedCostFixing()) branch = fixByReducedCost(node, varRange, arena); // 分支路徑已經包含 propagation 收緊的界, 和 node 的 LP 用的範圍相同
+		const uint32_t splitVarIndex = node.splitVarIndex;
+		const double varMax = varRange[splitVarIndex].second;
+		
+		varRange[splitVarIndex].second = node.splitValue; // 左子節點的切分基底值的上界設為 splitValue
+		Node leftChildNode = createChildNode(varRange, arena.add({ branch, splitVarIndex, true, node.splitValue }), node, arena);
+		varRange[splitVarIndex] = { node.splitValue + 1, varMax }; // 右子節點的切分基底值的下界設為 splitValue + 1
+		Node rightChildNode = createChildNode(varRange, arena.add({ branch, splitVarIndex, false, node.splitValue + 1 }), node, arena);
+		
+		if (isFeasibleNodeType(leftChildNode.type)) brancher.update(splitVarIndex, 0, max(0.0, leftChildNode.lowerBound - node.lowerBound) / node.splitFraction); // [branching] 更新 pseudocost
+		if (isFeasibleNodeType(rightChildNode.type)) brancher.update(splitVarIndex, 1, max(0.0, rightChildNode.lowerBound - node.lowerBound) / (1 - node.splitFraction));
+		return { move(leftChildNode), move(rightChildNode) };
+	}
+	
+	static bool isFeasibleNodeType(Node::Type type) { // node 的 LP 有最佳解 (下界有意義)
+		return type == Node::Type::IP_FEASIBLE || type == Node::Type::LP_FEASIBLE;
+	}
+	
+	bool checkNode(Node& node) { // 檢查一個 node 的 solution type, 決定是否要更新全域上界. 回傳 true 代表 node 要繼續分支 (由呼叫者依照 node 選擇策略放入 heap/stack)
+		bool isKept = false;
+		if (node.type == Node::Type::IP_FEASIBLE) {
+			incumbent.tryUpdate(node.lowerBound, node.solution); // [剪枝] 如果 node 有整數解向量, 並且比現有的解更好, 更新全域上界, 不用繼續往下尋找
+		} // [剪枝] 如果 node 有整數解向量, 沒有比現有的解更好, 無視
+		else if (node.type == Node::Type::LP_FEASIBLE && node.lowerBound < incumbent.getObjValue()) { // 如果 node 有浮點解向量
+			isKept = true; // 繼續往下搜尋
+		} // [剪枝] "node 下界 >= 全域上界" 的分支不用繼續往下搜尋, 因為無法取得更好的結果
+		else if (node.type == Node::Type::UNBOUNDED) { // 如果 node 無界
+			solutionType = Type::UNBOUNDED; // 停止計算 IP
+		} // [剪枝] 如果 node 無解或被 cutoff, 無視它
+		
+		nodeSolvedCount++; // 解 LP 式子的次數與 check 次數相同
+		countCheckedNode(node, isKept);
+		
+		return isKept; // [testing] 目前禁用 print node info
+		const int64_t systemTimeNowSec = getSystemTimeSec();
+		if (systemTimeNowSec != lastTimePrintNodeInfo) { // 如果時間戳改變, print 一次 node 資訊
+			lastTimePrintNodeInfo = systemTimeNowSec;
+			printf("[ Node queue size = %d | %d LP nodes solved ]\n", (uint32_t)nodeQueue.size(), nodeSolvedCount);
+		}
+	}
+	
+	bool checkNodeParallel(Node& node) { // [work stealing] checkNode 的平行版本, 不上鎖. 回傳 true 代表 node 要繼續分支
+		#pragma omp atomic
+		nodeSolvedCount++;
+		
+		bool isKept = false;
+		if (node.type == Node::Type::LP_FEASIBLE) isKept = node.lowerBound < incumbent.getObjValue(); // [剪枝] "node 下界 >= 全域上界" 不用繼續往下搜尋
+		else if (node.type == Node::Type::IP_FEASIBLE) incumbent.tryUpdate(node.lowerBound, node.solution); // [atomic incumbent] 發佈新的全域解
+		else if (node.type == Node::Type::UNBOUNDED) {
+			#pragma omp critical (incumbent)
+			solutionType = Type::UNBOUNDED; // 停止計算 IP
+		}
+		countCheckedNode(node, isKept);
+		return isKept;
+	}
+	
+	static void countCheckedNode(const Node& node, bool isKept) { // [stats] 依照 node 的結果分類
+		solverCounters->add(SolverCounters::CHECKED_NODE);
+		if (node.type == Node::Type::IP_FEASIBLE) solverCounters->add(SolverCounters::INTEGRAL_NODE);
+		else if (node.type == Node::Type::INFEASIBLE) solverCounters->add(SolverCounters::INFEASIBLE_NODE);
+		else if ((node.type == Node::Type::LP_FEASIBLE && !isKept) || node.type == Node::Type::CUTOFF) solverCounters->add(SolverCounters::BOUND_PRUNED_NODE);
+	}
+	
+	void resetStats() { // [stats] solve 開始時重新配置計數器
+		#pragma omp critical (stats)
+		{
+			threadCounters = vector<SolverCounters>(max(1, omp_get_max_threads()));
+			gapHistory.clear();
+			solveStartTime = chrono::steady_clock::now();
+			solveStartCycle = readCycleCounter();
+			isSolving = true;
+			statsObjOffset = 0;
+			stopReason = StopReason::COMPLETED;
+			stoppedDualBound = FP64_INF;
+			lastSampleObjValue = FP64_NAN;
+			lastSampleTimeMs = 0;
+		}
+	}
+	
+	void finishStats() {
+		#pragma omp critical (stats)
+		{
+			solveEndTime = chrono::steady_clock::now();
+			solveEndCycle = readCycleCounter();
+			isSolving = false;
+			for (SolverCounters& counters: threadCounters) counters.nodeBound = FP64_INF;
+		}
+		recordGapSample(true);
+	}
+	
+	double toOriginalObjValue(double minObjValue) const { // [stats] min 問題的目標值換回原本的方向
+		return (minObjValue + statsObjOffset) * (isMin ? 1 : -1);
+	}
+	
+	static double computeGap(double primalBound, double dualBound) { // [stats] 相對 gap, 沒有 incumbent 或下界時為 inf
+		if (isinf(primalBound) || isinf(dualBound)) return FP64_INF;
+		return abs(primalBound - dualBound) / max(1.0, abs(primalBound));
+	}
+	
+	double getMinDualBound() const { // [stats] 所有 thread 回報的下界取 min (min 問題). 要在 critical (stats) 內呼叫
+		double dualBound = isSolving ? FP64_INF : stoppedDualBound; // 搜尋完畢時下界等於上界, [limits] 提早停下時為停下當時的下界
+		if (isSolving) for (const SolverCounters& counters: threadCounters) dualBound = min(dualBound, counters.nodeBound.load());
+		return min(dualBound, incumbent.getObjValue());
+	}
+	
+	void recordGapSample(bool isForced = false) { // [stats] incumbent 改善或距離上次超過 gapSampleIntervalMs 時記錄一次 gap, 每個 thread 取出 node 時呼叫
+		const double objValue = incumbent.getObjValue();
+		const double timeMs = chrono::duration<double, milli>(chrono::steady_clock::now() - solveStartTime).count();
+		SolverCounters& counters = *solverCounters; // 先用這個 thread 自己看到的上一次取樣過濾, 大部分 node 不用進 critical
+		if (!isForced && objValue == counters.lastSampleObjValue && timeMs - counters.lastSampleTimeMs < gapSampleIntervalMs) return;
+		counters.lastSampleObjValue = objValue;
+		counters.lastSampleTimeMs = timeMs;
+		#pragma omp critical (stats)
+		if (isForced || objValue != lastSampleObjValue || timeMs - lastSampleTimeMs >= gapSampleIntervalMs) { // 其他 thread 可能已經記錄過
+			lastSampleObjValue = objValue;
+			lastSampleTimeMs = timeMs;
+			const double primalBound = toOriginalObjValue(objValue), dualBound = toOriginalObjValue(getMinDualBound());
+			gapHistory.push_back({ timeMs, primalBound, dualBound, computeGap(primalBound, dualBound) });
+		}
+	}
+	
+	double getLowerBound(double minTopBound) const { // [limits] 全域下界 (min 問題): scheduler 裡 node 的下界 (先讀) 和每個 thread 回報的下界取 min
+		double lowerBound = minTopBound;
+		for (const SolverCounters& counters: threadCounters) lowerBound = min(lowerBound, counters.nodeBound.load());
+		return lowerBound;
+	}
+	
+	bool isLimitReached(double minTopBound = FP64_INF) { // [limits] 每個 thread 取出 node 時檢查, 超過限制就記錄停下的原因和當時的下界
+		if (portfolio != nullptr) { // [portfolio] 先拿其他成員找到的更好的解, 已經有成員停下就直接停 (這個成員的結果不會被採用, 不用記錄原因)
+			if (portfolio->incumbent.getObjValue() < incumbent.getObjValue()) {
+				shared_ptr<const Incumbent::Entry> entry = portfolio->incumbent.get(); // 目標值降低之前解向量已經發佈, 不會是 nullptr
+				incumbent.tryUpdate(entry->objValue, entry->solution);
+			}
+			if (portfolio->isFinished.load(memory_order_acquire)) return true;
+		}
+		
+		StopReason reason = StopReason::COMPLETED;
+		uint32_t solvedCount;
+		#pragma omp atomic read
+		solvedCount = nodeSolvedCount;
+		if (solvedCount >= nodeLimit) reason = StopReason::NODE_LIMIT;
+		else if (!isinf(timeLimitMs) && chrono::duration<double, milli>(chrono::steady_clock::now() - solveStartTime).count() >= timeLimitMs) reason = StopReason::TIME_LIMIT;
+		else if (relativeGapLimit > 0 || absoluteGapLimit > 0) {
+			const double upperBound = incumbent.getObjValue(), lowerBound = getLowerBound(minTopBound);
+			const bool isGapClosed = !isinf(upperBound) && !isinf(lowerBound) && (upperBound - lowerBound <= absoluteGapLimit
+				|| computeGap(toOriginalObjValue(upperBound), toOriginalObjValue(lowerBound)) <= relativeGapLimit);
+			if (isGapClosed) reason = StopReason::GAP_LIMIT;
+		}
+		if (reason == StopReason::COMPLETED) return false;
+		
+		const double lowerBound = getLowerBound(minTopBound); // 之後的 node 下界都不會比這個小
+		#pragma omp critical (stats)
+		{
+			if (stopReason == StopReason::COMPLETED) stopReason = reason;
+			stoppedDualBound = min(stoppedDualBound, lowerBound);
+		}
+		return true;
+	}
+	
+	void reportIncumbent() { // [anytime] 依序回報新的 incumbent, 多個 thread 同時發佈時只回報目前最好的, 回報的目標值一定單調改善
+		#pragma omp critical (incumbentCallback)
+		{
+			shared_ptr<const Incumbent::Entry> entry = incumbent.get();
+			if (entry != nullptr && entry->objValue < lastReportedObjValue - FOP::EPS) { // 只差浮點誤差時不回報: incumbent 本身仍會更新 (剪枝用的上界比較緊), 但對使用者來說是同一個目標值
+				lastReportedObjValue = entry->objValue;
+				incumbentCallback(toOriginalObjValue(entry->objValue), presolver.postsolve(entry->solution));
+			}
+		}
+	}
+	
+	void publishToPortfolio() { // [portfolio] 把這個成員新的 incumbent 交給其他成員
+		shared_ptr<const Incumbent::Entry> entry = incumbent.get();
+		if (entry != nullptr) portfolio->incumbent.tryUpdate(entry->objValue, entry->solution);
+	}
+	
+	void runPeriodicHeuristic(const Node& node, uint32_t& nodeCount) { // [heuristic] 每處理 divingFrequency 個 node, 從目前 node 做一次 diving (每個 thread 自己計數)
+		if (!enablePrimalHeuristics || heuristic.divingFrequency == 0 || ++nodeCount % heuristic.divingFrequency != 0) return;
+		vector<pair<double, double>> varRange = node.getVarRange(rootVarRange);
+		heuristic.dive(model, brancher.priorities, varRange, node.tableau, node.basis, incumbent);
+	}
+	
+	void finishSolve() { // 從 incumbent 取出全域 IP 解
+		shared_ptr<const Incumbent::Entry> entry = incumbent.get();
+		if (entry != nullptr) {
+			if (solutionType != Type::UNBOUNDED) solutionType = Type::BOUNDED;
+			solution = presolver.postsolve(entry->solution); // [presolve] 換回原本的變數編號
+		}
+		extremum = (incumbent.getObjValue() + presolver.objOffset) * (isMin ? 1 : -1) + objConst; // 因為有將 max 問題轉為 min 問題, 極值要記得變號
+	}
+	
+	class NodeScheduler { // [work stealing] node-level parallel 的排程器: 每個 thread 有自己的 node min-heap (shard), 從所有 shard 中下界最小的那個取出 node, 不是自己的 shard 就是偷
+	private:
+		struct Shard {
+			omp_lock_t lock; // 只保護這個 shard 的 heap
+			NodeQueue heap; // [spill] 每個 shard 有自己的記憶體預算
+			atomic<double> topBound{ FP64_INF }; // heap 頂端 node 的下界, 不用上鎖就能讀, 給挑選 shard 用
+		};
+		
+		vector<unique_ptr<Shard>> shards;
+		atomic<int64_t> pendingNodeCount{ 0 }; // shard 內的 node + 正在計算的 node, 歸零代表 node tree 已遍歷完畢 (quiescence)
+		atomic<bool> isStopped{ false };
+		
+		bool tryPop(uint32_t shardIndex, optional<Node>& nodeOpt) { // 嘗試從一個 shard 取出下界最小的 node
+			Shard& shard = *shards[shardIndex];
+			lock(shard);
+			const size_t lostNodeCount = shard.heap.lostNodeCount;
+			const bool hasNode = shard.heap.size() > 0;
+			if (hasNode) {
+				solverCounters->nodeBound = shard.heap.top().lowerBound; // [limits] 先回報再移出 shard, 其他 thread 算全域下界時不會漏掉這個 node
+				nodeOpt = shard.heap.top();
+				shard.heap.pop();
+				shard.topBound = shard.heap.size() > 0 ? shard.heap.top().lowerBound : FP64_INF;
+			} else shard.topBound = FP64_INF;
+			pendingNodeCount -= shard.heap.lostNodeCount - lostNodeCount; // [spill] 遺失的 node 不會再被處理
+			omp_unset_lock(&shard.lock);
+			return hasNode;
+		}
+		
+		static void lock(Shard& shard) { // [stats] 記錄等鎖的時間
+			CycleTimer timer(SolverCounters::QUEUE_LOCK_CYCLES);
+			omp_set_lock(&shard.lock);
+		}
+		
+		static void backoff(uint32_t idleRound) { // 沒有 node 可以拿時退避, 先讓出 CPU, 之後改為睡眠 (最多 1ms), 不會一直佔用核心
+			if (idleRound < 16) this_thread::yield();
+			else this_thread::sleep_for(chrono::microseconds(1 << min(idleRound - 16, 10u)));
+		}
+	
+	public:
+		NodeScheduler(uint32_t threadCount, size_t memoryLimit, const string& spillDirectory) {
+			for (uint32_t t = 0; t < threadCount; t++) {
+				shards.push_back(make_unique<Shard>());
+				shards.back()->heap = NodeQueue(memoryLimit == SIZE_MAX ? SIZE_MAX : memoryLimit / threadCount, spillDirectory);
+				omp_init_lock(&shards.back()->lock);
+			}
+		}
+		
+		~NodeScheduler() {
+			for (auto& shard: shards) omp_destroy_lock(&shard->lock);
+		}
+		
+		void push(uint32_t threadIndex, Node node) { // 推入自己的 shard
+			pendingNodeCount++;
+			Shard& shard = *shards[threadIndex];
+			lock(shard);
+			shard.heap.push(move(node));
+			shard.topBound = shard.heap.top().lowerBound;
+			omp_unset_lock(&shard.lock);
+		}
+		
+		bool pop(uint32_t threadIndex, optional<Node>& nodeOpt) { // 取出一個 node, 回傳 false 代表搜尋結束
+			CycleTimer timer(SolverCounters::QUEUE_WAIT_CYCLES); // [stats]
+			for (uint32_t idleRound = 0; !isStopped; idleRound++) {
+				uint32_t bestShardIndex = threadIndex; // 下界相同時優先拿自己的 shard
+				for (uint32_t k = 0; k < shards.size(); k++) {
+					if (shards[k]->topBound < shards[bestShardIndex]->topBound) bestShardIndex = k;
+				}
+				if (!isinf(shards[bestShardIndex]->topBound) && tryPop(bestShardIndex, nodeOpt)) {
+					solverCounters->nodeBound = min(nodeOpt->lowerBound, getMinTopBound()); // [stats] 其他 thread 手上的 node 由它們自己回報
+					return true;
+				}
+				if (pendingNodeCount == 0) break; // 沒有 node 在 shard 裡, 也沒有 thread 在計算
+				if (idleRound > 0) backoff(idleRound - 1); // 第一次失敗可能只是被別的 thread 搶先, 立刻重試
+			}
+			solverCounters->nodeBound = FP64_INF;
+			return false;
+		}
+		
+		void done() { // 一個 pop 出來的 node 處理完畢 (子節點已推入)
+			pendingNodeCount--;
+		}
+		
+		void stop() { // 強制結束搜尋
+			isStopped = true;
+		}
+		
+		int64_t getPendingNodeCount() const {
+			return pendingNodeCount;
+		}
+		
+		vector<Node> extract(size_t maxCount) { // [MPI] 從各 shard 頂端取出最多 maxCount 個 node 交給其他 rank, 取走的 node 不再算待處理
+			vector<Node> nodes;
+			for (auto& shardPtr: shards) {
+				Shard& shard = *shardPtr;
+				lock(shard);
+				const size_t lostNodeCount = shard.heap.lostNodeCount;
+				while (nodes.size() < maxCount && shard.heap.size() > 0) {
+					nodes.push_back(shard.heap.top());
+					shard.heap.pop();
+				}
+				shard.topBound = shard.heap.size() > 0 ? shard.heap.top().lowerBound : FP64_INF;
+				pendingNodeCount -= shard.heap.lostNodeCount - lostNodeCount;
+				omp_unset_lock(&shard.lock);
+			}
+			pendingNodeCount -= nodes.size();
+			return nodes;
+		}
+		
+		double getMinTopBound() const { // 所有 shard 頂端下界的最小值
+			double minTopBound = FP64_INF;
+			for (auto& shard: shards) minTopBound = min(minTopBound, shard->topBound.load());
+			return minTopBound;
+		}
+	};
+	
+#ifdef USE_MPI
+	class MpiLink { // [MPI] rank 之間的訊息. 全部用 MPI_Isend 送出, 緩衝區保留到送完, 兩個 rank 互相送大訊息時不會卡住. 只有 master thread 會呼叫 (MPI_THREAD_FUNNELED)
+	public:
+		enum Tag { REQUEST, NODES, INCUMBENT, SHARE, TERMINATE, DONE }; // 要 node, 一批 node, 新的 incumbent, 請分一半 node 給 rank 0, 結束搜尋, 結束確認
+		
+		struct Message {
+			int32_t source;
+			Tag tag;
+			vector<char> data;
+		};
+		
+		int32_t rank, size;
+		
+		MpiLink() {
+			MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+			MPI_Comm_size(MPI_COMM_WORLD, &size);
+		}
+		
+		void send(int32_t dest, Tag tag, vector<char> data = {}) {
+			outbox.push_back({ MPI_REQUEST_NULL, move(data) }); // vector 移動時緩衝區位址不變
+			auto& [request, buffer] = outbox.back();
+			MPI_Isend(buffer.data(), (int32_t)buffer.size(), MPI_BYTE, dest, tag, MPI_COMM_WORLD, &request);
+			progress();
+		}
+		
+		bool receive(Message& message, bool isBlocking) { // 同一個 rank 送來的訊息會照順序收到
+			MPI_Status status;
+			int32_t hasMessage = 1;
+			if (isBlocking) MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+			else MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &hasMessage, &status);
+			if (!hasMessage) return false;
+			
+			int32_t byteCount;
+			MPI_Get_count(&status, MPI_BYTE, &byteCount);
+			message.source = status.MPI_SOURCE;
+			message.tag = (Tag)status.MPI_TAG;
+			message.data.resize(byteCount);
+			MPI_Recv(message.data.data(), byteCount, MPI_BYTE, status.MPI_SOURCE, status.MPI_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+			return true;
+		}
+		
+		void flush() { // 等所有訊息送完
+			for (auto& [request, buffer]: outbox) MPI_Wait(&request, MPI_STATUS_IGNORE);
+			outbox.clear();
+		}
+	
+	private:
+		vector<pair<MPI_Request, vector<char>>> outbox;
+		
+		void progress() { // 清掉已經送完的訊息
+			for (size_t c = 0; c < outbox.size();) {
+				int32_t isDone;
+				MPI_Test(&outbox[c].first, &isDone, MPI_STATUS_IGNORE);
+				if (isDone) {
+					swap(outbox[c], outbox.back());
+					outbox.pop_back();
+				} else c++;
+			}
+		}
+	};
+	
+	static vector<char> encodeNodes(const vector<Node>& nodes) { // [MPI] node 以 bound diff 傳送: 分支路徑上的界 (root 到 node) 和下一次的切分, 不送 tableau/基底 (收到的 node 的子節點重新解 LP)
+		vector<char> buffer;
+		Bytes::write(buffer, (uint32_t)nodes.size());
+		for (const Node& node: nodes) {
+			Bytes::write(buffer, node.lowerBound);
+			Bytes::write(buffer, node.splitVarIndex);
+			Bytes::write(buffer, node.splitValue);
+			Bytes::write(buffer, node.splitFraction);
+			vector<const Node::BranchRecord*> path;
+			for (const Node::BranchRecord* record = node.branch; record != nullptr; record = record->parent) path.push_back(record);
+			Bytes::write(buffer, (uint32_t)path.size());
+			for (auto it = path.rbegin(); it != path.rend(); it++) {
+				Bytes::write(buffer, (*it)->varIndex);
+				Bytes::write(buffer, (uint8_t)(*it)->isUpper);
+				Bytes::write(buffer, (*it)->bound);
+			}
+		}
+		return buffer;
+	}
+	
+	vector<Node> decodeNodes(const vector<char>& buffer) { // [MPI] 分支路徑重新建在 thread 0 的配置區 (收 node 時沒有其他 thread 在分支)
+		const char* ptr = buffer.data();
+		vector<Node> nodes;
+		const uint32_t nodeCount = Bytes::read<uint32_t>(ptr);
+		for (uint32_t c = 0; c < nodeCount; c++) {
+			const double lowerBound = Bytes::read<double>(ptr);
+			const int32_t splitVarIndex = Bytes::read<int32_t>(ptr);
+			const double splitValue = Bytes::read<double>(ptr), splitFraction = Bytes::read<double>(ptr);
+			const Node::BranchRecord* branch = nullptr;
+			const uint32_t pathLength = Bytes::read<uint32_t>(ptr);
+			for (uint32_t d = 0; d < pathLength; d++) {
+				const uint32_t varIndex = Bytes::read<uint32_t>(ptr);
+				const bool isUpper = Bytes::read<uint8_t>(ptr);
+				branch = branchArenas[0].add({ branch, varIndex, isUpper, Bytes::read<double>(ptr) });
+			}
+			nodes.emplace_back(branch, Node::Type::LP_FEASIBLE);
+			nodes.back().lowerBound = lowerBound;
+			nodes.back().splitVarIndex = splitVarIndex;
+			nodes.back().splitValue = splitValue;
+			nodes.back().splitFraction = splitFraction;
+		}
+		return nodes;
+	}
+	
+	vector<char> encodeIncumbent() const { // [MPI] 化簡後的解 (每個 rank 的化簡結果相同)
+		vector<char> buffer;
+		shared_ptr<const Incumbent::Entry> entry = incumbent.get();
+		if (entry == nullptr) return buffer;
+		Bytes::write(buffer, entry->objValue);
+		Bytes::writeVector(buffer, entry->solution);
+		return buffer;
+	}
+	
+	void decodeIncumbent(const vector<char>& buffer) {
+		if (buffer.empty()) return;
+		const char* ptr = buffer.data();
+		const double objValue = Bytes::read<double>(ptr);
+		incumbent.tryUpdate(objValue, Bytes::readVector<double>(ptr));
+	}
+	
+	void runDistributedMaster(MpiLink& link, uint32_t rampUpNodesPerRank) { // [MPI] rank 0: 先自己展開 node tree 到每個 rank 都分得到 node, 之後持有 node pool, 把 node 分給來要的 rank, pool 空了就請忙碌的 rank 分一半回來
+		const size_t rampUpNodeCount = (size_t)rampUpNodesPerRank * link.size;
+		const uint32_t workerCount = link.size - 1;
+		vector<uint8_t> isWaiting(link.size, 0), isSharing(link.size, 0); // 在等 node 的 rank, 還沒回覆 SHARE 的 rank
+		uint32_t waitingCount = 0, sharingCount = 0;
+		bool isRampingUp = true;
+		double broadcastObjValue = FP64_INF;
+		
+		while (solutionType != Type::UNBOUNDED) {
+			MpiLink::Message message;
+			while (link.receive(message, false)) {
+				if (message.tag == MpiLink::REQUEST) {
+					isWaiting[message.source] = 1;
+					waitingCount++;
+				} else if (message.tag == MpiLink::NODES) {
+					for (Node& node: decodeNodes(message.data)) nodeQueue.push(move(node));
+					if (isSharing[message.source]) {
+						isSharing[message.source] = 0;
+						sharingCount--;
 					}
+				} else if (message.tag == MpiLink::INCUMBENT) decodeIncumbent(message.data);
+			}
+			if (incumbent.getObjValue() < broadcastObjValue) { // 新的 incumbent 轉發給所有 worker
+				broadcastObjValue = incumbent.getObjValue();
+				const vector<char> buffer = encodeIncumbent();
+				for (int32_t r = 1; r < link.size; r++) link.send(r, MpiLink::INCUMBENT, buffer);
+			}
+			if (chrono::duration<double, milli>(chrono::steady_clock::now() - solveStartTime).count() >= timeLimitMs) { // [limits] 分散式只檢查時間, 不知道 worker 手上 node 的下界
+				#pragma omp critical (stats)
+				{
+					stopReason = StopReason::TIME_LIMIT;
+					stoppedDualBound = -FP64_INF;
 				}
-				printf("\n");
-
-				printf("Right child node var range: ");
-				for (size_t vi = 0; vi < varRangeRight.size(); ++vi) {
-					const auto &rng = varRangeRight[vi];
-					if (rng.first != 0 || rng.second != FP64_INF) {
-						printf("%s = [%.2f, %.2f]; ", bimap.getVarName((uint32_t)vi).c_str(), rng.first, rng.second);
+				break;
+			}
+			
+			if (!isRampingUp) {
+				for (int32_t r = 1; r < link.size && waitingCount > 0 && nodeQueue.size() > 0; r++) if (isWaiting[r]) { // 每個在等的 rank 分一份 pool
+					const size_t batchSize = max<size_t>(1, min<size_t>(64, nodeQueue.size() / (waitingCount + 1)));
+					vector<Node> nodes;
+					while (nodes.size() < batchSize && nodeQueue.size() > 0) {
+						if (!isPrunedAtPop(nodeQueue.top())) nodes.push_back(nodeQueue.top());
+						nodeQueue.pop();
 					}
+					if (nodes.empty()) break;
+					link.send(r, MpiLink::NODES, encodeNodes(nodes));
+					isWaiting[r] = 0;
+					waitingCount--;
 				}
-				printf("\n");
+				if (waitingCount > 0 && nodeQueue.size() == 0) { // pool 空了, 請還在計算的 rank 分 node 回來
+					for (int32_t r = 1; r < link.size; r++) if (!isWaiting[r] && !isSharing[r]) {
+						link.send(r, MpiLink::SHARE);
+						isSharing[r] = 1;
+						sharingCount++;
+					}
+				}
+				if (nodeQueue.size() == 0 && waitingCount == workerCount && sharingCount == 0) break; // 所有 worker 都在等, 它們送來的 node 都已經收到 (同一個 rank 的訊息照順序到達)
+			}
+			
+			if (nodeQueue.size() == 0) {
+				isRampingUp = false;
+				this_thread::sleep_for(chrono::microseconds(50));
+				continue;
+			}
+			Node node = nodeQueue.top(); // rank 0 自己也解 pool 裡下界最小的 node
+			nodeQueue.pop();
+			solverCounters->nodeBound = min(node.lowerBound, nodeQueue.size() > 0 ? nodeQueue.top().lowerBound : FP64_INF);
+			recordGapSample();
+			if (!isPrunedAtPop(node)) {
+				solverCounters->add(SolverCounters::BRANCHED_NODE);
+				auto [leftChildNode, rightChildNode] = branchNode(node, 0);
+				if (checkNode(leftChildNode)) nodeQueue.push(move(leftChildNode));
+				if (checkNode(rightChildNode)) nodeQueue.push(move(rightChildNode));
+			}
+			if (isRampingUp && nodeQueue.size() >= rampUpNodeCount) isRampingUp = false;
+		}
+		
+		for (int32_t r = 1; r < link.size; r++) link.send(r, MpiLink::TERMINATE);
+		for (uint32_t doneCount = 0; doneCount < workerCount;) { // 收完 worker 在結束前送出的訊息, 它們的 Isend 才能完成
+			MpiLink::Message message;
+			link.receive(message, true);
+			if (message.tag == MpiLink::INCUMBENT) decodeIncumbent(message.data);
+			else if (message.tag == MpiLink::DONE) doneCount++;
+		}
+	}
+	
+	void runDistributedWorker(MpiLink& link) { // [MPI] rank > 0: 向 rank 0 要一批 node, 用 node-level parallel 解完整個子樹, 再要下一批
+		double sentObjValue = FP64_INF;
+		bool isTerminated = false;
+		auto sendIncumbent = [&]() { // 自己找到更好的 incumbent 就送給 rank 0 轉發
+			if (incumbent.getObjValue() >= sentObjValue) return;
+			sentObjValue = incumbent.getObjValue();
+			link.send(0, MpiLink::INCUMBENT, encodeIncumbent());
+		};
+		auto receiveIncumbent = [&](const vector<char>& buffer) {
+			decodeIncumbent(buffer);
+			sentObjValue = min(sentObjValue, incumbent.getObjValue()); // 不用再送回去
+		};
+		
+		nodeQueue = NodeQueue(); // root node 由 rank 0 負責
+		while (!isTerminated) {
+			sendIncumbent();
+			link.send(0, MpiLink::REQUEST);
+			vector<Node> nodes;
+			while (!isTerminated && nodes.empty()) {
+				MpiLink::Message message;
+				link.receive(message, true);
+				if (message.tag == MpiLink::TERMINATE) isTerminated = true;
+				else if (message.tag == MpiLink::INCUMBENT) receiveIncumbent(message.data);
+				else if (message.tag == MpiLink::SHARE) link.send(0, MpiLink::NODES, encodeNodes({})); // 沒有 node 可以分
+				else if (message.tag == MpiLink::NODES) nodes = decodeNodes(message.data);
+			}
+			if (isTerminated) break;
+			
+			NodeScheduler scheduler(omp_get_max_threads(), nodeMemoryLimit, spillDirectory);
+			for (Node& node: nodes) scheduler.push(0, move(node));
+			runNodeScheduler(scheduler, [&](NodeScheduler& scheduler) {
+				sendIncumbent();
+				MpiLink::Message message;
+				while (link.receive(message, false)) {
+					if (message.tag == MpiLink::TERMINATE) {
+						isTerminated = true;
+						scheduler.stop();
+					} else if (message.tag == MpiLink::INCUMBENT) receiveIncumbent(message.data);
+					else if (message.tag == MpiLink::SHARE) link.send(0, MpiLink::NODES, encodeNodes(scheduler.extract(scheduler.getPendingNodeCount() / 2)));
+				}
+			});
+		}
+		sendIncumbent();
+		link.send(0, MpiLink::DONE);
+	}
+#endif
+	
+	int64_t getSystemTimeSec() { // 獲取目前系統時間戳 (sec)
+		const auto epochTime = chrono::system_clock::now().time_since_epoch();
+		return chrono::duration_cast<chrono::seconds>(epochTime).count();
+	}
 
+public:
+	enum class Type { BOUNDED, INFEASIBLE, UNBOUNDED };
+	
+	Type solutionType = Type::INFEASIBLE; // 預設是無解, 如果有發現 IP 解會修改此值
+	vector<double> solution; // 全域 IP 解向量
+	double extremum; // min/max 極值
+	StopReason stopReason = StopReason::COMPLETED; // [limits] 不是 COMPLETED 時 solution 只是目前最好的解 (沒有解時 solutionType 仍為 INFEASIBLE)
+	
+	IP(const string& mode, const vector<pair<double, string>>& terms) { // 宣告 min/max 和目標函數
+		isMin = mode == "min"; // min/max
+		for (auto& [coef, varName]: terms) objFunc.add(coef, bimap.getVarIndex(varName)); // 目標函數
+	}
+	
+	explicit IP(const string& mode) { // [index model] 只宣告 min/max, 變數用 addVars 註冊, 目標函數用 setObjCoef 設定
+		isMin = mode == "min";
+	}
+	
+	static optional<IP> fromModel(const ModelView& model) { // [model file] 從 CSR 模型建 IP, 變數範圍轉成約束列. 只支援純整數且下界 >= 0 的模型, 不支援時印出原因並回傳 nullopt
+		uint32_t boundRowCount = 0;
+		for (uint32_t j = 0; j < model.varCount; j++) {
+			if (!model.isInteger[j]) {
+				printf("Variable %s is continuous, only pure integer models are supported\n", model.varName(j).c_str());
+				return nullopt;
 			}
+			if (model.lower[j] < 0) {
+				printf("Variable %s has a negative lower bound, variables must be >= 0\n", model.varName(j).c_str());
+				return nullopt;
+			}
+			boundRowCount += (model.lower[j] > 0) + (model.upper[j] < FP64_INF && model.upper[j] != model.lower[j]);
 		}
-	};
+		IP ip(model.isMin ? "min" : "max");
+		ip.setObjConst(model.objConst);
+		ip.addVars(model.varCount, model.varName);
+		for (uint32_t j = 0; j < model.varCount; j++) {
+			if (model.objCoefs[j] != 0) ip.setObjCoef(j, model.objCoefs[j]);
+			if (model.priorities[j] != 0) ip.setBranchPriority(j, model.priorities[j]);
+		}
+		ip.reserveConstraints(model.rowCount + boundRowCount);
+		vector<pair<double, uint32_t>> terms;
+		for (uint32_t i = 0; i < model.rowCount; i++) {
+			terms.clear();
+			for (uint64_t p = model.rowStart[i]; p < model.rowStart[i + 1]; p++) {
+				if (model.colIndexs[p] >= model.varCount) {
+					printf("Row %u refers to variable %u, but there are only %u variables\n", i, model.colIndexs[p], model.varCount);
+					return nullopt;
+				}
+				terms.push_back({ model.coefs[p], model.colIndexs[p] });
+			}
+			ip.addConstraint(terms, (Relation)model.relations[i], model.rightConsts[i]);
+		}
+		for (uint32_t j = 0; j < model.varCount; j++) { // 變數範圍: IP 的變數預設為 [0, inf]
+			const double lower = model.lower[j], upper = model.upper[j];
+			if (lower == upper) ip.addConstraint({ { 1, j } }, Relation::EQ, lower);
+			else {
+				if (lower > 0) ip.addConstraint({ { 1, j } }, Relation::GEQ, lower);
+				if (upper < FP64_INF) ip.addConstraint({ { 1, j } }, Relation::LEQ, upper);
+			}
+		}
+		return ip;
+	}
+	
+	ModelData exportModel() const { // [model file] 目前的模型 (原本的 min/max 方向, 未 presolve), 變數範圍都是 [0, inf], 上界已經是約束列
+		ModelData data;
+		data.isMin = isMin;
+		for (uint32_t j = 0; j < bimap.getVarCount(); j++) {
+			data.addVar(bimap.getVarName(j), true);
+			if (j < branchPriorities.size()) data.priorities[j] = branchPriorities[j];
+		}
+		for (auto& [j, coef]: objFunc.terms) data.objCoefs[j] = coef;
+		data.objConst = objConst;
+		vector<pair<uint32_t, double>> rowTerms;
+		for (const Constraint& con: multiCon) {
+			rowTerms.assign(con.getTerms().begin(), con.getTerms().end());
+			sort(rowTerms.begin(), rowTerms.end());
+			data.addRow(rowTerms, con.getRelation(), con.getRightConst());
+		}
+		return data;
+	}
+	
+	string getVarName(uint32_t varIndex) const { // 編號 j (x_j) 的變數名稱
+		return bimap.getVarName(varIndex);
+	}
+	
+	IP& addConstraint(const vector<pair<double, string>>& terms, const string& mode, double rightConst) { // 添加約束 (chaining)
+		Constraint con;
+		for (auto& [coef, varName]: terms) con.add(coef, bimap.getVarIndex(varName)); // 添加目標函數
+		
+		if (mode == "<=") con.leq(rightConst); // 添加右側常數
+		else if (mode == ">=") con.geq(rightConst);
+		else con.eq(rightConst);
+		
+		con.stdOfNegativeRightConst(); // 對負的右側常數進行標準化
+		multiCon.push_back(move(con));
+		
+		return *this;
+	}
+	
+	uint32_t addVars(uint32_t count, function<string(uint32_t)> nameOf) { // [index model] 註冊 count 個連續編號的變數, 回傳第一個編號. nameOf(offset) 只在印出或用名稱查詢時才呼叫
+		return bimap.addLazyVars(count, move(nameOf));
+	}
+	
+	IP& reserveConstraints(uint32_t conCount) { // [index model] 預先配置約束的空間 (chaining)
+		multiCon.reserve(conCount);
+		return *this;
+	}
+	
+	IP& addConstraint(const vector<pair<double, uint32_t>>& terms, Relation relation, double rightConst) { // [index model] 用變數編號添加約束, 不經過名稱查詢 (chaining)
+		Constraint con;
+		con.reserve(terms.size());
+		for (auto& [coef, varIndex]: terms) con.add(coef, varIndex);
+		
+		if (relation == Relation::LEQ) con.leq(rightConst);
+		else if (relation == Relation::GEQ) con.geq(rightConst);
+		else con.eq(rightConst);
+		
+		con.stdOfNegativeRightConst();
+		multiCon.push_back(move(con));
+		
+		return *this;
+	}
+	
+	IP& setTimeLimit(double timeLimitMs) { // [limits] solve 最多跑幾 ms, 超過就回傳目前最好的解 (chaining)
+		this->timeLimitMs = timeLimitMs;
+		return *this;
+	}
+	
+	IP& setNodeLimit(uint64_t nodeLimit) { // [limits] 最多解幾個 node 的 LP (chaining)
+		this->nodeLimit = nodeLimit;
+		return *this;
+	}
+	
+	IP& setGapLimit(double relativeGap, double absoluteGap = 0) { // [limits] incumbent 和全域下界的相對 gap (|上界 - 下界| / max(1, |上界|)) 或絕對 gap 夠小就停下 (chaining)
+		relativeGapLimit = relativeGap;
+		absoluteGapLimit = absoluteGap;
+		return *this;
+	}
+	
+	IP& setNodeMemoryLimit(size_t memoryLimitBytes, const string& spillDirectory = ".") { // [spill] open node 超過預算時, 下界最大的 node 寫到 spillDirectory 的暫存檔, 需要時再讀回來 (chaining)
+		nodeMemoryLimit = memoryLimitBytes;
+		this->spillDirectory = spillDirectory;
+		return *this;
+	}
+	
+	IP& setIncumbentCallback(IncumbentCallback callback) { // [anytime] 每次找到更好的 incumbent 就呼叫, 搜尋會繼續. 可能從 worker thread 呼叫, 但不會同時呼叫 (chaining)
+		incumbentCallback = move(callback);
+		return *this;
+	}
+	
+	IP& setHeuristicFrequency(uint32_t divingFrequency) { // [heuristic] 每處理幾個 node 做一次 diving, 0 代表只在 root 做 (chaining)
+		heuristic.divingFrequency = divingFrequency;
+		return *this;
+	}
 	
-	bool isMin; // min = 1, max = 0
-	Linearform objFunc; // 目標函數
-	vector<Constraint> multiCon; // 多個約束
+	IP& setNodeSelection(NodeSelection selection) { // [node selection] 設定 node 選擇策略 (chaining)
+		nodeSelection = selection;
+		return *this;
+	}
 	
-	VarBimap bimap; // 變數映射
-	priority_queue<Node, vector<Node>, Node::cmp> nodeQueue; // 以 float LP 下界排序的 min-heap, 先展開下界較小的 node 比較容易找到更小的解
-	double objValueUpperBound = FP64_INF; // 因為是求 min IP 問題, 所以有一個全域上界
+	IP& setBranchingRule(BranchingRule rule) { // [branching] 設定分支規則 (chaining)
+		brancher.rule = rule;
+		return *this;
+	}
 	
-	uint32_t nodeSolvedCount = 0; // [debug 變數] 計算了幾次 LP 問題
-	int64_t lastTimePrintNodeInfo = getSystemTimeSec(); // [debug 變數] 上一次印出 node queue 資訊的時間
+	IP& setTieBreakSeed(uint32_t seed) { // [portfolio] LP 選進入基底變數時從第 seed % 行數 行開始掃描, 同分時會選到不同的行, 0 代表照編號順序 (chaining)
+		tieBreakSeed = seed;
+		return *this;
+	}
 	
-	void init() { // 初始化 IP 問題
-		if (!isMin) objFunc.negate(); // 將 max 問題轉為 min 問題, 只需要將目標函數變號即可
-		
-		uint32_t varCount = bimap.getVarCount(); // 一般變數的個數
-		vector<pair<double, double>> varRange(varCount, { 0, FP64_INF }); // 生成一般變數的範圍, branch & bound 的 root node 的變數範圍全為 [0, inf]
-		Node rootNode = Node(objFunc, multiCon, varRange); // root node
-		checkNode(rootNode); // 檢查 node 的 solution type
+	IP& setIncremental(bool isIncremental) { // [what-if] 之後每次 solve 都保留 root 基底, 修改模型後再 solve 會熱啟動並沿用仍然可行的舊解和 pseudocost (chaining)
+		this->isIncremental = isIncremental;
+		if (!isIncremental) rootBasis = nullptr;
+		return *this;
 	}
 	
-	void checkNode(Node& node) { // 檢查一個 node 的 solution type, 決定是否要更新全域上界或推入 min heap
-		if (node.type == Node::Type::IP_FEASIBLE && node.lowerBound < objValueUpperBound) {
-			solutionType = Type::BOUNDED;
-			solution = node.solution; // 更新全域 IP 解
-			objValueUpperBound = node.lowerBound; // [剪枝] 如果 node 有整數解向量, 並且比現有的解更好, 更新全域上界, 不用繼續往下尋找
-		} // [剪枝] 如果 node 有整數解向量, 沒有比現有的解更好, 無視
-		else if (node.type == Node::Type::LP_FEASIBLE && node.lowerBound < objValueUpperBound) { // 如果 node 有浮點解向量
-			nodeQueue.push(node); // 將 root node push 進 min-heap (繼續往下搜尋)
-		} // [剪枝] "node 下界 >= 全域上界" 的分支不用繼續往下搜尋, 因為無法取得更好的結果
-		else if (node.type == Node::Type::UNBOUNDED) { // 如果 node 無界
-			solutionType = Type::UNBOUNDED; // 停止計算 IP
-		} // [剪枝] 如果 node 無解, 無視它
-		
-		nodeSolvedCount++; // 解 LP 式子的次數與 check 次數相同
-		
-		return; // [testing] 目前禁用 print node info
-		const int64_t systemTimeNowSec = getSystemTimeSec();
-		if (systemTimeNowSec != lastTimePrintNodeInfo) { // 如果時間戳改變, print 一次 node 資訊
-			lastTimePrintNodeInfo = systemTimeNowSec;
-			printf("[ Node queue size = %d | %d LP nodes solved ]\n", (uint32_t)nodeQueue.size(), nodeSolvedCount);
-		}
+	IP& setRightConst(uint32_t conIndex, double rightConst) { // [what-if] 修改第 conIndex 個約束 (addConstraint 的順序) 的右側常數 (chaining)
+		multiCon[conIndex].setRightConst(rightConst);
+		return *this;
 	}
 	
-	int64_t getSystemTimeSec() { // 獲取目前系統時間戳 (sec)
-		const auto epochTime = chrono::system_clock::now().time_since_epoch();
-		return chrono::duration_cast<chrono::seconds>(epochTime).count();
+	IP& setConstraintCoef(uint32_t conIndex, const string& varName, double coef) { // [what-if] 修改第 conIndex 個約束中變數的係數 (chaining)
+		return setConstraintCoef(conIndex, bimap.getVarIndex(varName), coef);
 	}
-
-public:
-	enum class Type { BOUNDED, INFEASIBLE, UNBOUNDED };
 	
-	Type solutionType = Type::INFEASIBLE; // 預設是無解, 如果有發現 IP 解會修改此值
-	vector<double> solution; // 全域 IP 解向量
-	double extremum; // min/max 極值
+	IP& setConstraintCoef(uint32_t conIndex, uint32_t varIndex, double coef) { // [index model] 同上, 用變數編號 (chaining)
+		multiCon[conIndex].setCoef(coef, varIndex);
+		return *this;
+	}
 	
-	IP(const string& mode, vector<pair<double, string>> terms) { // 宣告 min/max 和目標函數
-		isMin = mode == "min"; // min/max
-		for (auto& [coef, varName]: terms) objFunc.add(coef, bimap.getVarIndex(varName)); // 目標函數
+	IP& setObjCoef(const string& varName, double coef) { // [what-if] 修改目標函數中變數的係數 (原本的 min/max 方向) (chaining)
+		return setObjCoef(bimap.getVarIndex(varName), coef);
 	}
 	
-	IP& addConstraint(vector<pair<double, string>> terms, const string& mode, double rightConst) { // 添加約束 (chaining)
-		Constraint con;
-		for (auto& [coef, varName]: terms) con.add(coef, bimap.getVarIndex(varName)); // 添加目標函數
-		
-		if (mode == "<=") con.leq(rightConst); // 添加右側常數
-		else if (mode == ">=") con.geq(rightConst);
-		else con.eq(rightConst);
-		
-		con.stdOfNegativeRightConst(); // 對負的右側常數進行標準化
-		multiCon.push_back(con);
-		
+	IP& setObjConst(double constant) { // [model file] 設定目標函數的常數項 (原本的方向) (chaining)
+		objConst = constant;
+		return *this;
+	}
+	
+	IP& setObjCoef(uint32_t varIndex, double coef) { // [index model] 同上, 用變數編號 (chaining)
+		if (coef == 0) objFunc.terms.erase(varIndex);
+		else objFunc.terms[varIndex] = coef;
+		return *this;
+	}
+	
+	IP& setBranchPriority(const string& varName, int32_t priority) { // [branching] 設定變數的分支優先權, 越大越先分支 (chaining)
+		return setBranchPriority(bimap.getVarIndex(varName), priority);
+	}
+	
+	IP& setBranchPriority(uint32_t varIndex, int32_t priority) { // [index model] 同上, 用變數編號 (chaining)
+		if (varIndex >= branchPriorities.size()) branchPriorities.resize(varIndex + 1, 0);
+		branchPriorities[varIndex] = priority;
 		return *this;
 	}
 	
 	void solve() { // 計算 IP 問題
+		const uint64_t startPivotCount = lpPivotCount;
+		resetStats();
+		SolverCountersScope countersScope(threadCounters[0]); // [stats] 這個 thread 的計數寫到 IP 的第一份計數器
 		init(); // 生成初始 node 並 push 進 min-heap
 		
-		while (nodeQueue.size() > 0 && solutionType != Type::UNBOUNDED) { // min-heap 還有 node 就繼續分支, 目前 unbounded 會強制停下
-			Node node = nodeQueue.top(); // 取出下界較小的 node 比較容易找到更小的解
-			nodeQueue.pop();
+		vector<Node> nodeStack; // [node selection] DEPTH_FIRST 的 stack
+		optional<Node> diveNodeOpt; // [node selection] HYBRID_DIVE 下一個要處理的 node (目前 node 的子節點)
+		uint32_t heuristicNodeCount = 0;
+		while (solutionType != Type::UNBOUNDED) { // 目前 unbounded 會強制停下
+			optional<Node> nodeOpt;
+			if (diveNodeOpt.has_value()) nodeOpt.swap(diveNodeOpt); // 繼續 dive
+			else if (nodeStack.size() > 0) { // 深度優先
+				nodeOpt = move(nodeStack.back());
+				nodeStack.pop_back();
+			} else if (nodeQueue.size() > 0) { // 取出下界較小的 node 比較容易找到更小的解
+				nodeOpt = nodeQueue.top();
+				nodeQueue.pop();
+			} else break; // 所有 node 都處理完了
 			
-			Node leftChildNode(objFunc, multiCon, node.varRangeLeft); // 生成並計算左子節點的 LP 問題
-			Node rightChildNode(objFunc, multiCon, node.varRangeRight); // 生成並計算右子節點的 LP 問題
-			checkNode(leftChildNode); // 檢查 child node 的解
-			checkNode(rightChildNode);
+			Node& node = nodeOpt.value();
+			double lowerBound = min(node.lowerBound, nodeQueue.size() > 0 ? nodeQueue.top().lowerBound : FP64_INF); // [stats] 目前的全域下界
+			for (const Node& stackNode: nodeStack) lowerBound = min(lowerBound, stackNode.lowerBound);
+			solverCounters->nodeBound = lowerBound;
+			recordGapSample();
+			if (isLimitReached()) break; // [limits]
+			if (isPrunedAtPop(node)) continue; // [剪枝] 推入 heap 之後全域上界可能已經變小
+			runPeriodicHeuristic(node, heuristicNodeCount);
+			if (isPrunedAtPop(node)) continue; // [剪枝] heuristic 可能找到更好的 incumbent
+			
+			solverCounters->add(SolverCounters::BRANCHED_NODE);
+			auto [leftChildNode, rightChildNode] = branchNode(node, 0); // 生成並計算左右子節點的 LP 問題
+			const bool isLeftKept = checkNode(leftChildNode); // 檢查 child node 的解
+			const bool isRightKept = checkNode(rightChildNode);
+			
+			vector<Node*> keptNodes; // 要繼續分支的子節點, 下界較小的放前面
+			if (isLeftKept) keptNodes.push_back(&leftChildNode);
+			if (isRightKept) keptNodes.push_back(&rightChildNode);
+			if (keptNodes.size() == 2 && keptNodes[1]->lowerBound < keptNodes[0]->lowerBound) swap(keptNodes[0], keptNodes[1]);
+			
+			if (nodeSelection == NodeSelection::DEPTH_FIRST) { // 下界較小的最後推入, 下一輪先處理它
+				for (auto it = keptNodes.rbegin(); it != keptNodes.rend(); it++) nodeStack.push_back(move(**it));
+			} else {
+				for (uint32_t c = 0; c < keptNodes.size(); c++) {
+					if (c == 0 && nodeSelection == NodeSelection::HYBRID_DIVE) diveNodeOpt = move(*keptNodes[c]); // 往下界較小的子節點 dive
+					else nodeQueue.push(move(*keptNodes[c]));
+				}
+			}
 		}
 		
-		extremum = objValueUpperBound * (isMin ? 1 : -1); // 極值
+		pivotCount = lpPivotCount - startPivotCount;
+		finishSolve(); // 極值
+		finishStats();
 	}
 	
-	void solveParallel() { // 計算 IP 問題 (node level parallel)
-		init(); // 生成初始 node 並 push 進 min-heap
-		
-		uint32_t workingThreadCount = 0; // 正在計算中的 thread
-		
+	void runNodeScheduler(NodeScheduler& scheduler, const function<void(NodeScheduler&)>& poll = nullptr) { // node-level parallel: 所有 thread 從 scheduler 取出 node 分支, 直到 node tree 遍歷完畢. [MPI] poll 由 thread 0 (呼叫的 thread) 在每個 node 之後呼叫, 這時限制交給 rank 0 處理
 		#pragma omp parallel // 建立一個執行緒池
 		{
+			const uint32_t threadIndex = omp_get_thread_num();
+			SolverCountersScope threadCountersScope(threadCounters[threadIndex]); // [stats] 每個 thread 寫自己的計數器
+			lpTieBreakSeed = tieBreakSeed; // [portfolio]
+			const uint64_t threadStartPivotCount = lpPivotCount;
 			optional<Node> nodeOpt;
+			uint32_t heuristicNodeCount = 0;
 			
-			while (true) { // 不斷 busy waiting
-				if (solutionType == Type::UNBOUNDED) break; // 如果有 node 的 LP 解出現 unbounded 會強制停下
-				
-				bool hasNode = false;
-				bool hasActiveThread = false;
-				#pragma omp critical // 同一時間只有一個執行緒可以嘗試從 queue 取出 node
-				{
-					while (nodeQueue.size() > 0) {
-						nodeOpt = nodeQueue.top(); // 取出下界較小的 node 比較容易找到更小的解
-						nodeQueue.pop();
-						
-						if (nodeOpt.value().lowerBound < objValueUpperBound) { // 在 critical section 不斷嘗試取出一個 "node 下界 < 全域上界" 的 node
-							workingThreadCount++;
-							hasNode = true;
-							break;
-						}
+			while (scheduler.pop(threadIndex, nodeOpt)) { // 沒有 node 時 scheduler 會退避等待, 回傳 false 代表 node tree 已遍歷完畢
+				while (nodeOpt.has_value()) { // [node selection] DEPTH_FIRST/HYBRID_DIVE: 同一個 thread 往下界較小的子節點 dive, 另一個子節點推入 shard
+					Node node = move(nodeOpt.value());
+					nodeOpt.reset();
+					recordGapSample();
+					if (poll == nullptr && isLimitReached(scheduler.getMinTopBound())) { // [limits] 停下所有 thread
+						scheduler.stop();
+						break;
+					}
+					if (isPrunedAtPop(node)) break; // [剪枝] 放進 shard 之後全域上界可能已經變小, 不上鎖直接丟掉
+					runPeriodicHeuristic(node, heuristicNodeCount);
+					if (isPrunedAtPop(node)) break;
+					
+					solverCounters->add(SolverCounters::BRANCHED_NODE);
+					// 每個執行緒獨立計算自己的 LP 子問題
+					auto [leftChildNode, rightChildNode] = branchNode(node, threadIndex); // 計算左右子樹
+					
+					vector<Node*> keptNodes; // 要繼續分支的子節點, 下界較小的放前面
+					for (Node* childNode: { &leftChildNode, &rightChildNode }) {
+						if (checkNodeParallel(*childNode)) keptNodes.push_back(childNode);
+						else if (childNode->type == Node::Type::UNBOUNDED) scheduler.stop(); // 如果有 node 的 LP 解出現 unbounded 會強制停下
+					}
+					if (keptNodes.size() == 2 && keptNodes[1]->lowerBound < keptNodes[0]->lowerBound) swap(keptNodes[0], keptNodes[1]);
+					for (uint32_t c = 0; c < keptNodes.size(); c++) {
+						if (c == 0 && nodeSelection != NodeSelection::BEST_BOUND) nodeOpt = move(*keptNodes[c]); // 繼續 dive
+						else scheduler.push(threadIndex, move(*keptNodes[c])); // 子節點推入自己的 shard
 					}
-					if (workingThreadCount > 0) hasActiveThread = true;
-				}
-				if (!hasNode && hasActiveThread) continue; // node queue 是空的, 但還有 thread 還在計算, 就 busy waiting
-				if (!hasNode && !hasActiveThread) break; // node queue 是空的, 並且沒有 thread 在計算, 代表 node tree 已遍歷完畢
-				
-				// 每個執行緒獨立計算自己的 LP 子問題
-				Node& node = nodeOpt.value();
-				Node leftChildNode(objFunc, multiCon, node.varRangeLeft); // 計算左子樹 (left node)
-				Node rightChildNode(objFunc, multiCon, node.varRangeRight); // 計算右子樹 (right node)
-				
-				#pragma omp critical // 同一時間只有一個執行緒可以將 node 推入 queue, 修改 workingThreadCount 和 objValueUpperBound
-				{
-					checkNode(leftChildNode); // 檢查左右子樹的 node 的 LP 解, 決定是否要更新全域上界或推入 node queue
-					checkNode(rightChildNode);
-					workingThreadCount--; // 工作做完, 計數 -1
 				}
+				scheduler.done(); // 子節點都推入 (dive 結束) 之後才算完成, 這樣待處理的 node 數歸零時一定沒有工作了
+				if (poll != nullptr && threadIndex == 0) poll(scheduler);
+			}
+			if (threadIndex > 0) { // thread 0 是呼叫的 thread, 由呼叫者計算
+				#pragma omp atomic
+				pivotCount += lpPivotCount - threadStartPivotCount;
+			}
+		}
+	}
+	
+	bool isPrunedAtPop(const Node& node) { // [剪枝] 取出 node 時全域上界可能已經比它的下界小
+		if (node.lowerBound < incumbent.getObjValue()) return false;
+		solverCounters->add(SolverCounters::BOUND_PRUNED_NODE);
+		return true;
+	}
+	
+	void solveParallel() { // 計算 IP 問題 (node level parallel)
+		const uint64_t startPivotCount = lpPivotCount;
+		pivotCount = 0;
+		resetStats();
+		optional<SolverCountersScope> countersScope(threadCounters[0]); // [stats] 平行區域之前寫到第一份計數器
+		init(); // 生成初始 node 並 push 進 min-heap
+		
+		while (enableIntraLPParallel && nodeQueue.size() > 0 && nodeQueue.size() < (size_t)omp_get_max_threads()) { // [intra-LP parallel] node 還不夠分給每個 thread 時, 一次解一個 node, 讓 LP 內部用所有 thread
+			Node node = nodeQueue.top();
+			nodeQueue.pop();
+			solverCounters->nodeBound = min(node.lowerBound, nodeQueue.size() > 0 ? nodeQueue.top().lowerBound : FP64_INF);
+			recordGapSample();
+			if (isLimitReached()) {
+				nodeQueue = NodeQueue();
+				break;
 			}
+			if (isPrunedAtPop(node)) continue;
+			
+			solverCounters->add(SolverCounters::BRANCHED_NODE);
+			auto [leftChildNode, rightChildNode] = branchNode(node, 0);
+			if (checkNode(leftChildNode)) nodeQueue.push(move(leftChildNode));
+			if (checkNode(rightChildNode)) nodeQueue.push(move(rightChildNode));
+			if (solutionType == Type::UNBOUNDED) break;
+		}
+		
+		NodeScheduler scheduler(omp_get_max_threads(), nodeMemoryLimit, spillDirectory); // [work stealing] 每個 thread 一個 shard
+		while (nodeQueue.size() > 0) { // root node (或 intra-LP 階段留下的 node) 交給 scheduler
+			scheduler.push(0, nodeQueue.top());
+			nodeQueue.pop();
+		}
+		if (solutionType == Type::UNBOUNDED) scheduler.stop();
+		
+		solverCounters->nodeBound = FP64_INF; // 之後由 scheduler 取出 node 時回報
+		countersScope.reset();
+		runNodeScheduler(scheduler);
+		
+		pivotCount += lpPivotCount - startPivotCount; // [benchmark] 這個 thread (平行區域的 thread 0) 的迭代數, 其他 thread 在 runNodeScheduler 裡加上
+		finishSolve();
+		finishStats();
+	}
+	
+	vector<PortfolioSetting> getDefaultPortfolio(uint32_t memberCount) const { // [portfolio] 第一個成員用目前的設定, 其他成員換分支規則, node 選擇, diving 頻率和 tie-break 起點
+		const vector<PortfolioSetting> settings = {
+			{ brancher.rule, nodeSelection, heuristic.divingFrequency, tieBreakSeed },
+			{ BranchingRule::PSEUDOCOST, NodeSelection::HYBRID_DIVE, 50, 1 },
+			{ BranchingRule::MOST_FRACTIONAL, NodeSelection::DEPTH_FIRST, 20, 2 },
+			{ BranchingRule::RELIABILITY, NodeSelection::BEST_BOUND, 200, 3 },
+		};
+		vector<PortfolioSetting> portfolio;
+		for (uint32_t m = 0; m < max<uint32_t>(1, memberCount); m++) { // 超過的成員重複使用設定, 只換 tie-break 起點
+			PortfolioSetting setting = settings[m % settings.size()];
+			setting.tieBreakSeed += m / settings.size() * 7919;
+			portfolio.push_back(setting);
+		}
+		return portfolio;
+	}
+	
+	void solvePortfolio(vector<PortfolioSetting> settings = {}, uint32_t threadsPerMember = 0) { // [portfolio] 多個成員 (這個 IP 的複本) 用不同的設定同時解, 互相交換 incumbent, 第一個停下的成員的結果就是答案. settings 空的時候成員數為 min(4, thread 數), threadsPerMember 為 0 時平分所有 thread
+		const uint32_t threadCount = omp_get_max_threads();
+		if (settings.empty()) settings = getDefaultPortfolio(min<uint32_t>(4, threadCount));
+		if (threadsPerMember == 0) threadsPerMember = max<uint32_t>(1, threadCount / settings.size());
+		
+		Portfolio shared;
+		vector<IP> members(settings.size(), *this);
+		for (uint32_t m = 0; m < members.size(); m++) {
+			members[m].setBranchingRule(settings[m].branchingRule).setNodeSelection(settings[m].nodeSelection)
+				.setHeuristicFrequency(settings[m].divingFrequency).setTieBreakSeed(settings[m].tieBreakSeed);
+			members[m].portfolio = &shared;
+			if (m > 0) members[m].incumbentCallback = nullptr; // [anytime] 成員 0 會拿到所有成員的解, 只由它回報, 回報的目標值才會單調改善
+		}
+		
+		atomic<int32_t> winnerIndex{ -1 };
+		const int savedActiveLevels = omp_get_max_active_levels();
+		omp_set_max_active_levels(2);
+		#pragma omp parallel for num_threads(members.size()) schedule(static, 1)
+		for (size_t m = 0; m < members.size(); m++) {
+			if (threadsPerMember > 1) {
+				omp_set_num_threads(threadsPerMember); // 只影響目前這個 thread 開的平行區域
+				members[m].solveParallel();
+			} else members[m].solve();
+			if (!shared.isFinished.exchange(true, memory_order_acq_rel)) winnerIndex = m; // 自己停下 (搜尋完畢, 無解, 或碰到限制) 的第一個成員, 其他成員之後在 isLimitReached 停下
+		}
+		omp_set_max_active_levels(savedActiveLevels);
+		omp_set_num_threads(threadCount);
+		
+		IP& winner = members[winnerIndex];
+		winner.incumbent.onUpdate = nullptr;
+		shared_ptr<const Incumbent::Entry> bestEntry = shared.incumbent.get(); // 贏家碰到限制停下時, 其他成員最後找到的解可能還沒拿到
+		if (bestEntry != nullptr && winner.solutionType != Type::UNBOUNDED && winner.incumbent.tryUpdate(bestEntry->objValue, bestEntry->solution)) winner.finishSolve();
+		uint32_t totalNodeSolvedCount = 0; // [benchmark] 所有成員的總和
+		uint64_t totalPivotCount = 0;
+		for (const IP& member: members) {
+			totalNodeSolvedCount += member.nodeSolvedCount;
+			totalPivotCount += member.pivotCount;
 		}
 		
-		extremum = objValueUpperBound * (isMin ? 1 : -1); // 因為有將 max 問題轉為 min 問題, 極值要記得變號
+		const PortfolioSetting setting = { brancher.rule, nodeSelection, heuristic.divingFrequency, tieBreakSeed }; // 結果和統計換成贏家的, 設定維持原本的
+		IncumbentCallback callback = move(incumbentCallback);
+		*this = move(winner);
+		setBranchingRule(setting.branchingRule).setNodeSelection(setting.nodeSelection).setHeuristicFrequency(setting.divingFrequency).setTieBreakSeed(setting.tieBreakSeed);
+		incumbentCallback = move(callback);
+		portfolio = nullptr;
+		portfolioWinnerIndex = winnerIndex;
+		nodeSolvedCount = totalNodeSolvedCount;
+		pivotCount = totalPivotCount;
+	}
+	
+#ifdef USE_MPI
+	void solveDistributed(uint32_t rampUpNodesPerRank = 4) { // [MPI] 分散式 branch & bound: rank 0 解 root 和前幾層並管理 node pool, 其他 rank 要 node 並在 rank 內做 node-level parallel. 每個 rank 都要用同樣的模型和設定呼叫, 結束後每個 rank 都有全域最佳解
+		const uint64_t startPivotCount = lpPivotCount;
+		pivotCount = 0;
+		resetStats();
+		optional<SolverCountersScope> countersScope(threadCounters[0]);
+		init(); // 每個 rank 各自化簡和加 cut, 同樣的輸入得到同樣的化簡模型, 交換的變數編號才對得上
+		
+		MpiLink link;
+		if (link.rank == 0) runDistributedMaster(link, rampUpNodesPerRank);
+		else runDistributedWorker(link);
+		link.flush();
+		
+		vector<char> buffer = encodeIncumbent(); // 最佳解和停下的原因從 rank 0 廣播
+		Bytes::write(buffer, (uint8_t)stopReason);
+		Bytes::write(buffer, (uint8_t)(solutionType == Type::UNBOUNDED));
+		uint64_t byteCount = buffer.size();
+		MPI_Bcast(&byteCount, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+		buffer.resize(byteCount);
+		MPI_Bcast(buffer.data(), (int32_t)byteCount, MPI_BYTE, 0, MPI_COMM_WORLD);
+		if (link.rank != 0) {
+			const char* ptr = buffer.data() + byteCount - 2;
+			stopReason = (StopReason)Bytes::read<uint8_t>(ptr);
+			if (Bytes::read<uint8_t>(ptr)) solutionType = Type::UNBOUNDED;
+			buffer.resize(byteCount - 2);
+			decodeIncumbent(buffer);
+		}
+		uint32_t totalNodeSolvedCount = 0; // [benchmark] 所有 rank 的總和
+		MPI_Allreduce(&nodeSolvedCount, &totalNodeSolvedCount, 1, MPI_UINT32_T, MPI_SUM, MPI_COMM_WORLD);
+		nodeSolvedCount = totalNodeSolvedCount;
+		
+		pivotCount += lpPivotCount - startPivotCount;
+		countersScope.reset();
+		finishSolve();
+		finishStats();
+	}
+#endif
+	
+	int32_t getPortfolioWinnerIndex() const { // [portfolio] 上一次 solvePortfolio 採用的成員, 沒有用 solvePortfolio 時為 -1
+		return portfolioWinnerIndex;
 	}
 	
 	uint32_t getNodeSolvedCount() {
 		return nodeSolvedCount;
 	}
 	
+	uint64_t getPivotCount() const { // [benchmark] 上一次 solve 的 simplex 迭代數
+		return pivotCount;
+	}
+	
+	Stats getStats() { // [stats] 目前 (或上一次) solve 的統計, 可以在 solve 中從其他 thread 呼叫
+		Stats stats = {};
+		#pragma omp critical (stats)
+		{
+			uint64_t totals[SolverCounters::COUNTER_COUNT] = {};
+			for (const SolverCounters& counters: threadCounters) {
+				for (uint32_t c = 0; c < SolverCounters::COUNTER_COUNT; c++) totals[c] += counters.get((SolverCounters::Counter)c);
+			}
+			stats.isSolving = isSolving;
+			const auto endTime = isSolving ? chrono::steady_clock::now() : solveEndTime;
+			const uint64_t endCycle = isSolving ? readCycleCounter() : solveEndCycle;
+			stats.elapsedMs = threadCounters.size() > 0 ? chrono::duration<double, milli>(endTime - solveStartTime).count() : 0;
+			const double msPerCycle = endCycle > solveStartCycle ? stats.elapsedMs / (endCycle - solveStartCycle) : 0; // 用整次 solve 的時間校正 cycle 的頻率
+			
+			stats.phase1PivotCount = totals[SolverCounters::PHASE1_PIVOT];
+			stats.phase2PivotCount = totals[SolverCounters::PHASE2_PIVOT];
+			stats.dualPivotCount = totals[SolverCounters::DUAL_PIVOT];
+			stats.eliminationMs = totals[SolverCounters::ELIMINATION_CYCLES] * msPerCycle;
+			stats.insertConMs = totals[SolverCounters::INSERT_CON_CYCLES] * msPerCycle;
+			stats.queueWaitMs = totals[SolverCounters::QUEUE_WAIT_CYCLES] * msPerCycle;
+			stats.queueLockMs = totals[SolverCounters::QUEUE_LOCK_CYCLES] * msPerCycle;
+			stats.nodeSolvedCount = totals[SolverCounters::CHECKED_NODE];
+			stats.branchedNodeCount = totals[SolverCounters::BRANCHED_NODE];
+			stats.boundPrunedNodeCount = totals[SolverCounters::BOUND_PRUNED_NODE];
+			stats.infeasibleNodeCount = totals[SolverCounters::INFEASIBLE_NODE];
+			stats.integralNodeCount = totals[SolverCounters::INTEGRAL_NODE];
+			stats.spilledNodeCount = totals[SolverCounters::SPILLED_NODE];
+			stats.primalBound = toOriginalObjValue(incumbent.getObjValue());
+			stats.dualBound = toOriginalObjValue(getMinDualBound());
+			stats.gap = computeGap(stats.primalBound, stats.dualBound);
+			stats.gapHistory = gapHistory;
+		}
+		return stats;
+	}
+	
+	uint32_t getVarCount() const { // 模型的變數數 (batch solver 用來估計模型大小)
+		return bimap.getVarCount();
+	}
+	
+	uint32_t getConstraintCount() const { // 約束數, 新約束的編號就是目前的約束數
+		return multiCon.size();
+	}
+	
 	void print_grouped_solution(bool show_zero = false) const {
 		struct Item { std::string name; double val; };
 		std::vector<Item> items;
@@ -765,6 +5255,289 @@ public:
 
 #include "sc_params.hpp"
 #include "sc_model.cpp"
+
+bool hasSuffix(const string& s, const string& suffix) {
+	return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool isModelFilePath(const string& path) { // [model file] 依副檔名判斷
+	return hasSuffix(path, ".bin") || hasSuffix(path, ".mps") || hasSuffix(path, ".lp");
+}
+
+optional<IP> loadModelFile(const string& path) { // [model file] .bin 直接 mmap 後建模 (名稱留在檔案裡), .mps/.lp 串流讀成 ModelData 再建模
+	if (hasSuffix(path, ".bin")) {
+		ModelView view;
+		if (ModelFile::mapBinary(path, view) == nullptr) return nullopt;
+		return IP::fromModel(view); // view.varName 持有 mapping, IP 存在時檔案都保持 mmap
+	}
+	optional<ModelData> data = hasSuffix(path, ".mps") ? ModelFile::readMps(path) : ModelFile::readLp(path);
+	if (!data.has_value()) return nullopt;
+	ModelView view = data->view();
+	auto names = make_shared<vector<string>>(move(data->varNames)); // 名稱交給 IP, 其他陣列建模完就不需要了
+	view.varName = [names](uint32_t j) { return (*names)[j]; };
+	return IP::fromModel(view);
+}
+
+bool writeModelFile(const IP& ip, const string& path) { // [model file] 依副檔名寫 .bin 或 .mps
+	const ModelData data = ip.exportModel();
+	if (hasSuffix(path, ".bin")) return ModelFile::writeBinary(data.view(), path);
+	if (hasSuffix(path, ".mps")) return ModelFile::writeMps(data.view(), path);
+	printf("Unknown model file type: %s (use .bin or .mps)\n", path.c_str());
+	return false;
+}
+
+class BatchSolver { // [batch] 同時解多個獨立的 IP (例如不同需求矩陣的情境), 共用同一個 OpenMP 執行緒池
+public:
+	struct Result { // 一個 IP 的結果
+		size_t index; // 在輸入中的編號
+		IP::Type solutionType;
+		double extremum;
+		vector<double> solution;
+		uint32_t nodeSolvedCount;
+		double exeTimeMs;
+		uint32_t threadCount; // 這個 IP 用了幾個 thread (1 代表 instance-level, 其他為 node-level solveParallel)
+	};
+	using Callback = function<void(const Result&)>; // 每個 IP 解完就呼叫一次 (串流結果), 不會同時被兩個 thread 呼叫
+	
+	uint32_t bigModelVarCount = 2000; // 變數數至少這麼多的 IP 算大模型, 用全部 thread 做 node-level 平行
+	
+	vector<Result> solve(vector<IP>& ips, const Callback& onResult = nullptr) { // 解完的 IP 留在 ips 裡, 回傳的結果依照輸入順序
+		const uint32_t threadCount = omp_get_max_threads();
+		vector<Result> results(ips.size());
+		if (ips.empty()) return results;
+		auto solveOne = [&](size_t index, uint32_t ipThreadCount) {
+			IP& ip = ips[index];
+			auto start = chrono::high_resolution_clock::now();
+			if (ipThreadCount > 1) {
+				omp_set_num_threads(ipThreadCount); // 只影響目前這個 thread 開的平行區域
+				ip.solveParallel();
+			} else ip.solve();
+			auto end = chrono::high_resolution_clock::now();
+			
+			results[index] = { index, ip.solutionType, ip.extremum, ip.solution, ip.getNodeSolvedCount(), chrono::duration<double, milli>(end - start).count(), ipThreadCount };
+			#pragma omp critical (batchResult)
+			if (onResult) onResult(results[index]);
+		};
+		
+		if (ips.size() < threadCount) { // 實例比 thread 少: 全部同時解, 每個實例分到 threadCount / n 個 thread 做 node-level 平行 (巢狀平行)
+			const uint32_t ipThreadCount = threadCount / ips.size();
+			const int savedActiveLevels = omp_get_max_active_levels();
+			omp_set_max_active_levels(2);
+			#pragma omp parallel for num_threads(ips.size()) schedule(static, 1)
+			for (size_t index = 0; index < ips.size(); index++) solveOne(index, ipThreadCount);
+			omp_set_max_active_levels(savedActiveLevels);
+			omp_set_num_threads(threadCount);
+			return results;
+		}
+		
+		vector<size_t> order(ips.size()); // 實例多: 大模型先用全部 thread 一個一個解, 小模型每個 thread 各解一個, 由大到小分配 (比較不會剩一個大的拖住最後)
+		iota(order.begin(), order.end(), 0);
+		stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return ips[a].getVarCount() > ips[b].getVarCount(); });
+		size_t smallBegin = 0;
+		for (; smallBegin < order.size() && ips[order[smallBegin]].getVarCount() >= bigModelVarCount; smallBegin++) solveOne(order[smallBegin], threadCount);
+		omp_set_num_threads(threadCount);
+		
+		#pragma omp parallel for schedule(dynamic, 1)
+		for (size_t c = smallBegin; c < order.size(); c++) solveOne(order[c], 1);
+		return results;
+	}
+	
+	vector<Result> solve(const vector<SCParams>& params, const Callback& onResult = nullptr) { // 依照參數建出所有供應鏈 IP 再一起解
+		vector<IP> ips;
+		ips.reserve(params.size());
+		for (const SCParams& P: params) ips.push_back(build_supply_chain_ip(P));
+		return solve(ips, onResult);
+	}
+};
+class Benchmark { // [benchmark] 掃過模型大小, SCGenCfg 變體, thread 數和所有解法設定, 輸出 CSV/JSON 給不同機器追蹤效能回歸
+public:
+	struct Size { int i, j, k, l; };
+	
+	struct Variant { // SCGenCfg 的變體, 尺寸欄位由 Size 覆蓋
+		string name;
+		SCGenCfg cfg;
+	};
+	
+	struct SolverConfig { // 一組全域解法設定
+		string name;
+		LPEngine engine;
+		BranchingRule rule;
+		NodeSelection selection;
+	};
+	
+	struct Row { // 一組 (大小, 變體, 設定, thread 數, 模式) 的統計
+		Size size;
+		string variant, config;
+		string mode; // "node": 同一個 IP 用 solveParallel (strong scaling), "batch": threads 個 IP 用 BatchSolver (weak scaling)
+		uint32_t threads;
+		double medianMs, p95Ms; // 每次執行的耗時
+		double nodes, pivotsPerNode, nodesPerSec; // nodes 為平均每個 IP 的 node 數
+		double speedup, efficiency; // 相對於 1 thread: node 模式為 T1 / Tt 和 T1 / (t Tt), batch 模式為 T1 / Tt (工作量和 thread 數成正比)
+		double objective; // 檢查用
+		string stop; // "optimal" 或是撞到哪個限制 ("time"/"node"), 任一次執行提早停下就記錄那次的原因
+	};
+	
+	vector<Size> sizes = { {2, 2, 1, 2}, {2, 3, 2, 2}, {3, 3, 2, 2}, {3, 3, 3, 3} };
+	vector<Variant> variants;
+	vector<SolverConfig> configs;
+	vector<uint32_t> threadCounts; // 預設 1, 2, 4, ... 和最大 thread 數
+	uint32_t repetitions = 5;
+	double maxRunMs = 10000; // 每次執行的時間限制; 1 thread 撞到限制 (或中位數超過這個值), 這組 (變體, 設定) 就跳過更大的模型
+	uint64_t maxRunNodes = 1000000; // 每次執行的 node 數限制, 撞到時同上
+	
+	Benchmark(bool isQuick = false) {
+		SCGenCfg tightCapacity; // 產能和倉庫容量用 SCGenCfg 註解裡的原始值
+		tightCapacity.cap_util = 0.7;
+		tightCapacity.wh_capacity_share = 0.5;
+		SCGenCfg highFixedCost; // 固定費用原始值
+		highFixedCost.wh_rent_base = 2000;
+		highFixedCost.wh_rent_step = 200;
+		highFixedCost.store_rent_base = 6000;
+		highFixedCost.store_rent_step = 500;
+		variants = { { "default", SCGenCfg() }, { "tight-capacity", tightCapacity }, { "high-fixed-cost", highFixedCost } };
+		
+		const pair<const char*, LPEngine> engines[] = { { "tableau", LPEngine::TABLEAU }, { "revised", LPEngine::REVISED } };
+		const pair<const char*, BranchingRule> rules[] = {
+			{ "first", BranchingRule::FIRST_INDEX }, { "mostfrac", BranchingRule::MOST_FRACTIONAL }, { "pseudocost", BranchingRule::PSEUDOCOST },
+			{ "reliability", BranchingRule::RELIABILITY }, { "strong", BranchingRule::STRONG }
+		};
+		const pair<const char*, NodeSelection> selections[] = { { "bestbound", NodeSelection::BEST_BOUND }, { "dfs", NodeSelection::DEPTH_FIRST }, { "dive", NodeSelection::HYBRID_DIVE } };
+		for (auto& [engineName, engine]: engines) for (auto& [ruleName, rule]: rules) for (auto& [selectionName, selection]: selections) {
+			if (isQuick && (rule != BranchingRule::RELIABILITY || selection != NodeSelection::BEST_BOUND)) continue;
+			configs.push_back({ string(engineName) + "/" + ruleName + "/" + selectionName, engine, rule, selection });
+		}
+		
+		const uint32_t maxThreadCount = omp_get_max_threads();
+		for (uint32_t t = 1; t < maxThreadCount; t *= 2) if (!isQuick || t == 1) threadCounts.push_back(t);
+		threadCounts.push_back(maxThreadCount);
+		if (isQuick) {
+			sizes = { {2, 2, 1, 2}, {3, 3, 2, 2}, {3, 3, 3, 3} };
+			variants.resize(1);
+			repetitions = 3;
+		}
+	}
+	
+	vector<Row> run() {
+		const uint32_t maxThreadCount = omp_get_max_threads();
+		vector<Row> rows;
+		for (const Variant& variant: variants) for (const SolverConfig& config: configs) {
+			applyConfig(config);
+			for (const Size& size: sizes) {
+				SCGenCfg cfg = variant.cfg;
+				cfg.I = size.i; cfg.J = size.j; cfg.K = size.k; cfg.L = size.l;
+				const SCParams P = make_sc_params(cfg);
+				
+				double serialMedianMs = FP64_INF;
+				bool isSerialLimited = false;
+				for (const char* mode: { "node", "batch" }) {
+					double baseMs = FP64_NAN;
+					for (uint32_t threads: threadCounts) {
+						Row row = measure(P, config, mode, threads);
+						if (threads == 1 && string(mode) == "node") isSerialLimited = row.stop != "optimal";
+						if (threads == 1) baseMs = row.medianMs;
+						row.size = size;
+						row.variant = variant.name;
+						row.config = config.name;
+						row.speedup = baseMs / row.medianMs;
+						row.efficiency = string(mode) == "node" ? row.speedup / threads : row.speedup;
+						printf("[bench] %-16s %-32s (%d,%d,%d,%d) %-5s t=%-3u median %9.3f ms  p95 %9.3f ms  %8.0f nodes  %7.1f piv/node  eff %.2f  %s\n",
+							row.variant.c_str(), row.config.c_str(), size.i, size.j, size.k, size.l, mode, threads, row.medianMs, row.p95Ms, row.nodes, row.pivotsPerNode, row.efficiency, row.stop.c_str());
+						cout << flush;
+						rows.push_back(row);
+						if (isSerialLimited) break; // 1 thread 就撞到限制, 其他 thread 數和 batch 模式也不會有完整的結果
+					}
+					if (string(mode) == "node") serialMedianMs = baseMs;
+					if (isSerialLimited) break;
+				}
+				if (isSerialLimited || serialMedianMs > maxRunMs) break; // 更大的模型只會更慢
+			}
+		}
+		omp_set_num_threads(maxThreadCount);
+		return rows;
+	}
+	
+	static void writeCsv(const vector<Row>& rows, const string& path) {
+		FILE* file = fopen(path.c_str(), "w");
+		if (file == nullptr) {
+			printf("Cannot open %s\n", path.c_str());
+			return;
+		}
+		fprintf(file, "simd_kernel,max_threads,I,J,K,L,variant,config,mode,threads,median_ms,p95_ms,nodes,nodes_per_sec,pivots_per_node,speedup,efficiency,objective,stop\n");
+		for (const Row& r: rows) {
+			fprintf(file, "%s,%d,%d,%d,%d,%d,%s,%s,%s,%u,%.4f,%.4f,%.1f,%.1f,%.2f,%.4f,%.4f,%.6f,%s\n",
+				simdKernels.name, omp_get_max_threads(), r.size.i, r.size.j, r.size.k, r.size.l, r.variant.c_str(), r.config.c_str(), r.mode.c_str(),
+				r.threads, r.medianMs, r.p95Ms, r.nodes, r.nodesPerSec, r.pivotsPerNode, r.speedup, r.efficiency, r.objective, r.stop.c_str());
+		}
+		fclose(file);
+	}
+	
+	static void writeJson(const vector<Row>& rows, const string& path) {
+		FILE* file = fopen(path.c_str(), "w");
+		if (file == nullptr) {
+			printf("Cannot open %s\n", path.c_str());
+			return;
+		}
+		fprintf(file, "{\n  \"simd_kernel\": \"%s\",\n  \"max_threads\": %d,\n  \"results\": [\n", simdKernels.name, omp_get_max_threads());
+		for (size_t c = 0; c < rows.size(); c++) {
+			const Row& r = rows[c];
+			fprintf(file, "    {\"size\": [%d, %d, %d, %d], \"variant\": \"%s\", \"config\": \"%s\", \"mode\": \"%s\", \"threads\": %u, "
+				"\"median_ms\": %.4f, \"p95_ms\": %.4f, \"nodes\": %.1f, \"nodes_per_sec\": %.1f, \"pivots_per_node\": %.2f, "
+				"\"speedup\": %.4f, \"efficiency\": %.4f, \"objective\": %.6f, \"stop\": \"%s\"}%s\n",
+				r.size.i, r.size.j, r.size.k, r.size.l, r.variant.c_str(), r.config.c_str(), r.mode.c_str(), r.threads,
+				r.medianMs, r.p95Ms, r.nodes, r.nodesPerSec, r.pivotsPerNode, r.speedup, r.efficiency, r.objective, r.stop.c_str(), c + 1 < rows.size() ? "," : "");
+		}
+		fprintf(file, "  ]\n}\n");
+		fclose(file);
+	}
+
+private:
+	static void applyConfig(const SolverConfig& config) { // 和 Tester 的 [SIMD: ON] 設定相同, 再加上 warm start 和 bounded simplex
+		enableMatrixEliminationParallel = true;
+		enableWarmStartDualSimplex = true;
+		enableBoundedSimplex = true;
+		lpEngine = config.engine;
+	}
+	
+	Row measure(const SCParams& P, const SolverConfig& config, const string& mode, uint32_t threads) { // 執行 repetitions 次, 取中位數和 p95 (nearest rank). 撞到限制的那次之後不再重複
+		vector<double> times;
+		double nodeSum = 0, pivotSum = 0, objective = FP64_NAN;
+		uint32_t ipCount = 0;
+		string stop = "optimal";
+		for (uint32_t rep = 0; rep < repetitions && stop == "optimal"; rep++) {
+			omp_set_num_threads(threads);
+			vector<IP> ips;
+			for (uint32_t c = 0; c < (mode == "batch" ? threads : 1); c++) ips.push_back(build_supply_chain_ip(P));
+			for (IP& ip: ips) ip.setBranchingRule(config.rule).setNodeSelection(config.selection).setTimeLimit(maxRunMs).setNodeLimit(maxRunNodes); // [limits]
+			
+			auto start = chrono::high_resolution_clock::now();
+			if (mode == "batch") BatchSolver().solve(ips);
+			else threads == 1 ? ips[0].solve() : ips[0].solveParallel();
+			auto end = chrono::high_resolution_clock::now();
+			times.push_back(chrono::duration<double, milli>(end - start).count());
+			for (IP& ip: ips) {
+				nodeSum += ip.getNodeSolvedCount();
+				pivotSum += ip.getPivotCount();
+				objective = ip.extremum;
+				ipCount++;
+				if (ip.stopReason == IP::StopReason::TIME_LIMIT) stop = "time";
+				else if (ip.stopReason == IP::StopReason::NODE_LIMIT && stop == "optimal") stop = "node";
+			}
+		}
+		sort(times.begin(), times.end());
+		Row row;
+		row.mode = mode;
+		row.threads = threads;
+		row.medianMs = times[times.size() / 2];
+		row.p95Ms = times[min(times.size() - 1, (size_t)ceil(0.95 * times.size()) - 1)];
+		row.nodes = nodeSum / ipCount;
+		row.pivotsPerNode = pivotSum / max(1.0, nodeSum);
+		row.nodesPerSec = nodeSum / repetitions / (row.medianMs / 1000);
+		row.objective = objective;
+		row.stop = stop;
+		return row;
+	}
+};
+
 class Tester { // 測速
 private:
 	int i, j, k, l;
@@ -772,12 +5545,17 @@ private:
 public:
 	Tester(int i, int j, int k, int l): i(i), j(j), k(k), l(l) {}
 	
-	pair<double, uint32_t> testOneIP(bool avx2MRO, bool nodeOmp) { // 測試單個 IP 問題的耗時和 LP node 解決數
-		enableMatrixEliminationParallel = avx2MRO; // 啟用矩陣列運算 avx256 向量化加速
+	pair<double, uint32_t> testOneIP(bool simdMRO, bool nodeOmp, bool warmStart = false, bool bounded = false, bool revised = false,
+		BranchingRule rule = BranchingRule::FIRST_INDEX) { // 測試單個 IP 問題的耗時和 LP node 解決數
+		enableMatrixEliminationParallel = simdMRO; // 啟用矩陣列運算 SIMD 向量化加速
+		enableWarmStartDualSimplex = warmStart; // 子節點從父節點的 tableau 熱啟動
+		enableBoundedSimplex = bounded; // 變數範圍不轉為約束列
+		lpEngine = revised ? LPEngine::REVISED : LPEngine::TABLEAU; // LP 引擎
 		bool enableNodeLevelParallel = nodeOmp; // node queue 會一次 pop 多個 node 做平行化計算
 		
 		SCParams P = default_sc_params(i, j, k, l); // 取參數 (可在 sc_params.hpp 改 default_sc_params() 內容)
 		IP ip = build_supply_chain_ip(P); // 用參數建 IP 模型 (目標 + 限制)
+		ip.setBranchingRule(rule); // 分支規則
 		
 		auto start = chrono::high_resolution_clock::now(); // 測速
 		enableNodeLevelParallel ? ip.solveParallel() : ip.solve();
@@ -787,14 +5565,15 @@ public:
 		return { exeTimeMs, ip.getNodeSolvedCount() };
 	}
 	
-	pair<double, double> testParallel(uint32_t n, bool avx2MRO, bool nodeOmp) { // 測試 n 次同一個 IP 問題, 回傳平均耗時和平均 node 數
-		printf("Solved IP problem count (avx2=%d omp=%d): ", avx2MRO, nodeOmp);
+	pair<double, double> testParallel(uint32_t n, bool simdMRO, bool nodeOmp, bool warmStart = false, bool bounded = false, bool revised = false,
+		BranchingRule rule = BranchingRule::FIRST_INDEX) { // 測試 n 次同一個 IP 問題, 回傳平均耗時和平均 node 數
+		printf("Solved IP problem count (simd=%d omp=%d warm=%d bounded=%d revised=%d rule=%d): ", simdMRO, nodeOmp, warmStart, bounded, revised, (int)rule);
 		cout << flush; // 分隔用
 		
 		double exeTimeMsSum = 0;
 		uint32_t nodeSolvedCountSum = 0;
 		for (uint32_t a = 0; a < n; a++) {
-			auto [exeTimeMs, nodeSolvedCount] = testOneIP(avx2MRO, nodeOmp);
+			auto [exeTimeMs, nodeSolvedCount] = testOneIP(simdMRO, nodeOmp, warmStart, bounded, revised, rule);
 			exeTimeMsSum += exeTimeMs;
 			nodeSolvedCountSum += nodeSolvedCount;
 			cout << "*" << flush;
@@ -803,34 +5582,344 @@ public:
 		return { exeTimeMsSum / n, (double)nodeSolvedCountSum / n };
 	}
 	
+	double testBatch(uint32_t n) { // [batch] 一次丟 n 個同樣參數的 IP 給 BatchSolver, 回傳平均每個 IP 的耗時 (吞吐量)
+		printf("Solved IP problem count (batch): ");
+		cout << flush;
+		vector<SCParams> params(n, default_sc_params(i, j, k, l));
+		auto start = chrono::high_resolution_clock::now();
+		BatchSolver().solve(params, [](const BatchSolver::Result&) { cout << "*" << flush; });
+		auto end = chrono::high_resolution_clock::now();
+		cout << endl;
+		return chrono::duration<double, milli>(end - start).count() / n;
+	}
+	
+	void testStats(bool nodeOmp, double timeLimitMs = FP64_INF, uint64_t nodeLimit = UINT64_MAX, double gapLimit = 0, size_t nodeMemoryLimit = SIZE_MAX) { // [stats] 解一次 IP, solve 中每隔 100ms 印出一次統計, 用來判斷慢在 pivot, 搶鎖還是 node tree 大小
+		enableMatrixEliminationParallel = true;
+		SCParams P = default_sc_params(i, j, k, l);
+		IP ip = build_supply_chain_ip(P);
+		ip.setTimeLimit(timeLimitMs).setNodeLimit(nodeLimit).setGapLimit(gapLimit); // [limits]
+		ip.setNodeMemoryLimit(nodeMemoryLimit); // [spill]
+		auto start = chrono::steady_clock::now();
+		ip.setIncumbentCallback([&](double objValue, const vector<double>&) { // [anytime]
+			printf(" %.3f ms | new incumbent: %.4f\n", chrono::duration<double, milli>(chrono::steady_clock::now() - start).count(), objValue);
+		});
+		
+		atomic<bool> isDone = false;
+		thread solveThread([&]() {
+			nodeOmp ? ip.solveParallel() : ip.solve();
+			isDone = true;
+		});
+		while (!isDone) {
+			this_thread::sleep_for(chrono::milliseconds(100));
+			const IP::Stats stats = ip.getStats();
+			if (stats.isSolving) printf(" %.0f ms | nodes: %llu | primal: %g | dual: %g | gap: %.4f\n",
+				stats.elapsedMs, (unsigned long long)stats.nodeSolvedCount, stats.primalBound, stats.dualBound, stats.gap);
+		}
+		solveThread.join();
+		
+		const IP::Stats stats = ip.getStats();
+		printf("-------------------- Stats --------------------\n");
+		printf(" IP problem - Model parameters: (%d, %d, %d, %d), OMP: %s\n", i, j, k, l, nodeOmp ? "ON" : "OFF");
+		const char* stopReasonNames[] = { "completed", "time limit", "node limit", "gap limit" };
+		printf(" Elapsed: %.3f ms | Objective: %g | Gap: %.4f | Stop: %s\n", stats.elapsedMs, stats.primalBound, stats.gap, stopReasonNames[(int)ip.stopReason]);
+		printf(" Pivots: phase-1 %llu, phase-2 %llu, dual %llu\n",
+			(unsigned long long)stats.phase1PivotCount, (unsigned long long)stats.phase2PivotCount, (unsigned long long)stats.dualPivotCount);
+		printf(" Time (sum over threads): elimination %.3f ms, insertConToTableau %.3f ms, queue wait %.3f ms (lock %.3f ms)\n",
+			stats.eliminationMs, stats.insertConMs, stats.queueWaitMs, stats.queueLockMs);
+		printf(" Nodes: solved %llu, branched %llu, pruned by bound %llu, infeasible %llu, integral %llu, spilled to disk %llu\n",
+			(unsigned long long)stats.nodeSolvedCount, (unsigned long long)stats.branchedNodeCount, (unsigned long long)stats.boundPrunedNodeCount,
+			(unsigned long long)stats.infeasibleNodeCount, (unsigned long long)stats.integralNodeCount, (unsigned long long)stats.spilledNodeCount);
+		printf(" Gap samples: %zu\n", stats.gapHistory.size());
+		for (const IP::GapSample& sample: stats.gapHistory) printf("  %.3f ms | primal: %g | dual: %g | gap: %.4f\n", sample.timeMs, sample.primalBound, sample.dualBound, sample.gap);
+		printf("-------------------- Stats --------------------\n");
+	}
+	
+	void testPortfolio(uint32_t memberCount, double timeLimitMs = FP64_INF, uint64_t nodeLimit = UINT64_MAX, double gapLimit = 0) { // [portfolio] 同一個模型先用所有 thread 做 node-level parallel, 再用賽跑模式解, 比較時間
+		enableMatrixEliminationParallel = true;
+		SCParams P = default_sc_params(i, j, k, l);
+		IP ip = build_supply_chain_ip(P);
+		ip.setTimeLimit(timeLimitMs).setNodeLimit(nodeLimit).setGapLimit(gapLimit); // [limits]
+		
+		auto start = chrono::steady_clock::now();
+		ip.solveParallel();
+		const double parallelMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		const double parallelExtremum = ip.extremum;
+		const uint32_t parallelNodeCount = ip.getNodeSolvedCount();
+		
+		const vector<IP::PortfolioSetting> settings = ip.getDefaultPortfolio(memberCount);
+		start = chrono::steady_clock::now();
+		ip.solvePortfolio(settings);
+		const double portfolioMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		
+		const char* branchingRuleNames[] = { "first index", "most fractional", "pseudocost", "reliability", "strong" };
+		const char* nodeSelectionNames[] = { "best bound", "depth first", "hybrid dive" };
+		const char* stopReasonNames[] = { "completed", "time limit", "node limit", "gap limit" };
+		printf("-------------------- Portfolio --------------------\n");
+		printf(" IP problem - Model parameters: (%d, %d, %d, %d), threads: %d\n", i, j, k, l, omp_get_max_threads());
+		for (uint32_t m = 0; m < settings.size(); m++) printf(" %s member %u: %s, %s, diving every %u nodes, tie-break seed %u\n", (int32_t)m == ip.getPortfolioWinnerIndex() ? "*" : " ", m,
+			branchingRuleNames[(int)settings[m].branchingRule], nodeSelectionNames[(int)settings[m].nodeSelection], settings[m].divingFrequency, settings[m].tieBreakSeed);
+		printf(" Node-level parallel: %.3f ms | Objective: %g | %u LP nodes solved\n", parallelMs, parallelExtremum, parallelNodeCount);
+		printf(" Portfolio: %.3f ms | Objective: %g | %u LP nodes solved (all members) | Stop: %s\n", portfolioMs, ip.extremum, ip.getNodeSolvedCount(), stopReasonNames[(int)ip.stopReason]);
+		printf("-------------------- Portfolio --------------------\n");
+	}
+	
+	void testWhatIf() { // [what-if] 解一次之後修改需求和售價, 用 setIncremental 再解一次, 和參數改好後重新建模的結果比較
+		enableMatrixEliminationParallel = true;
+		enableWarmStartDualSimplex = true;
+		lpEngine = LPEngine::REVISED; // 只有 revised simplex 會保留 root 基底
+		SCParams P = default_sc_params(i, j, k, l);
+		IP ip = build_supply_chain_ip(P, false); // what-if 不能有對稱性破除列
+		ip.setIncremental(true).setBranchingRule(BranchingRule::RELIABILITY);
+		
+		auto start = chrono::steady_clock::now();
+		ip.solve();
+		const double baseMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		const double baseExtremum = ip.extremum;
+		const uint32_t baseNodeCount = ip.getNodeSolvedCount();
+		
+		const size_t editStore = P.store.size() - 1;
+		if (!sc_set_demand(ip, P, 0, 0, round(P.demand[0][0] * 1.5))) return; // 第 0 個產品在第 0 間門市的需求增加 50%
+		P.price[P.prod.size() - 1][editStore] += 10; // 最後一個產品在最後一間門市漲價
+		if (!sc_update_objective(ip, P)) return;
+		start = chrono::steady_clock::now();
+		ip.solve();
+		const double incrementalMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		
+		IP freshIp = build_supply_chain_ip(P, false); // 用改好的參數重新建模
+		freshIp.setBranchingRule(BranchingRule::RELIABILITY);
+		start = chrono::steady_clock::now();
+		freshIp.solve();
+		const double freshMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		
+		printf("-------------------- What-if --------------------\n");
+		printf(" IP problem - Model parameters: (%d, %d, %d, %d), revised simplex, reliability branching, no symmetry rows\n", i, j, k, l);
+		printf(" Base: %.3f ms | Objective: %g | %u LP nodes solved\n", baseMs, baseExtremum, baseNodeCount);
+		printf(" Edit: demand[0][0] = %g, price[%zu][%zu] = %g\n", P.demand[0][0], P.prod.size() - 1, editStore, P.price[P.prod.size() - 1][editStore]);
+		printf(" Incremental re-solve: %.3f ms | Objective: %g | %u LP nodes solved\n", incrementalMs, ip.extremum, ip.getNodeSolvedCount());
+		printf(" Fresh build: %.3f ms | Objective: %g | %u LP nodes solved\n", freshMs, freshIp.extremum, freshIp.getNodeSolvedCount());
+		printf(" Objectives %s\n", fabs(ip.extremum - freshIp.extremum) <= 1e-6 * max(1.0, fabs(freshIp.extremum)) ? "match" : "DIFFER");
+		printf("-------------------- What-if --------------------\n");
+	}
+	
+	static void testModelFile(const string& path, bool nodeOmp, double timeLimitMs, uint64_t nodeLimit, double gapLimit, const string& solutionPath) { // [model file] 讀入模型檔並求解, 不使用 Tester 的模型參數
+		enableMatrixEliminationParallel = true;
+		auto start = chrono::steady_clock::now();
+		optional<IP> ipOpt = loadModelFile(path);
+		if (!ipOpt.has_value()) return;
+		IP& ip = *ipOpt;
+		const double loadMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		ip.setTimeLimit(timeLimitMs).setNodeLimit(nodeLimit).setGapLimit(gapLimit);
+		
+		start = chrono::steady_clock::now();
+		nodeOmp ? ip.solveParallel() : ip.solve();
+		const double solveMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		
+		const char* typeNames[] = { "Bounded", "Infeasible", "Unbounded" };
+		const char* stopReasonNames[] = { "completed", "time limit", "node limit", "gap limit" };
+		printf("-------------------- Model file --------------------\n");
+		printf(" %s: %u variables, %u constraints, loaded in %.3f ms\n", path.c_str(), ip.getVarCount(), ip.getConstraintCount(), loadMs);
+		printf(" Solved in %.3f ms (OMP: %s) | Type: %s | Objective: %.6f | Nodes: %llu | Stop: %s\n",
+			solveMs, nodeOmp ? "ON" : "OFF", typeNames[(int)ip.solutionType], ip.extremum, (unsigned long long)ip.getStats().nodeSolvedCount, stopReasonNames[(int)ip.stopReason]);
+		if (!solutionPath.empty() && ip.solutionType == IP::Type::BOUNDED) {
+			if (ModelFile::writeSolution(solutionPath, ip.extremum, ip.solution, [&](uint32_t j) { return ip.getVarName(j); })) printf(" Solution written to %s\n", solutionPath.c_str());
+		}
+		printf("-------------------- Model file --------------------\n");
+	}
+	
+#ifdef USE_MPI
+	void testDistributed() { // [MPI] 所有 rank 一起解一次 IP, rank 0 印出結果
+		enableMatrixEliminationParallel = true;
+		int32_t rank, size;
+		MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+		MPI_Comm_size(MPI_COMM_WORLD, &size);
+		SCParams P = default_sc_params(i, j, k, l);
+		IP ip = build_supply_chain_ip(P);
+		
+		MPI_Barrier(MPI_COMM_WORLD);
+		auto start = chrono::high_resolution_clock::now();
+		ip.solveDistributed();
+		auto end = chrono::high_resolution_clock::now();
+		if (rank != 0) return;
+		
+		printf("-------------------- MPI --------------------\n");
+		printf(" IP problem - Model parameters: (%d, %d, %d, %d)\n", i, j, k, l);
+		printf(" Ranks: %d | OpenMP threads per rank: %d\n", size, omp_get_max_threads());
+		printf(" Objective: %.4f | LP nodes solved (all ranks): %u | %.3f ms\n", ip.extremum, ip.getNodeSolvedCount(), chrono::duration<double, milli>(end - start).count());
+		printf("-------------------- MPI --------------------\n");
+	}
+#endif
+	
 	void test(uint32_t n) {
 		auto [avgExeTimeMs_00, avgNodeSolvedCount] = testParallel(n, false, false);
 		auto [avgExeTimeMs_10, _] = testParallel(n, true, false);
 		auto [avgExeTimeMs_11, __] = testParallel(n, true, true);
-		double avx2SpeedUp = avgExeTimeMs_00 / avgExeTimeMs_10; // avx2 matrix row operation speedup
+		auto [avgExeTimeMs_10b, avgNodeSolvedCountBounded] = testParallel(n, true, false, false, true); // bounded simplex 冷啟動, 和 [SIMD: ON , OMP: OFF] 比較 node 數
+		auto [avgExeTimeMs_10w, ___] = testParallel(n, true, false, true);
+		auto [avgExeTimeMs_10wb, ____] = testParallel(n, true, false, true, true);
+		auto [avgExeTimeMs_0wr, avgNodeSolvedCountRevised] = testParallel(n, false, false, true, false, true);
+		auto [avgExeTimeMs_10wbr, avgNodeSolvedCountReliability] = testParallel(n, true, false, true, true, false, BranchingRule::RELIABILITY);
+		const pair<const char*, PricingRule> pricingRules[] = { { "DANTZIG", PricingRule::DANTZIG }, { "STEEPEST EDGE", PricingRule::STEEPEST_EDGE }, { "DEVEX", PricingRule::DEVEX } };
+		pair<double, double> pricingResults[3]; // [pricing] 和 [WARM: ON, BOUNDED: ON] 相同的設定, 只換進入基底的規則 (anti-stalling 會自動開啟)
+		for (uint32_t r = 0; r < 3; r++) {
+			pricingRule = pricingRules[r].second;
+			pricingResults[r] = testParallel(n, true, false, true, true);
+		}
+		pricingRule = PricingRule::FIRST_POSITIVE;
+		enableMatrixEliminationParallel = true; // batch 用和 [SIMD: ON , OMP: OFF] 相同的設定
+		enableWarmStartDualSimplex = enableBoundedSimplex = false;
+		lpEngine = LPEngine::TABLEAU;
+		double avgExeTimeMs_batch = testBatch(n);
+		double simdSpeedUp = avgExeTimeMs_00 / avgExeTimeMs_10; // SIMD matrix row operation speedup
 		double ompSpeedUp = avgExeTimeMs_10 / avgExeTimeMs_11; // omp node level parallel speedup
+		double boundedColdSpeedUp = avgExeTimeMs_10 / avgExeTimeMs_10b; // bounded simplex speedup (cold start)
+		double boundedNodeRatio = avgNodeSolvedCountBounded / avgNodeSolvedCount; // 退化頂點不同, node 數不會完全一樣, 但要在同一個數量級
+		double warmSpeedUp = avgExeTimeMs_10 / avgExeTimeMs_10w; // warm start dual simplex speedup
+		double boundedSpeedUp = avgExeTimeMs_10w / avgExeTimeMs_10wb; // bounded simplex speedup (on top of warm start)
+		double revisedSpeedUp = avgExeTimeMs_10wb / avgExeTimeMs_0wr; // revised simplex vs. dense tableau (both warm start + bounded)
+		double reliabilitySpeedUp = avgExeTimeMs_10wb / avgExeTimeMs_10wbr; // reliability branching vs. first-index branching
+		double batchSpeedUp = avgExeTimeMs_10 / avgExeTimeMs_batch; // batch instance-level parallel throughput vs. solving one by one
 		
 		printf("-------------------- Tester --------------------\n");
 		printf(" IP problem - Model parameters: (%d, %d, %d, %d)\n", i, j, k, l);
 		printf(" Running %d IP problems\n", n);
 		printf(" OpenMP max threads: %d\n", omp_get_max_threads());
+		printf(" SIMD kernel: %s\n", simdKernels.name);
 		printf("------------------------------------------------\n");
 		printf(" Average LP nodes solved per IP problem: %.0f\n", avgNodeSolvedCount);
-		printf(" [AVX2: OFF, OMP: OFF] %.3f ms/IPprob\n", avgExeTimeMs_00);
+		printf(" [SIMD: OFF, OMP: OFF] %.3f ms/IPprob\n", avgExeTimeMs_00);
 		printf(
-			" [AVX2: ON , OMP: OFF] %.3f ms/IPprob | AVX2 matrix row operation speedup: x %.2f (%.2f %%)\n",
-			avgExeTimeMs_10, avx2SpeedUp, avx2SpeedUp / 4 * 100
+			" [SIMD: ON , OMP: OFF] %.3f ms/IPprob | SIMD matrix row operation speedup: x %.2f (%.2f %%)\n",
+			avgExeTimeMs_10, simdSpeedUp, simdSpeedUp / simdKernels.width * 100
 		);
 		printf(
-			" [AVX2: ON , OMP: ON ] %.3f ms/IPprob | OpenMP node-level parallel speedup: x %.2f (%.2f %%)\n",
+			" [SIMD: ON , OMP: ON ] %.3f ms/IPprob | OpenMP node-level parallel speedup: x %.2f (%.2f %%)\n",
 			avgExeTimeMs_11, ompSpeedUp, ompSpeedUp / omp_get_max_threads() * 100
 		);
+		printf(
+			" [SIMD: ON , OMP: OFF, BOUNDED: ON] %.3f ms/IPprob, %.0f LP nodes | Bounded simplex (cold) speedup: x %.2f | Node count vs. standard tableau: x %.2f (%s)\n",
+			avgExeTimeMs_10b, avgNodeSolvedCountBounded, boundedColdSpeedUp, boundedNodeRatio, boundedNodeRatio >= 0.1 && boundedNodeRatio <= 10 ? "OK" : "FAILED"
+		);
+		printf(
+			" [SIMD: ON , OMP: OFF, WARM: ON] %.3f ms/IPprob | Warm start dual simplex speedup: x %.2f\n",
+			avgExeTimeMs_10w, warmSpeedUp
+		);
+		printf(
+			" [SIMD: ON , OMP: OFF, WARM: ON, BOUNDED: ON] %.3f ms/IPprob | Bounded simplex speedup: x %.2f\n",
+			avgExeTimeMs_10wb, boundedSpeedUp
+		);
+		for (uint32_t r = 0; r < 3; r++) printf(
+			" [SIMD: ON , OMP: OFF, WARM: ON, BOUNDED: ON, %s] %.3f ms/IPprob, %.0f LP nodes | Pricing speedup vs. first positive: x %.2f\n",
+			pricingRules[r].first, pricingResults[r].first, pricingResults[r].second, avgExeTimeMs_10wb / pricingResults[r].first
+		);
+		printf(
+			" [REVISED, WARM: ON] %.3f ms/IPprob, %.0f LP nodes | Revised simplex vs. tableau speedup: x %.2f\n",
+			avgExeTimeMs_0wr, avgNodeSolvedCountRevised, revisedSpeedUp
+		);
+		printf(
+			" [SIMD: ON , OMP: OFF, WARM: ON, BOUNDED: ON, RELIABILITY] %.3f ms/IPprob, %.0f LP nodes | Reliability branching speedup: x %.2f\n",
+			avgExeTimeMs_10wbr, avgNodeSolvedCountReliability, reliabilitySpeedUp
+		);
+		printf(
+			" [SIMD: ON , BATCH] %.3f ms/IPprob | Batch instance-level parallel throughput speedup: x %.2f\n",
+			avgExeTimeMs_batch, batchSpeedUp
+		);
 		printf("-------------------- Tester --------------------\n");
 	}
 };
 
 int32_t main(int argc, char* argv[]) {
+	if (argc > 1 && string(argv[1]) == "bench") { // [benchmark] ./main.out bench [quick] [csv=path] [json=path]
+		bool isQuick = false;
+		string csvPath = "bench.csv", jsonPath = "bench.json";
+		for (int32_t c = 2; c < argc; c++) {
+			const string arg = argv[c];
+			if (arg == "quick") isQuick = true;
+			else if (arg.rfind("csv=", 0) == 0) csvPath = arg.substr(4);
+			else if (arg.rfind("json=", 0) == 0) jsonPath = arg.substr(5);
+		}
+		Benchmark benchmark(isQuick);
+		const vector<Benchmark::Row> rows = benchmark.run();
+		Benchmark::writeCsv(rows, csvPath);
+		Benchmark::writeJson(rows, jsonPath);
+		return 0;
+	}
+	
+#ifdef USE_MPI
+	if (argc > 1 && string(argv[1]) == "mpi") { // [MPI] mpirun -np <ranks> ./main-mpi.out mpi [I J K L]
+		int32_t provided;
+		MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided); // 只有 master thread 呼叫 MPI
+		Tester mpiTester(argc > 5 ? stoi(argv[2]) : 3, argc > 5 ? stoi(argv[3]) : 3, argc > 5 ? stoi(argv[4]) : 3, argc > 5 ? stoi(argv[5]) : 3);
+		mpiTester.testDistributed();
+		MPI_Finalize();
+		return 0;
+	}
+#endif
+	
+	if (argc > 1 && string(argv[1]) == "write") { // [model file] ./main.out write <path.bin|path.mps> [I J K L], 把供應鏈模型寫成檔案 (給其他 worker 或 Gurobi 讀)
+		if (argc < 3) {
+			printf("Usage: ./main.out write <path.bin|path.mps> [I J K L]\n");
+			return 1;
+		}
+		SCParams P = default_sc_params(argc > 6 ? stoi(argv[3]) : 3, argc > 6 ? stoi(argv[4]) : 3, argc > 6 ? stoi(argv[5]) : 3, argc > 6 ? stoi(argv[6]) : 3);
+		return writeModelFile(build_supply_chain_ip(P), argv[2]) ? 0 : 1;
+	}
+	if (argc > 1 && isModelFilePath(argv[1])) { // [model file] ./main.out <model.bin|model.mps|model.lp> [omp] [time=ms] [nodes=n] [gap=relative gap] [sol=path]
+		bool nodeOmp = false;
+		double timeLimitMs = FP64_INF, gapLimit = 0;
+		uint64_t nodeLimit = UINT64_MAX;
+		string solutionPath;
+		for (int32_t c = 2; c < argc; c++) {
+			const string arg = argv[c];
+			if (arg == "omp") nodeOmp = true;
+			else if (arg.rfind("time=", 0) == 0) timeLimitMs = stod(arg.substr(5));
+			else if (arg.rfind("nodes=", 0) == 0) nodeLimit = stoull(arg.substr(6));
+			else if (arg.rfind("gap=", 0) == 0) gapLimit = stod(arg.substr(4));
+			else if (arg.rfind("sol=", 0) == 0) solutionPath = arg.substr(4);
+		}
+		Tester::testModelFile(argv[1], nodeOmp, timeLimitMs, nodeLimit, gapLimit, solutionPath);
+		return 0;
+	}
+	
 	Tester tester(3, 3, 3, 3);
+	if (argc > 1 && string(argv[1]) == "stats") { // [stats] ./main.out stats [omp] [time=ms] [nodes=n] [gap=relative gap] [mem=bytes] [nofixed] [gpu[=cells]]
+		bool nodeOmp = false;
+		double timeLimitMs = FP64_INF, gapLimit = 0;
+		uint64_t nodeLimit = UINT64_MAX;
+		size_t nodeMemoryLimit = SIZE_MAX;
+		for (int32_t c = 2; c < argc; c++) {
+			const string arg = argv[c];
+			if (arg == "omp") nodeOmp = true;
+			else if (arg.rfind("time=", 0) == 0) timeLimitMs = stod(arg.substr(5));
+			else if (arg.rfind("nodes=", 0) == 0) nodeLimit = stoull(arg.substr(6));
+			else if (arg.rfind("gap=", 0) == 0) gapLimit = stod(arg.substr(4));
+			else if (arg.rfind("mem=", 0) == 0) nodeMemoryLimit = stoull(arg.substr(4));
+			else if (arg == "nofixed") enableFixedSizeKernels = false; // [fixed-size kernel] 比較用: 所有 tableau 都用可變長度的列運算
+#ifdef USE_GPU
+			else if (arg == "gpu") enableGpuTableau = true; // [GPU] tableau 夠大時 primal simplex 在 GPU 上跑
+			else if (arg.rfind("gpu=", 0) == 0) enableGpuTableau = true, gpuTableauMinCells = stoull(arg.substr(4)); // 同時指定搬到 GPU 的 tableau 元素數門檻
+#endif
+		}
+		tester.testStats(nodeOmp, timeLimitMs, nodeLimit, gapLimit, nodeMemoryLimit);
+		return 0;
+	}
+	if (argc > 1 && string(argv[1]) == "portfolio") { // [portfolio] ./main.out portfolio [members=n] [time=ms] [nodes=n] [gap=relative gap]
+		uint32_t memberCount = min(4, omp_get_max_threads());
+		double timeLimitMs = FP64_INF, gapLimit = 0;
+		uint64_t nodeLimit = UINT64_MAX;
+		for (int32_t c = 2; c < argc; c++) {
+			const string arg = argv[c];
+			if (arg.rfind("members=", 0) == 0) memberCount = stoul(arg.substr(8));
+			else if (arg.rfind("time=", 0) == 0) timeLimitMs = stod(arg.substr(5));
+			else if (arg.rfind("nodes=", 0) == 0) nodeLimit = stoull(arg.substr(6));
+			else if (arg.rfind("gap=", 0) == 0) gapLimit = stod(arg.substr(4));
+		}
+		tester.testPortfolio(memberCount, timeLimitMs, nodeLimit, gapLimit);
+		return 0;
+	}
+	if (argc > 1 && string(argv[1]) == "whatif") { // [what-if] ./main.out whatif
+		tester.testWhatIf();
+		return 0;
+	}
 	tester.test(100);
 	
 	return 0;
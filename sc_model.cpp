@@ -2,8 +2,9 @@
 #include "sc_params.hpp"
 #include <string>
 #include <vector>
+#include <algorithm>
 
-// ---- 便利函式：統一變數命名（與 IP 的 VarBimap 相容，字串即z是變數 ID）----
+// ---- 便利函式：統一變數命名（只用來產生印出用的名稱，建模本身用 SCVars 的編號）----
 static inline std::string vP (const std::string& i, const std::string& j){ return "P[" + i + "," + j + "]"; }
 static inline std::string vX (const std::string& i, const std::string& j, const std::string& k){ return "X[" + i + "," + j + "," + k + "]"; }
 static inline std::string vY (const std::string& i, const std::string& k, const std::string& l){ return "Y[" + i + "," + k + "," + l + "]"; }
@@ -11,52 +12,131 @@ static inline std::string vU (const std::string& i, const std::string& l){ retur
 static inline std::string vW (const std::string& k){ return "W[" + k + "]"; }
 static inline std::string vS (const std::string& l){ return "S[" + l + "]"; }
 
-// ---- 核心：依參數建出 IP 模型（目標式 + 限制式）----
-IP build_supply_chain_ip(const SCParams& P) {
-  const size_t I = P.prod.size();
-  const size_t J = P.fac.size();
-  const size_t K = P.wh.size();
-  const size_t L = P.store.size();
+// ---- 對稱性：參數完全相同的倉庫/門市可以互換（所有相關變數一起換），解空間裡每個解都有多個等價的排列 ----
+// 倉庫 k, k2 可互換：租金、容量、所有 tc1[*][k]、所有 tc2[k][*] 都相同
+static inline bool sc_same_warehouse(const SCParams& P, size_t k, size_t k2) {
+  if (P.wh_rent[k] != P.wh_rent[k2] || P.wh_cap[k] != P.wh_cap[k2]) return false;
+  for (size_t j = 0; j < P.fac.size(); ++j) if (P.tc1[j][k] != P.tc1[j][k2]) return false;
+  for (size_t l = 0; l < P.store.size(); ++l) if (P.tc2[k][l] != P.tc2[k2][l]) return false;
+  return true;
+}
+
+// 門市 l, l2 可互換：租金、所有產品的售價/需求/懲罰、所有 tc2[*][l] 都相同
+static inline bool sc_same_store(const SCParams& P, size_t l, size_t l2) {
+  if (P.store_rent[l] != P.store_rent[l2]) return false;
+  for (size_t i = 0; i < P.prod.size(); ++i)
+    if (P.price[i][l] != P.price[i][l2] || P.demand[i][l] != P.demand[i][l2] || P.penalty[i][l] != P.penalty[i][l2]) return false;
+  for (size_t k = 0; k < P.wh.size(); ++k) if (P.tc2[k][l] != P.tc2[k][l2]) return false;
+  return true;
+}
+
+// 把 n 個設施分成可互換的類別（每類依照編號排序）
+template <class Same>
+static inline std::vector<std::vector<size_t>> sc_symmetry_classes(size_t n, Same same) {
+  std::vector<std::vector<size_t>> classes;
+  for (size_t a = 0; a < n; ++a) {
+    bool placed = false;
+    for (auto& c : classes)
+      if (same(c.front(), a)) { c.push_back(a); placed = true; break; }
+    if (!placed) classes.push_back({ a });
+  }
+  return classes;
+}
+
+// ---- 變數編號：每一種變數佔一段連續編號，直接用算的（不建立字串、不查 hash map）----
+// 區段順序 Y, P, X, W, S, U 和舊版依名稱第一次出現的順序相同（目標式先列 Y），解的過程不變
+struct SCVars {
+  size_t I, J, K, L;
+  uint32_t y0, p0, x0, w0, s0, u0, count; // 每一段的第一個編號、變數總數
+
+  explicit SCVars(const SCParams& P)
+  : I(P.prod.size()), J(P.fac.size()), K(P.wh.size()), L(P.store.size()) {
+    y0 = 0;
+    p0 = y0 + (uint32_t)(I * L * K);
+    x0 = p0 + (uint32_t)(I * J);
+    w0 = x0 + (uint32_t)(I * J * K);
+    s0 = w0 + (uint32_t)K;
+    u0 = s0 + (uint32_t)L;
+    count = u0 + (uint32_t)(I * L);
+  }
+
+  uint32_t Y(size_t i, size_t k, size_t l) const { return y0 + (uint32_t)((i * L + l) * K + k); }
+  uint32_t P(size_t i, size_t j) const { return p0 + (uint32_t)(i * J + j); }
+  uint32_t X(size_t i, size_t j, size_t k) const { return x0 + (uint32_t)((i * J + j) * K + k); }
+  uint32_t W(size_t k) const { return w0 + (uint32_t)k; }
+  uint32_t S(size_t l) const { return s0 + (uint32_t)l; }
+  uint32_t U(size_t i, size_t l) const { return u0 + (uint32_t)(i * L + l); }
+};
 
-  // ======================
-  // 目標式：最大化淨利潤
-  // ======================
-  std::vector<std::pair<double,std::string>> obj;
+// 註冊所有變數，名稱只在印出解（或用名稱查詢）時才產生
+static void sc_add_vars(IP& ip, const SCParams& P, const SCVars& V) {
+  const size_t J = V.J, K = V.K, L = V.L;
+  ip.addVars((uint32_t)(V.I * L * K), [prod = P.prod, wh = P.wh, store = P.store, K, L](uint32_t o) { return vY(prod[o / (L * K)], wh[o % K], store[o / K % L]); });
+  ip.addVars((uint32_t)(V.I * J), [prod = P.prod, fac = P.fac, J](uint32_t o) { return vP(prod[o / J], fac[o % J]); });
+  ip.addVars((uint32_t)(V.I * J * K), [prod = P.prod, fac = P.fac, wh = P.wh, J, K](uint32_t o) { return vX(prod[o / (J * K)], fac[o / K % J], wh[o % K]); });
+  ip.addVars((uint32_t)K, [wh = P.wh](uint32_t o) { return vW(wh[o]); });
+  ip.addVars((uint32_t)L, [store = P.store](uint32_t o) { return vS(store[o]); });
+  ip.addVars((uint32_t)(V.I * L), [prod = P.prod, store = P.store, L](uint32_t o) { return vU(prod[o / L], store[o % L]); });
+}
+
+// ---- 核心：依參數建出 IP 模型（目標式 + 限制式）----
+// break_symmetry = true 時，偵測可互換的倉庫/門市並加入排序約束 W_a >= W_b（S 同理），
+// 每組等價的啟用組合只保留一個（倉庫和門市的排列互相獨立，可以同時加）
+// ======================
+// 目標式：最大化淨利潤（稠密係數，長度為變數總數）
+// ======================
+static std::vector<double> sc_objective_coefs(const SCParams& P, const SCVars& V) {
+  const size_t I = V.I, J = V.J, K = V.K, L = V.L;
+  std::vector<double> obj(V.count, 0.0);
 
   // 銷售收入： + sum_{i,l,k} p_{i,l} * Y_{i,k,l}
   for (size_t i = 0; i < I; ++i)
     for (size_t l = 0; l < L; ++l)
       for (size_t k = 0; k < K; ++k)
-        obj.push_back({ + P.price[i][l], vY(P.prod[i], P.wh[k], P.store[l]) });
+        obj[V.Y(i, k, l)] += P.price[i][l];
 
   // 生產成本： - sum_{i,j} C_{i,j} * P_{i,j}
   for (size_t i = 0; i < I; ++i)
     for (size_t j = 0; j < J; ++j)
-      obj.push_back({ - P.prod_cost[i][j], vP(P.prod[i], P.fac[j]) });
+      obj[V.P(i, j)] += - P.prod_cost[i][j];
 
   // 物流成本(體積計價)：
   // - sum_{i,j,k} TC1_{j,k} * V_i * X_{i,j,k}
   for (size_t i = 0; i < I; ++i)
     for (size_t j = 0; j < J; ++j)
       for (size_t k = 0; k < K; ++k)
-        obj.push_back({ - P.tc1[j][k] * P.V[i], vX(P.prod[i], P.fac[j], P.wh[k]) });
+        obj[V.X(i, j, k)] += - P.tc1[j][k] * P.V[i];
 
   // - sum_{i,k,l} TC2_{k,l} * V_i * Y_{i,k,l}
   for (size_t i = 0; i < I; ++i)
     for (size_t k = 0; k < K; ++k)
       for (size_t l = 0; l < L; ++l)
-        obj.push_back({ - P.tc2[k][l] * P.V[i], vY(P.prod[i], P.wh[k], P.store[l]) });
+        obj[V.Y(i, k, l)] += - P.tc2[k][l] * P.V[i];
 
   // 倉庫/門市固定費： - sum_k R_k W_k  - sum_l SR_l S_l
-  for (size_t k = 0; k < K; ++k) obj.push_back({ - P.wh_rent[k],   vW(P.wh[k])   });
-  for (size_t l = 0; l < L; ++l) obj.push_back({ - P.store_rent[l], vS(P.store[l]) });
+  for (size_t k = 0; k < K; ++k) obj[V.W(k)] += - P.wh_rent[k];
+  for (size_t l = 0; l < L; ++l) obj[V.S(l)] += - P.store_rent[l];
 
   // 未滿足需求懲罰： - sum_{i,l} M_{i,l} U_{i,l}
   for (size_t i = 0; i < I; ++i)
     for (size_t l = 0; l < L; ++l)
-      obj.push_back({ - P.penalty[i][l], vU(P.prod[i], P.store[l]) });
+      obj[V.U(i, l)] += - P.penalty[i][l];
+
+  return obj;
+}
+
+IP build_supply_chain_ip(const SCParams& P, bool break_symmetry = true) {
+  const SCVars V(P);
+  const size_t I = V.I, J = V.J, K = V.K, L = V.L;
+
+  IP ip("max"); // 建立 IP 問題（純整數：所有變數皆為非負整數）
+  sc_add_vars(ip, P, V);
+  const std::vector<double> obj = sc_objective_coefs(P, V);
+  for (uint32_t v = 0; v < V.count; ++v) if (obj[v] != 0) ip.setObjCoef(v, obj[v]);
 
-  IP ip("max", obj); // 建立 IP 問題（純整數：所有變數皆為非負整數）
+  ip.reserveConstraints((uint32_t)(J + I * J + I * K + 2 * K + 3 * I * L + L));
+  std::vector<std::pair<double,uint32_t>> terms; // 每一列共用，避免重複配置
+  terms.reserve(std::max({ I, K + 1, J + L, I * J + 1 }));
 
   // =================================
   // 限制式群組
@@ -64,81 +144,128 @@ IP build_supply_chain_ip(const SCParams& P) {
 
   // (1) 工廠工時產能： sum_i T_{i,j} P_{i,j} <= Cap_j
   for (size_t j = 0; j < J; ++j) {
-    std::vector<std::pair<double,std::string>> terms;
+    terms.clear();
     for (size_t i = 0; i < I; ++i)
-      terms.push_back({ P.prod_time[i][j], vP(P.prod[i], P.fac[j]) });
-    ip.addConstraint(terms, "<=", P.cap[j]);
+      terms.push_back({ P.prod_time[i][j], V.P(i, j) });
+    ip.addConstraint(terms, Relation::LEQ, P.cap[j]);
   }
 
   // (2) 生產 = 出廠： P_{i,j} - sum_k X_{i,j,k} = 0
   for (size_t i = 0; i < I; ++i)
     for (size_t j = 0; j < J; ++j) {
-      std::vector<std::pair<double,std::string>> terms;
-      terms.push_back({ +1.0, vP(P.prod[i], P.fac[j]) });
+      terms.clear();
+      terms.push_back({ +1.0, V.P(i, j) });
       for (size_t k = 0; k < K; ++k)
-        terms.push_back({ -1.0, vX(P.prod[i], P.fac[j], P.wh[k]) });
-      ip.addConstraint(terms, "=", 0.0);
+        terms.push_back({ -1.0, V.X(i, j, k) });
+      ip.addConstraint(terms, Relation::EQ, 0.0);
     }
 
   // (3) 倉庫流量守恆： sum_j X_{i,j,k} - sum_l Y_{i,k,l} = 0
   for (size_t i = 0; i < I; ++i)
     for (size_t k = 0; k < K; ++k) {
-      std::vector<std::pair<double,std::string>> terms;
+      terms.clear();
       for (size_t j = 0; j < J; ++j)
-        terms.push_back({ +1.0, vX(P.prod[i], P.fac[j], P.wh[k]) });
+        terms.push_back({ +1.0, V.X(i, j, k) });
       for (size_t l = 0; l < L; ++l)
-        terms.push_back({ -1.0, vY(P.prod[i], P.wh[k], P.store[l]) });
-      ip.addConstraint(terms, "=", 0.0);
+        terms.push_back({ -1.0, V.Y(i, k, l) });
+      ip.addConstraint(terms, Relation::EQ, 0.0);
     }
 
   // (4) 倉庫吞吐容量（體積）與啟用邏輯：
   // sum_i V_i * (sum_j X_{i,j,k}) - SCap_k * W_k <= 0
   for (size_t k = 0; k < K; ++k) {
-    std::vector<std::pair<double,std::string>> terms;
+    terms.clear();
     for (size_t i = 0; i < I; ++i)
       for (size_t j = 0; j < J; ++j)
-        terms.push_back({ + P.V[i], vX(P.prod[i], P.fac[j], P.wh[k]) });
-    terms.push_back({ - P.wh_cap[k], vW(P.wh[k]) });
-    ip.addConstraint(terms, "<=", 0.0);
+        terms.push_back({ + P.V[i], V.X(i, j, k) });
+    terms.push_back({ - P.wh_cap[k], V.W(k) });
+    ip.addConstraint(terms, Relation::LEQ, 0.0);
   }
 
   // (5) 市場需求平衡（含未滿足）：
   // sum_k Y_{i,k,l} + U_{i,l} = D_{i,l}
   for (size_t i = 0; i < I; ++i)
     for (size_t l = 0; l < L; ++l) {
-      std::vector<std::pair<double,std::string>> terms;
+      terms.clear();
       for (size_t k = 0; k < K; ++k)
-        terms.push_back({ +1.0, vY(P.prod[i], P.wh[k], P.store[l]) });
-      terms.push_back({ +1.0, vU(P.prod[i], P.store[l]) });
-      ip.addConstraint(terms, "=", P.demand[i][l]);
+        terms.push_back({ +1.0, V.Y(i, k, l) });
+      terms.push_back({ +1.0, V.U(i, l) });
+      ip.addConstraint(terms, Relation::EQ, P.demand[i][l]);
     }
 
   // (6) 未滿足需求上界（強化）： U_{i,l} <= D_{i,l}
   for (size_t i = 0; i < I; ++i)
-    for (size_t l = 0; l < L; ++l) {
-      std::vector<std::pair<double,std::string>> terms = { {+1.0, vU(P.prod[i], P.store[l])} };
-      ip.addConstraint(terms, "<=", P.demand[i][l]);
-    }
+    for (size_t l = 0; l < L; ++l)
+      ip.addConstraint({ {+1.0, V.U(i, l)} }, Relation::LEQ, P.demand[i][l]);
 
   // (7) 門市啟用邏輯（Big-M = D_{i,l}）： sum_k Y_{i,k,l} - D_{i,l} * S_l <= 0
   for (size_t i = 0; i < I; ++i)
     for (size_t l = 0; l < L; ++l) {
-      std::vector<std::pair<double,std::string>> terms;
+      terms.clear();
       for (size_t k = 0; k < K; ++k)
-        terms.push_back({ +1.0, vY(P.prod[i], P.wh[k], P.store[l]) });
-      terms.push_back({ - P.demand[i][l], vS(P.store[l]) });
-      ip.addConstraint(terms, "<=", 0.0);
+        terms.push_back({ +1.0, V.Y(i, k, l) });
+      terms.push_back({ - P.demand[i][l], V.S(l) });
+      ip.addConstraint(terms, Relation::LEQ, 0.0);
     }
 
   // (8) 二元邏輯：W_k, S_l ∈ {0,1}  ——> 0 ≤ var ≤ 1（IP 預設非負整數，故加上 ≤1 即為二元）
-  for (size_t k = 0; k < K; ++k) {
-    std::vector<std::pair<double,std::string>> terms = { {+1.0, vW(P.wh[k])} };
-    ip.addConstraint(terms, "<=", 1.0);
-  }
-  for (size_t l = 0; l < L; ++l) {
-    std::vector<std::pair<double,std::string>> terms = { {+1.0, vS(P.store[l])} };
-    ip.addConstraint(terms, "<=", 1.0);
+  for (size_t k = 0; k < K; ++k) ip.addConstraint({ {+1.0, V.W(k)} }, Relation::LEQ, 1.0);
+  for (size_t l = 0; l < L; ++l) ip.addConstraint({ {+1.0, V.S(l)} }, Relation::LEQ, 1.0);
+
+  // (9) 對稱性破除：同一類可互換的設施依照編號排序啟用，W_a - W_b >= 0
+  if (break_symmetry) {
+    for (auto& c : sc_symmetry_classes(K, [&](size_t a, size_t b) { return sc_same_warehouse(P, a, b); }))
+      for (size_t t = 1; t < c.size(); ++t)
+        ip.addConstraint({ {+1.0, V.W(c[t - 1])}, {-1.0, V.W(c[t])} }, Relation::GEQ, 0.0);
+    for (auto& c : sc_symmetry_classes(L, [&](size_t a, size_t b) { return sc_same_store(P, a, b); }))
+      for (size_t t = 1; t < c.size(); ++t)
+        ip.addConstraint({ {+1.0, V.S(c[t - 1])}, {-1.0, V.S(c[t])} }, Relation::GEQ, 0.0);
   }
 
+  // 分支優先權：先決定倉庫/門市是否啟用 (W_k, S_l)，再決定產量 P_{i,j}，最後才處理運送流量
+  // 工時產能 (1) 讓 LP 的產量停在小數，流量 X/Y 的小數只是把它分到各條路線；先切流量時 LP 會把同樣的小數改走另一條路線，
+  // 下界完全不動，切到哪一條取決於 LP 停在哪個退化頂點（tableau/revised、bounded、pricing 規則都不同），node tree 會爆掉
+  for (size_t k = 0; k < K; ++k) ip.setBranchPriority(V.W(k), 2);
+  for (size_t l = 0; l < L; ++l) ip.setBranchPriority(V.S(l), 2);
+  for (size_t i = 0; i < I; ++i)
+    for (size_t j = 0; j < J; ++j)
+      ip.setBranchPriority(V.P(i, j), 1);
+
   return ip;
 }
+
+// ---- [what-if] 就地修改已建好的 IP（搭配 ip.setIncremental(true)，改完直接再 solve）----
+// 只能用在 build_supply_chain_ip(P, false) 建的 IP：(9) 的排序約束是依照建模當下的參數偵測的，
+// 改了需求或售價之後原本可互換的設施不再相同，W_a >= W_b / S_a >= S_b 可能切掉新的最佳解
+// 約束編號依照 build_supply_chain_ip 的加入順序：(1) J 列、(2) I*J、(3) I*K、(4) K，接著 (5)(6)(7) 各 I*L 列
+static inline uint32_t sc_demand_row(const SCParams& P, size_t i, size_t l) {
+  const size_t I = P.prod.size(), J = P.fac.size(), K = P.wh.size(), L = P.store.size();
+  return (uint32_t)(J + I * J + I * K + K + i * L + l); // (5) 的列，(6)(7) 依序再往後 I*L 列
+}
+
+// 檢查 IP 沒有 (9) 的對稱性破除列（約束數只有 (1)~(8)），有的話印出錯誤並回傳 false
+static inline bool sc_check_no_symmetry_rows(const IP& ip, const SCParams& P) {
+  const size_t I = P.prod.size(), J = P.fac.size(), K = P.wh.size(), L = P.store.size();
+  if (ip.getConstraintCount() == (uint32_t)(J + I * J + I * K + K + 3 * I * L + K + L)) return true;
+  printf("what-if edits need build_supply_chain_ip(P, false): the symmetry-breaking rows may cut off the new optimum\n");
+  return false;
+}
+
+// 修改需求 D_{i,l}：(5) 和 (6) 的右側常數、(7) 的 Big-M 係數
+inline bool sc_set_demand(IP& ip, SCParams& P, size_t i, size_t l, double D) {
+  if (!sc_check_no_symmetry_rows(ip, P)) return false;
+  const uint32_t row = sc_demand_row(P, i, l), IL = (uint32_t)(P.prod.size() * P.store.size());
+  P.demand[i][l] = D;
+  ip.setRightConst(row, D);
+  ip.setRightConst(row + IL, D);
+  ip.setConstraintCoef(row + 2 * IL, SCVars(P).S(l), -D);
+  return true;
+}
+
+// 依照 P 重新設定所有目標式係數（改了售價、成本、運費、租金或懲罰之後呼叫）
+inline bool sc_update_objective(IP& ip, const SCParams& P) {
+  if (!sc_check_no_symmetry_rows(ip, P)) return false;
+  const std::vector<double> obj = sc_objective_coefs(P, SCVars(P));
+  for (uint32_t v = 0; v < (uint32_t)obj.size(); ++v) ip.setObjCoef(v, obj[v]);
+  return true;
+}
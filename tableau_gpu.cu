@@ -0,0 +1,166 @@
+// [GPU] tableau 整個放在 device 記憶體, pricing, ratio test 和 pivot 的 rank-1 更新都在 device 上做, 每次 pivot 只把進出基底的編號傳回 host
+#include "tableau_gpu.hpp"
+
+#ifdef __HIPCC__ // ROCm: 用同一份原始碼, 把 CUDA runtime API 換成 HIP
+#include <hip/hip_runtime.h>
+#define cudaError_t hipError_t
+#define cudaSuccess hipSuccess
+#define cudaGetDeviceCount hipGetDeviceCount
+#define cudaGetLastError hipGetLastError
+#define cudaDeviceSynchronize hipDeviceSynchronize
+#define cudaMalloc hipMalloc
+#define cudaFree hipFree
+#define cudaMemcpy hipMemcpy
+#define cudaMemcpyHostToDevice hipMemcpyHostToDevice
+#define cudaMemcpyDeviceToHost hipMemcpyDeviceToHost
+#else
+#include <cuda_runtime.h>
+#endif
+
+namespace {
+	constexpr uint32_t REDUCE_BLOCK_SIZE = 1024; // 掃描用一個 block 做 grid-stride 再在 shared memory 合併 (掃描只有 O(m) 或 O(n), 一個 block 就夠)
+	constexpr uint32_t BLOCK_SIZE = 256;
+	constexpr uint32_t MAX_GRID_ROWS = 65535; // gridDim.y 的上限, 列數更多時 grid-stride
+	
+	struct ArgResult { // 掃描的結果: 值和它的位置, -1 代表沒有找到
+		double value;
+		int32_t index;
+	};
+	
+	__device__ bool isBetterEntering(const ArgResult& a, const ArgResult& b, bool isDantzig) { // a 是否比 b 好: Dantzig 取最大的 reduced cost, 否則取編號最小的, 相同時都取編號小的 (和 host 的掃描順序一樣)
+		if (a.index == -1) return false;
+		if (b.index == -1) return true;
+		if (isDantzig && a.value != b.value) return a.value > b.value;
+		return a.index < b.index;
+	}
+	
+	__device__ bool isBetterLeaving(const ArgResult& a, const ArgResult& b) { // 比值小的比較好, 相同時取編號小的列
+		if (a.index == -1) return false;
+		if (b.index == -1) return true;
+		if (a.value != b.value) return a.value < b.value;
+		return a.index < b.index;
+	}
+	
+	__global__ void findEnteringKernel(const double* row0, uint32_t n, double eps, bool isDantzig, ArgResult* result) {
+		__shared__ ArgResult bests[REDUCE_BLOCK_SIZE];
+		ArgResult best = { 0, -1 };
+		for (uint32_t j = threadIdx.x; j < n; j += blockDim.x) {
+			const ArgResult candidate = { row0[j], (int32_t)j };
+			if (candidate.value >= eps && isBetterEntering(candidate, best, isDantzig)) best = candidate;
+		}
+		bests[threadIdx.x] = best;
+		__syncthreads();
+		for (uint32_t stride = blockDim.x / 2; stride > 0; stride /= 2) {
+			if (threadIdx.x < stride && isBetterEntering(bests[threadIdx.x + stride], bests[threadIdx.x], isDantzig)) bests[threadIdx.x] = bests[threadIdx.x + stride];
+			__syncthreads();
+		}
+		if (threadIdx.x == 0) *result = bests[0];
+	}
+	
+	__global__ void findLeavingKernel(const double* arr, uint32_t rows, uint32_t cols, uint32_t col, double eps, ArgResult* result) {
+		__shared__ ArgResult bests[REDUCE_BLOCK_SIZE];
+		ArgResult best = { 0, -1 };
+		for (uint32_t i = 1 + threadIdx.x; i < rows; i += blockDim.x) {
+			const double aij = arr[(size_t)i * cols + col];
+			if (aij < eps) continue;
+			const ArgResult candidate = { arr[(size_t)i * cols + cols - 1] / aij, (int32_t)i };
+			if (isBetterLeaving(candidate, best)) best = candidate;
+		}
+		bests[threadIdx.x] = best;
+		__syncthreads();
+		for (uint32_t stride = blockDim.x / 2; stride > 0; stride /= 2) {
+			if (threadIdx.x < stride && isBetterLeaving(bests[threadIdx.x + stride], bests[threadIdx.x])) bests[threadIdx.x] = bests[threadIdx.x + stride];
+			__syncthreads();
+		}
+		if (threadIdx.x == 0) *result = bests[0];
+	}
+	
+	__global__ void copyPivotKernel(const double* arr, uint32_t rows, uint32_t cols, uint32_t row, uint32_t col, double* rowBuffer, double* colBuffer) { // 更新前先複製 pivot 列和 pivot 行
+		const uint32_t index = blockIdx.x * blockDim.x + threadIdx.x;
+		if (index < cols) rowBuffer[index] = arr[(size_t)row * cols + index];
+		if (index < rows) colBuffer[index] = arr[(size_t)index * cols + col];
+	}
+	
+	__global__ void eliminateKernel(double* arr, uint32_t rows, uint32_t cols, uint32_t row, uint32_t col, const double* rowBuffer, const double* colBuffer) { // 每個 thread 負責一個元素: A_kc -= (A_kj / A_ij) A_ic, 列 i 同除 A_ij
+		const uint32_t c = blockIdx.x * blockDim.x + threadIdx.x;
+		if (c >= cols) return;
+		const double pivot = rowBuffer[col];
+		for (uint32_t k = blockIdx.y; k < rows; k += gridDim.y) {
+			double& value = arr[(size_t)k * cols + c];
+			if (k == row) value = rowBuffer[c] / pivot;
+			else if (colBuffer[k] != 0) value = c == col ? 0 : value - colBuffer[k] / pivot * rowBuffer[c]; // 行 j 已經是 0 的列不會改變, 和 host 一樣跳過
+		}
+	}
+}
+
+struct GpuTableau {
+	uint32_t rows, cols;
+	double* arr = nullptr;
+	double* rowBuffer = nullptr; // pivot 列的副本
+	double* colBuffer = nullptr; // pivot 行的副本
+	ArgResult* result = nullptr; // 掃描的結果, 每次只傳回這一個值
+};
+
+bool gpuTableauIsAvailable() {
+	static const bool isAvailable = []() {
+		int32_t deviceCount = 0;
+		return cudaGetDeviceCount(&deviceCount) == cudaSuccess && deviceCount > 0;
+	}();
+	return isAvailable;
+}
+
+GpuTableau* gpuTableauCreate(const double* arr, uint32_t rows, uint32_t cols) {
+	if (!gpuTableauIsAvailable()) return nullptr;
+	GpuTableau* tableau = new GpuTableau();
+	tableau->rows = rows;
+	tableau->cols = cols;
+	const size_t bytes = (size_t)rows * cols * sizeof(double);
+	const bool isAllocated = cudaMalloc((void**)&tableau->arr, bytes) == cudaSuccess
+		&& cudaMalloc((void**)&tableau->rowBuffer, cols * sizeof(double)) == cudaSuccess
+		&& cudaMalloc((void**)&tableau->colBuffer, rows * sizeof(double)) == cudaSuccess
+		&& cudaMalloc((void**)&tableau->result, sizeof(ArgResult)) == cudaSuccess;
+	if (!isAllocated || cudaMemcpy(tableau->arr, arr, bytes, cudaMemcpyHostToDevice) != cudaSuccess) {
+		gpuTableauDestroy(tableau);
+		return nullptr;
+	}
+	return tableau;
+}
+
+int32_t gpuTableauFindEntering(GpuTableau* tableau, bool isDantzig, double eps) {
+	findEnteringKernel<<<1, REDUCE_BLOCK_SIZE>>>(tableau->arr, tableau->cols - 1, eps, isDantzig, tableau->result); // 第零列, 最後一行是右側常數
+	ArgResult result;
+	if (cudaGetLastError() != cudaSuccess) return GPU_TABLEAU_ERROR; // 啟動失敗時 result 沒有被寫入
+	if (cudaMemcpy(&result, tableau->result, sizeof(ArgResult), cudaMemcpyDeviceToHost) != cudaSuccess) return GPU_TABLEAU_ERROR; // 也會回報 kernel 執行時的錯誤
+	return result.index;
+}
+
+int32_t gpuTableauFindLeaving(GpuTableau* tableau, uint32_t col, double eps, double& minRatio) {
+	findLeavingKernel<<<1, REDUCE_BLOCK_SIZE>>>(tableau->arr, tableau->rows, tableau->cols, col, eps, tableau->result);
+	ArgResult result;
+	if (cudaGetLastError() != cudaSuccess) return GPU_TABLEAU_ERROR;
+	if (cudaMemcpy(&result, tableau->result, sizeof(ArgResult), cudaMemcpyDeviceToHost) != cudaSuccess) return GPU_TABLEAU_ERROR;
+	minRatio = result.index == -1 ? 1e300 : result.value;
+	return result.index;
+}
+
+bool gpuTableauPivot(GpuTableau* tableau, uint32_t row, uint32_t col) {
+	const uint32_t copyCount = tableau->rows > tableau->cols ? tableau->rows : tableau->cols;
+	copyPivotKernel<<<(copyCount + BLOCK_SIZE - 1) / BLOCK_SIZE, BLOCK_SIZE>>>(tableau->arr, tableau->rows, tableau->cols, row, col, tableau->rowBuffer, tableau->colBuffer);
+	if (cudaGetLastError() != cudaSuccess) return false;
+	const dim3 grid((tableau->cols + BLOCK_SIZE - 1) / BLOCK_SIZE, tableau->rows < MAX_GRID_ROWS ? tableau->rows : MAX_GRID_ROWS);
+	eliminateKernel<<<grid, BLOCK_SIZE>>>(tableau->arr, tableau->rows, tableau->cols, row, col, tableau->rowBuffer, tableau->colBuffer); // 同一個 stream, 兩個 kernel 之間不用同步
+	if (cudaGetLastError() != cudaSuccess) return false;
+	return cudaDeviceSynchronize() == cudaSuccess; // 下一次掃描的 cudaMemcpy 本來就要等消元做完, 在這裡等不會變慢, 但 host 的計時 ([stats]) 才是真正的消元時間, 執行錯誤也在這裡就回報
+}
+
+bool gpuTableauDownload(GpuTableau* tableau, double* arr) {
+	return cudaMemcpy(arr, tableau->arr, (size_t)tableau->rows * tableau->cols * sizeof(double), cudaMemcpyDeviceToHost) == cudaSuccess;
+}
+
+void gpuTableauDestroy(GpuTableau* tableau) {
+	cudaFree(tableau->arr); // nullptr 也可以 free
+	cudaFree(tableau->rowBuffer);
+	cudaFree(tableau->colBuffer);
+	cudaFree(tableau->result);
+	delete tableau;
+}
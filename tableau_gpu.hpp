@@ -0,0 +1,15 @@
+#pragma once
+// [GPU] tableau 引擎的 device 端介面 (tableau_gpu.cu), make gpu (CUDA) 或 make hip (ROCm) 才會編譯和連結
+#include <cstdint>
+
+struct GpuTableau; // device 上的 tableau (扁平化的二維陣列) 和 pivot 用的暫存
+
+constexpr int32_t GPU_TABLEAU_ERROR = -2; // kernel 啟動/執行或 cudaMemcpy 失敗, device 上的 tableau 不能再用 (呼叫端改回 CPU)
+
+bool gpuTableauIsAvailable(); // 是否有可用的 GPU
+GpuTableau* gpuTableauCreate(const double* arr, uint32_t rows, uint32_t cols); // 上傳 tableau, 失敗 (沒有 GPU, 記憶體不足) 回傳 nullptr
+int32_t gpuTableauFindEntering(GpuTableau* tableau, bool isDantzig, double eps); // 第零列 (不含右側常數) 中 >= eps 的第一個 (或最大的) 行, 找不到回傳 -1, 失敗回傳 GPU_TABLEAU_ERROR
+int32_t gpuTableauFindLeaving(GpuTableau* tableau, uint32_t col, double eps, double& minRatio); // 行 col 係數 >= eps 的列中右側常數/係數最小的列 (相同取編號小的), 找不到回傳 -1, 失敗回傳 GPU_TABLEAU_ERROR
+bool gpuTableauPivot(GpuTableau* tableau, uint32_t row, uint32_t col); // 用 A_{row,col} 消去行 col 的其他元素, 並將列 row 同除 A_{row,col}. 等 kernel 執行完才回傳, 失敗回傳 false
+bool gpuTableauDownload(GpuTableau* tableau, double* arr); // 把 tableau 複製回 host, 失敗回傳 false (arr 的內容不能用)
+void gpuTableauDestroy(GpuTableau* tableau);